@@ -119,7 +119,7 @@ void benchmark_order_book() {
             quantity_dist(gen),  // quantity
             side_dist(gen) == 0 ? Side::BUY : Side::SELL,  // side
             std::chrono::system_clock::now().time_since_epoch().count(),  // timestamp
-            "AAPL"  // symbol
+            0  // symbol ID
         );
     }
     
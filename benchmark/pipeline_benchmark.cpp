@@ -0,0 +1,874 @@
+#include "trading/core/execution_engine.h"
+#include "trading/core/market_data.h"
+#include "trading/core/order_book.h"
+#include "trading/core/static_strategy_engine.h"
+#include "trading/core/strategy_engine.h"
+#include "trading/core/trading_runtime.h"
+#include "trading/support/logger.h"
+#include "trading/utils/backoff.h"
+#include "trading/utils/cpu_affinity.h"
+#include "trading/utils/latency_histogram.h"
+#include "trading/utils/lockfree_queue.h"
+#include "trading/utils/perf_counters.h"
+#include "trading/utils/timekeeper.h"
+#include "trading/utils/tsc_clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace trading;
+
+// End-to-end pipeline benchmark
+// Every scenario drives generated order flow through the real components and
+// records one latency sample per packet in a LatencyHistogram:
+//   decode/*         MarketDataHandler::process_buffer (decode and book update)
+//   tick_to_trade/*  process_buffer, StrategyEngine signal and
+//                    ExecutionEngine::submit_order for every signal
+//   tick_to_trade_static/*  the same with StaticStrategyEngine (strategy
+//                    and sink bound at compile time)
+//   queue_hops       timestamped messages through two SPSC queue hops
+//   runtime          TradingRuntime publish() to the end of the shard's
+//                    strategy pass (feed -> shard hop)
+// "cold" variants evict the caches before every timed packet. Results are
+// printed as HDR percentiles and can be written as JSON (--json=<file>, or
+// --json=- for stdout) for regression tracking. Built with
+// TRADING_PERF_COUNTERS, the hardware counters of every hot-path stage over
+// the timed packets are reported alongside.
+
+namespace {
+
+// Benchmark parameters (overridable from the command line)
+struct Options {
+    size_t packets = 200000;        // Timed packets per warm scenario
+    size_t warmup_packets = 50000;  // Untimed packets before timing starts
+    size_t cold_packets = 2000;     // Timed packets per cold scenario
+    size_t symbols = 64;            // Symbols in the order flow
+    size_t hop_messages = 200000;   // Messages through the queue hops
+    size_t evict_mb = 64;           // Memory streamed to evict the caches
+    uint64_t seed = 42;             // Order flow seed
+    std::string scenario;           // Only run scenarios containing this
+    std::string json;               // JSON output file ("-" = stdout)
+};
+
+// Result of one scenario
+struct ScenarioResult {
+    std::string name;
+    LatencyHistogram latency;       // Nanoseconds per sample
+    uint64_t messages = 0;          // Market data messages in the timed samples
+    bool pinned = false;            // Threads ran on dedicated cores
+    PerfReport counters;            // Hardware counters over the timed samples
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+// Keeps results from being optimized away
+std::atomic<uint64_t> g_sink{0};
+
+// Ticks to nanoseconds
+uint64_t ticks_to_ns(uint64_t ticks) {
+    return static_cast<uint64_t>(CycleCounter::cycles_to_ns(ticks));
+}
+
+// Idle policy of the benchmark's own polling threads: spin on dedicated
+// cores, yield when threads have to share one
+BackoffPolicy idle_policy(bool dedicated) {
+    return dedicated ? BackoffPolicy::spin() : BackoffPolicy{0, 0, std::chrono::microseconds(0)};
+}
+
+// Order flow profiles
+enum class FlowKind {
+    PRICE_WALK,    // Quotes around a random-walking mid, moderate cancels
+    CANCEL_HEAVY   // Quotes flickering at the touch, most orders canceled
+};
+
+const char* flow_name(FlowKind kind) {
+    return kind == FlowKind::PRICE_WALK ? "price_walk" : "cancel_heavy";
+}
+
+// Packets of generated market data in the native wire format
+struct PacketStream {
+    std::vector<uint8_t> data;
+    std::vector<std::pair<size_t, size_t>> packets;  // Offset and length
+    std::vector<uint32_t> messages;                  // Messages per packet
+    std::vector<Timestamp> last_timestamp;           // Time of each packet's last message
+};
+
+// Generator of realistic order flow
+// Each symbol has a mid price doing a random walk; orders are quoted around
+// it with a geometric distance from the touch. Cancels, modifies and
+// executions pick live orders at random (cancel-heavy flow mostly pulls the
+// newest quotes), so order IDs and price levels are scattered the way they
+// are on a real feed instead of cycling through a few hot cache lines.
+// Symbol activity is skewed: a tenth of the symbols gets half the messages.
+class OrderFlow {
+public:
+    // Constructor
+    OrderFlow(FlowKind kind, std::vector<std::string> symbols, uint64_t seed)
+        : kind_(kind), symbols_(std::move(symbols)), rng_(seed), states_(symbols_.size()) {
+        for (auto& state : states_) {
+            state.mid = 10000 + static_cast<Price>(rng_() % 1000);
+        }
+    }
+    
+    // Append packets of 1 to 16 messages
+    void generate(size_t packets, PacketStream& stream) {
+        std::geometric_distribution<int> extra_messages(0.4);
+        for (size_t p = 0; p < packets; ++p) {
+            size_t start = stream.data.size();
+            uint32_t count = 1 + static_cast<uint32_t>(std::min(extra_messages(rng_), 15));
+            for (uint32_t m = 0; m < count; ++m) {
+                next_message(stream.data);
+            }
+            stream.packets.emplace_back(start, stream.data.size() - start);
+            stream.messages.push_back(count);
+            stream.last_timestamp.push_back(now_);
+        }
+    }
+    
+private:
+    // Resting order of the generated flow
+    struct LiveOrder {
+        OrderId order_id;
+        Quantity quantity;
+    };
+    
+    // Per-symbol state
+    struct SymbolState {
+        Price mid = 0;
+        std::vector<LiveOrder> live;
+    };
+    
+    FlowKind kind_;
+    std::vector<std::string> symbols_;
+    std::mt19937_64 rng_;
+    std::vector<SymbolState> states_;
+    OrderId next_order_id_ = 1;
+    Timestamp now_ = 1000000000;
+    
+    // Uniform draw in [0, 1)
+    double uniform() {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+    }
+    
+    // Pick a symbol (skewed towards the first tenth)
+    size_t pick_symbol() {
+        size_t hot = std::max<size_t>(1, symbols_.size() / 10);
+        return uniform() < 0.5 ? rng_() % hot : rng_() % symbols_.size();
+    }
+    
+    // Pick a live order (cancel-heavy flow prefers the newest)
+    size_t pick_order(const SymbolState& state) {
+        if (kind_ == FlowKind::CANCEL_HEAVY && uniform() < 0.7) {
+            return state.live.size() - 1;
+        }
+        return rng_() % state.live.size();
+    }
+    
+    // Remove a live order (order of the rest does not matter)
+    static void remove_order(SymbolState& state, size_t index) {
+        state.live[index] = state.live.back();
+        state.live.pop_back();
+    }
+    
+    // Append one message
+    void next_message(std::vector<uint8_t>& data) {
+        const size_t symbol_index = pick_symbol();
+        SymbolState& state = states_[symbol_index];
+        const std::string& symbol = symbols_[symbol_index];
+        
+        now_ += 200 + rng_() % 600;
+        if (uniform() < 0.1) {
+            state.mid += (rng_() & 1) ? 1 : -1;
+        }
+        
+        // Message mix of the profile: add, cancel, modify, execute (rest are trades)
+        const bool cancel_heavy = kind_ == FlowKind::CANCEL_HEAVY;
+        const double add = cancel_heavy ? 0.48 : 0.50;
+        const double cancel = add + (cancel_heavy ? 0.47 : 0.35);
+        const double modify = cancel + (cancel_heavy ? 0.03 : 0.05);
+        const double execute = modify + (cancel_heavy ? 0.015 : 0.08);
+        
+        MarketDataMessage msg{};
+        msg.timestamp = now_;
+        msg.symbol_length = static_cast<uint8_t>(symbol.size());
+        
+        double action = state.live.empty() ? 0.0 : uniform();
+        if (action < add) {
+            // Quote at a geometric distance from the touch
+            bool buy = rng_() & 1;
+            Price distance = static_cast<Price>(
+                std::geometric_distribution<int>(cancel_heavy ? 0.6 : 0.2)(rng_));
+            LiveOrder order{next_order_id_++, static_cast<Quantity>(1 + rng_() % 500)};
+            state.live.push_back(order);
+            
+            msg.type = MessageType::ADD_ORDER;
+            msg.add_order.order_id = order.order_id;
+            msg.add_order.price = buy ? state.mid - distance : state.mid + 1 + distance;
+            msg.add_order.quantity = order.quantity;
+            msg.add_order.side = buy ? 0 : 1;
+        } else if (action < cancel) {
+            size_t index = pick_order(state);
+            msg.type = MessageType::CANCEL_ORDER;
+            msg.cancel_order.order_id = state.live[index].order_id;
+            remove_order(state, index);
+        } else if (action < modify) {
+            size_t index = pick_order(state);
+            LiveOrder& order = state.live[index];
+            order.quantity = static_cast<Quantity>(1 + rng_() % 500);
+            msg.type = MessageType::MODIFY_ORDER;
+            msg.modify_order.order_id = order.order_id;
+            msg.modify_order.quantity = order.quantity;
+        } else if (action < execute) {
+            size_t index = rng_() % state.live.size();
+            LiveOrder& order = state.live[index];
+            Quantity quantity = std::min<Quantity>(order.quantity, static_cast<Quantity>(1 + rng_() % 200));
+            msg.type = MessageType::EXECUTE_ORDER;
+            msg.execute_order.order_id = order.order_id;
+            msg.execute_order.exec_quantity = quantity;
+            msg.execute_order.exec_price = state.mid;
+            order.quantity -= quantity;
+            if (order.quantity == 0) {
+                remove_order(state, index);
+            }
+        } else {
+            msg.type = MessageType::TRADE;
+            msg.trade.price = state.mid;
+            msg.trade.quantity = static_cast<Quantity>(1 + rng_() % 100);
+            msg.trade.aggressor_side = rng_() & 1;
+        }
+        
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&msg);
+        data.insert(data.end(), bytes, bytes + sizeof(MarketDataMessage));
+        data.insert(data.end(), symbol.begin(), symbol.end());
+    }
+};
+
+// Generate the warm-up packets followed by the timed ones
+PacketStream make_stream(FlowKind kind, const std::vector<std::string>& symbols, const Options& options,
+                         size_t timed_packets) {
+    PacketStream stream;
+    OrderFlow flow(kind, symbols, options.seed);
+    flow.generate(options.warmup_packets + timed_packets, stream);
+    return stream;
+}
+
+// Streams through a buffer larger than the last-level cache
+class CacheEvictor {
+public:
+    // Constructor
+    explicit CacheEvictor(size_t megabytes) : buffer_(megabytes * 1024 * 1024, 1) {}
+    
+    // Evict the caches (dirties every line, so the next owner reloads from memory)
+    void evict() {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < buffer_.size(); i += 64) {
+            sum += buffer_[i]++;
+        }
+        g_sink.fetch_add(sum, std::memory_order_relaxed);
+    }
+    
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+// Strategy quoting against every change of the top of book
+// Each time a book's best bid or ask moves it sends one marketable order,
+// alternating sides, so the execution stage sees a steady signal rate.
+class TopOfBookStrategy final : public Strategy {
+public:
+    // Initialize the strategy
+    void initialize() override {}
+    
+    // Process an order book update and append signals to a caller-owned buffer
+    void process_update(const OrderBook& order_book, SignalBuffer& signals) override {
+        SymbolId symbol_id = order_book.symbol_id();
+        if (symbol_id >= last_top_.size()) {
+            last_top_.resize(symbol_id + 1, {0, 0});
+        }
+        
+        auto bid = order_book.best_bid();
+        auto ask = order_book.best_ask();
+        if (!bid || !ask) {
+            return;
+        }
+        
+        auto& last = last_top_[symbol_id];
+        if (last.first == *bid && last.second == *ask) {
+            return;
+        }
+        last = {*bid, *ask};
+        
+        buy_ = !buy_;
+        signals.emplace(buy_ ? SignalType::BUY : SignalType::SELL, symbol_id, buy_ ? *ask : *bid, 1, 1.0,
+                        TscClock::now_ns());
+    }
+    using Strategy::process_update;
+    
+    // Get strategy name
+    std::string name() const override { return "top_of_book"; }
+    
+private:
+    // Last best bid and ask per symbol
+    std::vector<std::pair<Price, Price>> last_top_;
+    
+    // Side of the next signal
+    bool buy_ = false;
+};
+
+// Sink submitting every signal to an execution engine
+class SubmitSink final : public SignalSink {
+public:
+    // Constructor
+    explicit SubmitSink(ExecutionEngine& execution) : execution_(execution) {}
+    
+    // Submit all signals of a tick
+    void on_signals(std::span<const Signal> signals) override {
+        for (const Signal& signal : signals) {
+            if (execution_.submit_order(signal) != 0) {
+                accepted++;
+            } else {
+                rejected++;
+            }
+        }
+    }
+    
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    
+private:
+    ExecutionEngine& execution_;
+};
+
+// Symbols of the order flow
+std::vector<std::string> make_symbols(size_t count) {
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < count; ++i) {
+        symbols.push_back("S" + std::to_string(i));
+    }
+    return symbols;
+}
+
+// Decode and book update of every packet
+ScenarioResult run_decode(FlowKind kind, bool cold, const Options& options) {
+    ScenarioResult result;
+    result.name = std::string("decode/") + flow_name(kind) + (cold ? "/cold" : "/warm");
+    
+    const size_t timed = cold ? options.cold_packets : options.packets;
+    auto symbols = make_symbols(options.symbols);
+    PacketStream stream = make_stream(kind, symbols, options, timed);
+    
+    MarketDataHandler market_data;
+    for (const auto& symbol : symbols) {
+        market_data.subscribe(symbol, [](const FeedEvent&) {});
+    }
+    
+    std::unique_ptr<CacheEvictor> evictor;
+    if (cold) {
+        evictor = std::make_unique<CacheEvictor>(options.evict_mb);
+    }
+    
+    PerfReport counters_start = PerfCounters::snapshot();
+    for (size_t i = 0; i < stream.packets.size(); ++i) {
+        const auto [offset, length] = stream.packets[i];
+        const uint8_t* packet = stream.data.data() + offset;
+        
+        if (i < options.warmup_packets) {
+            market_data.process_buffer(packet, length);
+            continue;
+        }
+        if (i == options.warmup_packets) {
+            counters_start = PerfCounters::snapshot();
+        }
+        if (evictor) {
+            evictor->evict();
+        }
+        
+        uint64_t start = CycleCounter::start();
+        size_t processed = market_data.process_buffer(packet, length);
+        uint64_t end = CycleCounter::end();
+        
+        result.latency.record(ticks_to_ns(end - start));
+        result.messages += processed;
+    }
+    
+    result.counters = PerfCounters::snapshot() - counters_start;
+    return result;
+}
+
+// Decode, book update, strategy signal and order submission of every packet
+// With static_engine the strategy and sink are bound at compile time
+ScenarioResult run_tick_to_trade(FlowKind kind, bool cold, bool static_engine, const Options& options) {
+    ScenarioResult result;
+    result.name = std::string(static_engine ? "tick_to_trade_static/" : "tick_to_trade/") + flow_name(kind) +
+                  (cold ? "/cold" : "/warm");
+    
+    const size_t timed = cold ? options.cold_packets : options.packets;
+    auto symbols = make_symbols(options.symbols);
+    PacketStream stream = make_stream(kind, symbols, options, timed);
+    
+    auto market_data = std::make_shared<MarketDataHandler>();
+    for (const auto& symbol : symbols) {
+        market_data->subscribe(symbol, [](const FeedEvent&) {});
+    }
+    
+    // Execution on its own core when there is one
+    const bool dedicated = cpu_count() >= 2;
+    ExecutionConfig execution_config;
+    execution_config.mode = ExecutionMode::BUSY_POLL;
+    execution_config.backoff = idle_policy(dedicated);
+    execution_config.cpu = dedicated ? 1 : -1;
+    execution_config.event_time = true;
+    if (dedicated) {
+        pin_current_thread(0);
+    }
+    result.pinned = dedicated;
+    
+    ExecutionEngine execution(market_data, execution_config);
+    SubmitSink sink(execution);
+    StrategyEngine strategies(market_data);
+    strategies.register_strategy(std::make_shared<TopOfBookStrategy>());
+    strategies.set_signal_sink(&sink);
+    StaticStrategyEngine static_strategies(sink, TopOfBookStrategy());
+    strategies.start();
+    static_strategies.start();
+    execution.start();
+    
+    // The handler runs the strategy once per book touched by a packet
+    if (!static_engine) {
+        market_data->set_strategy_engine(&strategies);
+    }
+    
+    std::unique_ptr<CacheEvictor> evictor;
+    if (cold) {
+        evictor = std::make_unique<CacheEvictor>(options.evict_mb);
+    }
+    
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    PerfReport counters_start = PerfCounters::snapshot();
+    for (size_t i = 0; i < stream.packets.size(); ++i) {
+        const auto [offset, length] = stream.packets[i];
+        const uint8_t* packet = stream.data.data() + offset;
+        const bool timed_packet = i >= options.warmup_packets;
+        
+        if (timed_packet && i == options.warmup_packets) {
+            accepted = sink.accepted;
+            rejected = sink.rejected;
+            counters_start = PerfCounters::snapshot();
+        }
+        if (timed_packet && evictor) {
+            evictor->evict();
+        }
+        
+        uint64_t start = CycleCounter::start();
+        size_t processed = static_engine ? market_data->process_buffer(packet, length, static_strategies)
+                                         : market_data->process_buffer(packet, length);
+        uint64_t end = CycleCounter::end();
+        
+        // Let the simulated exchange catch up with the feed
+        execution.advance_time(stream.last_timestamp[i]);
+        
+        if (timed_packet) {
+            result.latency.record(ticks_to_ns(end - start));
+            result.messages += processed;
+        }
+    }
+    
+    result.counters = PerfCounters::snapshot() - counters_start;
+    market_data->set_strategy_engine(nullptr);
+    execution.stop();
+    strategies.stop();
+    static_strategies.stop();
+    
+    result.extra.emplace_back("orders_accepted", static_cast<double>(sink.accepted - accepted));
+    result.extra.emplace_back("orders_rejected", static_cast<double>(sink.rejected - rejected));
+    return result;
+}
+
+// Timestamped message crossing the queue hops
+struct HopMessage {
+    uint64_t sent_ticks;
+    uint64_t sequence;
+};
+
+// Latency through two SPSC queue hops between pinned threads
+ScenarioResult run_queue_hops(const Options& options) {
+    ScenarioResult result;
+    result.name = "queue_hops/2_hops";
+    
+    using HopQueue = LockFreeQueue<HopMessage, 1024>;
+    auto first = std::make_unique<HopQueue>();
+    auto second = std::make_unique<HopQueue>();
+    
+    const bool dedicated = cpu_count() >= 3;
+    const BackoffPolicy policy = idle_policy(dedicated);
+    const size_t total = options.hop_messages;
+    result.pinned = dedicated;
+    
+    // Middle stage: forward from the first queue to the second
+    std::thread forwarder([&] {
+        if (dedicated) {
+            pin_current_thread(1);
+        }
+        Backoff backoff(policy);
+        HopMessage message;
+        for (size_t forwarded = 0; forwarded < total;) {
+            if (!first->try_pop(message)) {
+                backoff.idle();
+                continue;
+            }
+            backoff.reset();
+            while (!second->try_push(message)) {
+                Backoff::cpu_relax();
+            }
+            forwarded++;
+        }
+    });
+    
+    // Last stage: record the latency of every message
+    LatencyHistogram latency;
+    std::thread consumer([&] {
+        if (dedicated) {
+            pin_current_thread(2);
+        }
+        Backoff backoff(policy);
+        HopMessage message;
+        for (size_t received = 0; received < total;) {
+            if (!second->try_pop(message)) {
+                backoff.idle();
+                continue;
+            }
+            backoff.reset();
+            latency.record(ticks_to_ns(CycleCounter::end() - message.sent_ticks));
+            received++;
+        }
+    });
+    
+    // First stage: send one message every 2 us so the queues stay short
+    if (dedicated) {
+        pin_current_thread(0);
+    }
+    const uint64_t interval = CycleCounter::ns_to_cycles(2000);
+    uint64_t next_send = CycleCounter::start();
+    for (size_t sent = 0; sent < total; ++sent) {
+        while (CycleCounter::start() < next_send) {
+            if (dedicated) {
+                Backoff::cpu_relax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        next_send += interval;
+        
+        HopMessage message{CycleCounter::start(), sent};
+        while (!first->try_push(message)) {
+            Backoff::cpu_relax();
+        }
+    }
+    
+    forwarder.join();
+    consumer.join();
+    
+    result.latency = latency;
+    result.extra.emplace_back("send_interval_ns", 2000.0);
+    return result;
+}
+
+// TradingRuntime from publish() to the end of the shard's strategy pass
+ScenarioResult run_runtime(const Options& options) {
+    ScenarioResult result;
+    result.name = "runtime/price_walk";
+    
+    auto symbols = make_symbols(options.symbols);
+    PacketStream stream = make_stream(FlowKind::PRICE_WALK, symbols, options, options.packets);
+    
+    auto market_data = std::make_shared<MarketDataHandler>();
+    for (const auto& symbol : symbols) {
+        market_data->subscribe(symbol, [](const FeedEvent&) {});
+    }
+    
+    // Publisher, feed, shard, risk and execution on their own cores if possible
+    const bool dedicated = cpu_count() >= 5;
+    RuntimeConfig config;
+    config.shards = 1;
+    config.backoff = idle_policy(dedicated);
+    if (dedicated) {
+        config.feed_cpu = 1;
+        config.shard_cpus = {2};
+        config.risk_cpu = 3;
+        config.execution_cpu = 4;
+        pin_current_thread(0);
+    }
+    result.pinned = dedicated;
+    
+    ExecutionConfig execution;
+    execution.event_time = true;
+    TradingRuntime runtime(market_data, config, execution);
+    runtime.add_strategies([](size_t, const std::vector<std::string>&, StrategyEngine& engine) {
+        engine.register_strategy(std::make_shared<TopOfBookStrategy>());
+    });
+    runtime.start();
+    
+    // Publish one packet every 5 us, measuring from the end of the warm-up
+    const uint64_t interval = CycleCounter::ns_to_cycles(5000);
+    uint64_t next_send = CycleCounter::start();
+    LatencyHistogram warmup;
+    PerfReport counters_start = PerfCounters::snapshot();
+    for (size_t i = 0; i < stream.packets.size(); ++i) {
+        if (i == options.warmup_packets) {
+            while (runtime.stats().packets < i) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            warmup = runtime.tick_to_signal();
+            counters_start = PerfCounters::snapshot();
+        }
+        
+        while (CycleCounter::start() < next_send) {
+            if (dedicated) {
+                Backoff::cpu_relax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        next_send += interval;
+        
+        const auto [offset, length] = stream.packets[i];
+        while (!runtime.publish(stream.data.data() + offset, length)) {
+            std::this_thread::yield();
+        }
+        if (i >= options.warmup_packets) {
+            result.messages += stream.messages[i];
+        }
+    }
+    
+    // Let the last packets drain through the shard
+    while (runtime.stats().packets < stream.packets.size()) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    result.latency = runtime.tick_to_signal().interval(warmup);
+    result.counters = PerfCounters::snapshot() - counters_start;
+    
+    RuntimeStats stats = runtime.stats();
+    runtime.stop();
+    
+    result.extra.emplace_back("signals", static_cast<double>(stats.signals));
+    result.extra.emplace_back("publish_interval_ns", 5000.0);
+    return result;
+}
+
+// Print one scenario as HDR percentiles
+void print_result(const ScenarioResult& result) {
+    const LatencyHistogram& latency = result.latency;
+    std::cout << "Benchmark: " << result.name << (result.pinned ? " (pinned)" : "") << std::endl;
+    std::cout << "  Samples:  " << std::setw(10) << latency.count() << std::endl;
+    if (result.messages > 0 && latency.count() > 0) {
+        double per_message = latency.mean() * static_cast<double>(latency.count()) / static_cast<double>(result.messages);
+        std::cout << "  Per msg:  " << std::setw(10) << std::fixed << std::setprecision(2) << per_message << " ns" << std::endl;
+    }
+    std::cout << "  Min:      " << std::setw(10) << latency.min() << " ns" << std::endl;
+    std::cout << "  Mean:     " << std::setw(10) << std::fixed << std::setprecision(2) << latency.mean() << " ns" << std::endl;
+    std::cout << "  50th:     " << std::setw(10) << latency.percentile(0.5) << " ns" << std::endl;
+    std::cout << "  90th:     " << std::setw(10) << latency.percentile(0.9) << " ns" << std::endl;
+    std::cout << "  99th:     " << std::setw(10) << latency.percentile(0.99) << " ns" << std::endl;
+    std::cout << "  99.9th:   " << std::setw(10) << latency.percentile(0.999) << " ns" << std::endl;
+    std::cout << "  99.99th:  " << std::setw(10) << latency.percentile(0.9999) << " ns" << std::endl;
+    std::cout << "  Max:      " << std::setw(10) << latency.max() << " ns" << std::endl;
+    for (const auto& [key, value] : result.extra) {
+        std::cout << "  " << key << ": " << std::setprecision(0) << value << std::endl;
+    }
+    for (size_t i = 0; i < PERF_STAGE_COUNT; ++i) {
+        const PerfCounts& counts = result.counters.stages[i];
+        if (counts.samples == 0) {
+            continue;
+        }
+        std::cout << "  " << perf_stage_name(static_cast<PerfStage>(i)) << " (per sample): " << std::setprecision(1)
+                  << counts.per_sample(counts.instructions) << " instructions, "
+                  << counts.per_sample(counts.cycles) << " cycles, IPC " << std::setprecision(2) << counts.ipc()
+                  << ", L1D misses " << counts.per_sample(counts.l1d_misses)
+                  << ", LLC misses " << counts.per_sample(counts.llc_misses)
+                  << ", branch misses " << counts.per_sample(counts.branch_misses) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// Get the state of the hardware counters
+const char* perf_counter_state() {
+    if (!PerfCounters::compiled_in()) {
+        return "off";
+    }
+    return PerfCounters::available() ? "on" : "unavailable";
+}
+
+// Write all results as JSON
+void write_json(std::ostream& out, const std::vector<ScenarioResult>& results, const Options& options) {
+    out << "{\n";
+    out << "  \"benchmark\": \"pipeline\",\n";
+    out << "  \"cpu_count\": " << cpu_count() << ",\n";
+    out << "  \"tsc_ghz\": " << std::fixed << std::setprecision(4) << TscClock::ticks_per_ns() << ",\n";
+    out << "  \"seed\": " << options.seed << ",\n";
+    out << "  \"symbols\": " << options.symbols << ",\n";
+    out << "  \"perf_counters\": \"" << perf_counter_state() << "\",\n";
+    out << "  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScenarioResult& result = results[i];
+        const LatencyHistogram& latency = result.latency;
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"unit\": \"ns\",\n";
+        out << "      \"pinned\": " << (result.pinned ? "true" : "false") << ",\n";
+        out << "      \"samples\": " << latency.count() << ",\n";
+        out << "      \"messages\": " << result.messages << ",\n";
+        out << "      \"min\": " << latency.min() << ",\n";
+        out << "      \"mean\": " << std::fixed << std::setprecision(2) << latency.mean() << ",\n";
+        out << "      \"p50\": " << latency.percentile(0.5) << ",\n";
+        out << "      \"p90\": " << latency.percentile(0.9) << ",\n";
+        out << "      \"p99\": " << latency.percentile(0.99) << ",\n";
+        out << "      \"p999\": " << latency.percentile(0.999) << ",\n";
+        out << "      \"p9999\": " << latency.percentile(0.9999) << ",\n";
+        out << "      \"max\": " << latency.max();
+        for (const auto& [key, value] : result.extra) {
+            out << ",\n      \"" << key << "\": " << std::setprecision(0) << value;
+        }
+        bool counted = false;
+        for (size_t stage = 0; stage < PERF_STAGE_COUNT; ++stage) {
+            const PerfCounts& counts = result.counters.stages[stage];
+            if (counts.samples == 0) {
+                continue;
+            }
+            out << (counted ? "," : ",\n      \"counters\": {");
+            out << "\n        \"" << perf_stage_name(static_cast<PerfStage>(stage)) << "\": {"
+                << "\"samples\": " << counts.samples
+                << ", \"instructions\": " << counts.instructions
+                << ", \"cycles\": " << counts.cycles
+                << ", \"l1d_misses\": " << counts.l1d_misses
+                << ", \"llc_misses\": " << counts.llc_misses
+                << ", \"branch_misses\": " << counts.branch_misses << "}";
+            counted = true;
+        }
+        if (counted) {
+            out << "\n      }";
+        }
+        out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Parse --name=value options
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        size_t equals = arg.find('=');
+        if (arg.substr(0, 2) != "--" || equals == std::string_view::npos) {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+        std::string key(arg.substr(2, equals - 2));
+        std::string value(arg.substr(equals + 1));
+        
+        if (key == "packets") {
+            options.packets = std::stoull(value);
+        } else if (key == "warmup-packets") {
+            options.warmup_packets = std::stoull(value);
+        } else if (key == "cold-packets") {
+            options.cold_packets = std::stoull(value);
+        } else if (key == "symbols") {
+            options.symbols = std::max<size_t>(1, std::stoull(value));
+        } else if (key == "hop-messages") {
+            options.hop_messages = std::stoull(value);
+        } else if (key == "evict-mb") {
+            options.evict_mb = std::stoull(value);
+        } else if (key == "seed") {
+            options.seed = std::stoull(value);
+        } else if (key == "scenario") {
+            options.scenario = value;
+        } else if (key == "json") {
+            options.json = value;
+        } else {
+            std::cerr << "Unknown option: --" << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: pipeline_benchmark [--packets=N] [--warmup-packets=N] [--cold-packets=N] "
+                     "[--symbols=N] [--hop-messages=N] [--evict-mb=N] [--seed=N] [--scenario=NAME] "
+                     "[--json=FILE|-]" << std::endl;
+        return 1;
+    }
+    
+    // Initialize logger
+    Logger::instance().initialize("benchmark.log", LogLevel::WARNING);
+    Logger::instance().start();
+    
+    if (PerfCounters::compiled_in() && options.json != "-") {
+        std::cout << "Hardware counters: " << perf_counter_state() << std::endl;
+    }
+    
+    // Scenarios in run order
+    using Runner = std::function<ScenarioResult()>;
+    std::vector<std::pair<std::string, Runner>> scenarios = {
+        {"decode/price_walk/warm", [&] { return run_decode(FlowKind::PRICE_WALK, false, options); }},
+        {"decode/price_walk/cold", [&] { return run_decode(FlowKind::PRICE_WALK, true, options); }},
+        {"decode/cancel_heavy/warm", [&] { return run_decode(FlowKind::CANCEL_HEAVY, false, options); }},
+        {"decode/cancel_heavy/cold", [&] { return run_decode(FlowKind::CANCEL_HEAVY, true, options); }},
+        {"tick_to_trade/price_walk/warm", [&] { return run_tick_to_trade(FlowKind::PRICE_WALK, false, false, options); }},
+        {"tick_to_trade/price_walk/cold", [&] { return run_tick_to_trade(FlowKind::PRICE_WALK, true, false, options); }},
+        {"tick_to_trade/cancel_heavy/warm", [&] { return run_tick_to_trade(FlowKind::CANCEL_HEAVY, false, false, options); }},
+        {"tick_to_trade/cancel_heavy/cold", [&] { return run_tick_to_trade(FlowKind::CANCEL_HEAVY, true, false, options); }},
+        {"tick_to_trade_static/price_walk/warm", [&] { return run_tick_to_trade(FlowKind::PRICE_WALK, false, true, options); }},
+        {"tick_to_trade_static/price_walk/cold", [&] { return run_tick_to_trade(FlowKind::PRICE_WALK, true, true, options); }},
+        {"queue_hops/2_hops", [&] { return run_queue_hops(options); }},
+        {"runtime/price_walk", [&] { return run_runtime(options); }},
+    };
+    
+    const bool json_stdout = options.json == "-";
+    std::vector<ScenarioResult> results;
+    for (const auto& [name, run] : scenarios) {
+        if (!options.scenario.empty() && name.find(options.scenario) == std::string::npos) {
+            continue;
+        }
+        if (!json_stdout) {
+            std::cout << "Running " << name << "..." << std::endl;
+        }
+        results.push_back(run());
+        if (!json_stdout) {
+            print_result(results.back());
+        }
+    }
+    
+    if (json_stdout) {
+        write_json(std::cout, results, options);
+    } else if (!options.json.empty()) {
+        std::ofstream out(options.json);
+        write_json(out, results, options);
+        std::cout << "Results written to " << options.json << std::endl;
+    }
+    
+    // Stop logger
+    Logger::instance().stop();
+    
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "trading/support/logger.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace trading;
+
+// Format a binary log written with LogOutput::BINARY as text
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary log file>" << std::endl;
+        return 1;
+    }
+    
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    if (!Logger::decode(in, std::cout)) {
+        std::cerr << argv[1] << " is not a binary log or is truncated" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include "trading/core/execution_engine.h"
 #include "trading/core/market_data.h"
 #include "trading/core/order_book.h"
+#include "trading/core/risk_gate.h"
 #include "trading/core/strategy_engine.h"
+#include "trading/core/trading_runtime.h"
+#include "trading/io/capture.h"
 #include "trading/support/config.h"
 #include "trading/support/logger.h"
+#include "trading/utils/page_allocator.h"
+#include "trading/utils/perf_counters.h"
 #include "trading/utils/timekeeper.h"
+#include "trading/utils/tsc_clock.h"
 
 #include <chrono>
 #include <csignal>
@@ -15,6 +21,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -47,7 +54,7 @@ std::vector<uint8_t> generate_market_data(const std::vector<std::string>& symbol
     for (size_t i = 0; i < num_messages; ++i) {
         // Create a new market data message
         MarketDataMessage msg;
-        msg.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+        msg.timestamp = TscClock::now_ns();
         msg.type = static_cast<MessageType>(msg_type_dist(gen));
         
         // Select a random symbol
@@ -64,16 +71,16 @@ std::vector<uint8_t> generate_market_data(const std::vector<std::string>& symbol
                 break;
                 
             case MessageType::MODIFY_ORDER:
-                msg.modify_order.order_id = std::max(1ULL, order_id - 1);
+                msg.modify_order.order_id = std::max<uint64_t>(1, order_id - 1);
                 msg.modify_order.quantity = quantity_dist(gen);
                 break;
                 
             case MessageType::CANCEL_ORDER:
-                msg.cancel_order.order_id = std::max(1ULL, order_id - 1);
+                msg.cancel_order.order_id = std::max<uint64_t>(1, order_id - 1);
                 break;
                 
             case MessageType::EXECUTE_ORDER:
-                msg.execute_order.order_id = std::max(1ULL, order_id - 1);
+                msg.execute_order.order_id = std::max<uint64_t>(1, order_id - 1);
                 msg.execute_order.exec_quantity = quantity_dist(gen);
                 msg.execute_order.exec_price = price_dist(gen);
                 break;
@@ -100,8 +107,8 @@ std::vector<uint8_t> generate_market_data(const std::vector<std::string>& symbol
 }
 
 // Execution report callback
-void on_execution_report(const ExecutionReport& report) {
-    std::string status;
+void on_execution_report(const ExecutionReport& report, const SymbolRegistry& symbols) {
+    const char* status;
     switch (report.status) {
         case OrderStatus::NEW: status = "NEW"; break;
         case OrderStatus::PENDING: status = "PENDING"; break;
@@ -112,28 +119,22 @@ void on_execution_report(const ExecutionReport& report) {
         default: status = "UNKNOWN"; break;
     }
     
-    LOG_INFO("Execution report: id=" + std::to_string(report.order_id) + 
-             ", status=" + status + 
-             ", price=" + std::to_string(report.price) + 
-             ", exec_qty=" + std::to_string(report.exec_quantity) + 
-             ", leaves_qty=" + std::to_string(report.leaves_quantity) + 
-             ", symbol=" + report.symbol);
+    LOG_FMT(LogLevel::INFO, "Execution report: id={}, status={}, price={}, exec_qty={}, leaves_qty={}, symbol={}",
+            report.order_id, status, report.price, report.exec_quantity, report.leaves_quantity,
+            symbols.name(report.symbol_id));
 }
 
 // Signal callback
-void on_signal(const Signal& signal) {
-    std::string type;
+void on_signal(const Signal& signal, const SymbolRegistry& symbols) {
+    const char* type;
     switch (signal.type) {
         case SignalType::BUY: type = "BUY"; break;
         case SignalType::SELL: type = "SELL"; break;
         default: type = "NONE"; break;
     }
     
-    LOG_INFO("Signal: type=" + type + 
-             ", symbol=" + signal.symbol + 
-             ", price=" + std::to_string(signal.price) + 
-             ", quantity=" + std::to_string(signal.quantity) + 
-             ", confidence=" + std::to_string(signal.confidence));
+    LOG_FMT(LogLevel::INFO, "Signal: type={}, symbol={}, price={}, quantity={}, confidence={}",
+            type, symbols.name(signal.symbol_id), signal.price, signal.quantity, signal.confidence);
 }
 
 int main(int argc, char* argv[]) {
@@ -142,9 +143,19 @@ int main(int argc, char* argv[]) {
     std::signal(SIGTERM, signal_handler);
     
     // Initialize logger
-    Logger::instance().initialize("trading_simulator.log", LogLevel::INFO);
+    // --binary-log writes raw records, formatted offline by log_decoder
+    bool binary_log = false;
+    for (int i = 1; i < argc; ++i) {
+        binary_log = binary_log || std::string_view(argv[i]) == "--binary-log";
+    }
+    
+    Logger::instance().initialize(binary_log ? "trading_simulator.bin" : "trading_simulator.log", LogLevel::INFO,
+                                  binary_log ? LogOutput::BINARY : LogOutput::TEXT);
     Logger::instance().start();
     
+    // Keep the TSC clock aligned with the realtime clock
+    TscClock::start_recalibration();
+    
     LOG_INFO("Trading Simulator starting up");
     
     // Load configuration
@@ -154,6 +165,12 @@ int main(int argc, char* argv[]) {
     ConfigManager::instance().set("strategy.stat_arb.window_size", "100");
     
     // Parse command-line arguments
+    // --capture=<file> records the generated market data, --replay=<file>[,<file>...]
+    // replays captures instead (merged by time, as fast as possible unless
+    // --replay-speed=<x> paces them, 1 = original pace)
+    std::string capture_file;
+    std::vector<std::string> replay_files;
+    double replay_speed = 0.0;
     for (int i = 1; i < argc; ++i) {
         std::string arg(argv[i]);
         if (arg.find("--config=") == 0) {
@@ -163,6 +180,13 @@ int main(int argc, char* argv[]) {
             } else {
                 LOG_ERROR("Failed to load configuration from " + config_file);
             }
+        } else if (arg.find("--capture=") == 0) {
+            capture_file = arg.substr(10);
+        } else if (arg.find("--replay=") == 0) {
+            ConfigValue files(arg.substr(9));
+            replay_files = files.as_string_list();
+        } else if (arg.find("--replay-speed=") == 0) {
+            replay_speed = std::stod(arg.substr(15));
         }
     }
     
@@ -180,47 +204,119 @@ int main(int argc, char* argv[]) {
     
     // Subscribe to market data for all symbols
     for (const auto& symbol : symbols) {
-        market_data->subscribe(symbol, [](const MarketDataMessage&, std::string_view) {
+        market_data->subscribe(symbol, [](const FeedEvent&) {
             // Just a dummy callback for demonstration
         });
     }
     
+    // Warm start: size every book up front and run synthetic order flow
+    // through it, so the first messages after the open run at steady-state
+    // speed (runtime.orders_per_book, runtime.warm_up_rounds, runtime.warm_up_price)
+    RuntimeConfig startup = RuntimeConfig::from_config(ConfigManager::instance());
+    market_data->preload(symbols, startup.orders_per_book);
+    for (const auto& symbol : symbols) {
+        market_data->warm_up(market_data->symbol_id(symbol), startup.warm_up_price, startup.warm_up_rounds);
+    }
+    
     // Create strategy engine
     auto strategy_engine = std::make_shared<StrategyEngine>(market_data);
     
-    // Register statistical arbitrage strategy
+    // Register statistical arbitrage strategy (its threshold follows the
+    // configuration live; the window size is fixed at startup)
     auto stat_arb = std::make_shared<StatArbitrageStrategy>(
         symbols,
-        ConfigManager::instance().get("strategy.stat_arb.z_score_threshold").as_double(),
+        ConfigManager::instance().snapshot<StatArbParameters>("strategy.stat_arb.", StatArbParameters::from_config),
         ConfigManager::instance().get("strategy.stat_arb.window_size").as_uint()
     );
     strategy_engine->register_strategy(stat_arb);
     
-    // Set signal callback
-    strategy_engine->set_signal_callback(on_signal);
-    
     // Create execution engine
     auto execution_engine = std::make_shared<ExecutionEngine>(market_data);
     
+    // Create pre-trade risk gate (limits follow the risk.* keys live)
+    auto risk_gate = std::make_shared<RiskGate>(
+        execution_engine, ConfigManager::instance().snapshot<RiskLimits>("risk.", RiskLimits::from_config));
+    
+    // Set signal callback
+    strategy_engine->set_signal_callback([&market_data, &risk_gate](const Signal& signal) {
+        on_signal(signal, market_data->symbols());
+        
+        // Price band around the symbol's current mid
+        if (const BookPublication* publication = market_data->book_publication(signal.symbol_id)) {
+            if (auto mid = publication->top.load().mid_price()) {
+                risk_gate->set_reference_price(signal.symbol_id, *mid);
+            }
+        }
+        risk_gate->submit(signal);
+    });
+    
     // Set execution report callback
-    execution_engine->set_execution_callback(on_execution_report);
+    execution_engine->set_execution_callback([&market_data, &risk_gate](const ExecutionReport& report) {
+        risk_gate->on_execution_report(report);
+        on_execution_report(report, market_data->symbols());
+    });
     
     // Start engines
     strategy_engine->start();
     execution_engine->start();
     
+    // Drive the strategies from the books (conflated to once per book and batch)
+    market_data->set_strategy_engine(strategy_engine.get());
+    
+    // Keep every page resident from here on (runtime.lock_memory)
+    if (startup.lock_memory && !lock_memory()) {
+        LOG_WARNING("Failed to lock memory (needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK)");
+    }
+    
     LOG_INFO("Engines started, beginning simulation");
+    if (PerfCounters::compiled_in() && !PerfCounters::available()) {
+        LOG_WARNING("Hardware performance counters are unavailable (no PMU access), stage counters disabled");
+    }
     
     // Simulation loop
-    Timekeeper timer;
+    Timekeeper timer(TimekeeperMode::HISTOGRAM);
+    LatencyHistogram reported;
+    PerfReport reported_counters = PerfCounters::snapshot();
     size_t message_count = 0;
     const size_t messages_per_batch = 1000;
     
+    if (!replay_files.empty()) {
+        // Replay captured market data straight out of the mapped files
+        CaptureReplay replay(ReplayConfig{replay_speed, true});
+        for (const auto& file : replay_files) {
+            if (!replay.add_file(file)) {
+                LOG_ERROR("Failed to open capture file " + file);
+            }
+        }
+        
+        replay.run([&](const ReceivedPacket& packet) {
+            if (!g_running) {
+                replay.stop();
+                return;
+            }
+            timer.start();
+            market_data->process_buffer(packet.data, packet.length);
+            timer.end();
+        });
+        
+        const ReplayStats& stats = replay.stats();
+        LOG_FMT(LogLevel::INFO, "Replayed {} packets ({} bytes, {} s of capture) in {} ms", stats.packets,
+                stats.bytes, (stats.last_ns - stats.first_ns) / 1e9, stats.elapsed_ns / 1e6);
+        g_running = false;
+    }
+    
+    CaptureWriter capture;
+    if (!capture_file.empty() && !capture.open(capture_file)) {
+        LOG_ERROR("Failed to create capture file " + capture_file);
+    }
+    
     while (g_running) {
         // Generate some random market data
         auto data = generate_market_data(symbols, messages_per_batch);
+        if (capture.is_open()) {
+            capture.write(data.data(), data.size(), TscClock::now_ns());
+        }
         
-                // Fix for the unused variable warning
         timer.start();
         market_data->process_buffer(data.data(), data.size());
         timer.end();
@@ -229,9 +325,25 @@ int main(int argc, char* argv[]) {
         
         // Log statistics
         if (message_count % 10000 == 0) {
-            LOG_INFO("Processed " + std::to_string(message_count) + " messages, " +
-                     "last batch in " + std::to_string(timer.average() / 1000.0) + " μs, " +
-                     "avg latency: " + std::to_string(timer.average()) + " ns");
+            LatencyHistogram interval = timer.latency_histogram().interval(reported);
+            LOG_FMT(LogLevel::INFO, "Processed {} messages, avg latency: {} ns, p50/p99/p99.9: {}/{}/{} ns",
+                    message_count, interval.mean(), interval.percentile(0.5), interval.percentile(0.99),
+                    interval.percentile(0.999));
+            
+            // Hardware counters of the interval (only with TRADING_PERF_COUNTERS)
+            PerfReport counters = PerfCounters::snapshot();
+            PerfReport counter_interval = counters - reported_counters;
+            reported_counters = counters;
+            for (size_t i = 0; i < PERF_STAGE_COUNT; ++i) {
+                const PerfCounts& stage = counter_interval.stages[i];
+                if (stage.samples > 0) {
+                    LOG_FMT(LogLevel::INFO, "{}: {} samples, IPC {}, per sample {} cycles, {} L1D misses, "
+                            "{} LLC misses, {} branch misses", perf_stage_name(static_cast<PerfStage>(i)),
+                            stage.samples, stage.ipc(), stage.per_sample(stage.cycles),
+                            stage.per_sample(stage.l1d_misses), stage.per_sample(stage.llc_misses),
+                            stage.per_sample(stage.branch_misses));
+                }
+            }
             
             // Print order book snapshots
             for (const auto& symbol : symbols) {
@@ -253,15 +365,23 @@ int main(int argc, char* argv[]) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
+    if (capture.is_open()) {
+        capture.close();
+        LOG_FMT(LogLevel::INFO, "Captured {} packets to {}", capture.records(), capture_file);
+    }
+    
     LOG_INFO("Simulation complete, processed " + std::to_string(message_count) + " messages");
     LOG_INFO("Average processing latency: " + std::to_string(timer.average()) + " ns");
-    LOG_INFO("99th percentile latency: " + std::to_string(timer.percentile(0.99)) + " ns");
+    LOG_FMT(LogLevel::INFO, "Latency p50/p99/p99.9: {}/{}/{} ns", timer.percentile(0.5), timer.percentile(0.99),
+            timer.percentile(0.999));
     
     // Stop engines
+    market_data->set_strategy_engine(nullptr);
     execution_engine->stop();
     strategy_engine->stop();
     
-    // Stop logger
+    // Stop clock recalibration and logger
+    TscClock::stop_recalibration();
     Logger::instance().stop();
     
     return 0;
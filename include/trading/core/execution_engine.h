@@ -1,8 +1,12 @@
 #pragma once
 
+#include "trading/core/matching_simulator.h"
 #include "trading/core/order_book.h"
+#include "trading/core/order_state.h"
 #include "trading/core/strategy_engine.h"
-#include "trading/utils/memory_pool.h"
+#include "trading/utils/backoff.h"
+#include "trading/utils/concurrent_memory_pool.h"
+#include "trading/utils/lockfree_queue.h"
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -18,16 +22,6 @@ namespace trading {
 // Forward declarations
 class MarketDataHandler;
 
-// Order status
-enum class OrderStatus : uint8_t {
-    NEW = 0,
-    PENDING = 1,
-    PARTIALLY_FILLED = 2,
-    FILLED = 3,
-    CANCELED = 4,
-    REJECTED = 5
-};
-
 // Execution report
 struct ExecutionReport {
     OrderId order_id;
@@ -35,18 +29,20 @@ struct ExecutionReport {
     Price price;
     Quantity exec_quantity;
     Quantity leaves_quantity;
-    std::string symbol;
+    SymbolId symbol_id;
     Timestamp timestamp;
+    Side side;
     
     // Constructor
     ExecutionReport(OrderId id, OrderStatus st, Price p, Quantity exec_qty, Quantity leaves_qty, 
-                    std::string_view sym, Timestamp ts)
+                    SymbolId sym, Timestamp ts, Side sd = Side::BUY)
         : order_id(id), status(st), price(p), exec_quantity(exec_qty), leaves_quantity(leaves_qty),
-          symbol(sym), timestamp(ts) {}
+          symbol_id(sym), timestamp(ts), side(sd) {}
     
     // Default constructor
     ExecutionReport() : order_id(0), status(OrderStatus::NEW), price(0), 
-                        exec_quantity(0), leaves_quantity(0), timestamp(0) {}
+                        exec_quantity(0), leaves_quantity(0), symbol_id(INVALID_SYMBOL_ID), timestamp(0),
+                        side(Side::BUY) {}
 };
 
 // Execution order
@@ -55,22 +51,57 @@ struct ExecutionOrder {
     Price price;
     Quantity quantity;
     Side side;
-    std::string symbol;
+    SymbolId symbol_id;
     Timestamp timestamp;
     
     // Constructor
-    ExecutionOrder(OrderId id, Price p, Quantity q, Side s, std::string_view sym, Timestamp ts)
-        : order_id(id), price(p), quantity(q), side(s), symbol(sym), timestamp(ts) {}
+    ExecutionOrder(OrderId id, Price p, Quantity q, Side s, SymbolId sym, Timestamp ts)
+        : order_id(id), price(p), quantity(q), side(s), symbol_id(sym), timestamp(ts) {}
     
     // Default constructor
-    ExecutionOrder() : order_id(0), price(0), quantity(0), side(Side::BUY), timestamp(0) {}
+    ExecutionOrder() : order_id(0), price(0), quantity(0), side(Side::BUY), symbol_id(INVALID_SYMBOL_ID), timestamp(0) {}
+};
+
+// Execution engine threading mode
+enum class ExecutionMode : uint8_t {
+    BLOCKING = 0,   // Mutex-protected queue, consumer sleeps on a condition variable
+    BUSY_POLL = 1   // Lock-free MPSC ring, consumer polls with a backoff policy
+};
+
+// Execution engine configuration
+struct ExecutionConfig {
+    // Threading mode
+    ExecutionMode mode = ExecutionMode::BLOCKING;
+    
+    // Order state slots (rounded up to a power of two)
+    // Orders are indexed by ID modulo this, so it bounds the working orders
+    size_t order_slots = 64 * 1024;
+    
+    // Idle policy of the BUSY_POLL consumer
+    BackoffPolicy backoff;
+    
+    // CPU to pin the processing thread to (-1 = no pinning)
+    int cpu = -1;
+    
+    // Matching simulator (latency model, seed, depth)
+    SimulatorConfig simulator;
+    
+    // Run on the simulated clock driven by advance_time() instead of the
+    // steady clock, so backtests are not paced by wall-clock time
+    bool event_time = false;
 };
 
 // Execution engine class
+// Orders are executed by a MatchingSimulator against the live order books.
+// Every order's state lives in a lock-free OrderStatusTable, so status reads
+// and cancels are constant time and never contend with the processing
+// thread. In BUSY_POLL mode submit_order() never blocks or locks either: it
+// pushes the order onto a lock-free ring that the processing thread drains,
+// and all execution reports are sent from the processing thread.
 class ExecutionEngine {
 public:
     // Constructor
-    ExecutionEngine(std::shared_ptr<MarketDataHandler> market_data);
+    ExecutionEngine(std::shared_ptr<MarketDataHandler> market_data, ExecutionConfig config = ExecutionConfig());
     
     // Destructor
     ~ExecutionEngine();
@@ -82,29 +113,57 @@ public:
     void stop();
     
     // Submit an order for execution
+    // Returns 0 if the order could not be accepted (its state slot is still
+    // in use, or the BUSY_POLL ring is full)
     OrderId submit_order(const Signal& signal);
     
     // Cancel an order
+    // Returns false if the order is not working. In BUSY_POLL mode the
+    // CANCELED report is sent by the processing thread.
     bool cancel_order(OrderId order_id);
     
     // Set execution report callback
     void set_execution_callback(std::function<void(const ExecutionReport&)> callback);
     
-    // Get order status
+    // Get order status (lock-free; REJECTED for unknown orders)
     OrderStatus get_order_status(OrderId order_id) const;
     
+    // Advance the simulated clock (event_time mode; time never goes back)
+    void advance_time(Timestamp now);
+    
+    // Get the engine's current time in nanoseconds
+    Timestamp now() const;
+    
+    // Get the configuration
+    const ExecutionConfig& config() const { return config_; }
+    
 private:
+    // Order being worked by the processing thread
+    struct WorkingOrder {
+        ExecutionOrder order;  // Quantity is the leaves quantity
+        SimulatedOrder sim;
+        OrderStatus status = OrderStatus::NEW;  // Last status published by the processing thread
+        bool sent = false;     // Latency drawn by the simulator
+    };
+    
+    // Capacity of the new order ring
+    static constexpr size_t ORDER_QUEUE_CAPACITY = 4096;
+    
     // Market data handler
     std::shared_ptr<MarketDataHandler> market_data_;
     
+    // Configuration
+    ExecutionConfig config_;
+    
     // Order ID counter
     std::atomic<OrderId> next_order_id_;
     
-    // Pending orders
-    mutable std::unordered_map<OrderId, ExecutionOrder> pending_orders_;
+    // Pending orders (BLOCKING mode)
+    std::unordered_map<OrderId, WorkingOrder> pending_orders_;
     
-    // Memory pool for execution reports
-    MemoryPool<ExecutionReport> report_pool_;
+    // Memory pool for execution reports (shared by the processing thread
+    // and threads that submit or cancel orders)
+    ConcurrentMemoryPool<ExecutionReport> report_pool_;
     
     // Execution callback
     std::function<void(const ExecutionReport&)> execution_callback_;
@@ -112,23 +171,55 @@ private:
     // Order processing thread
     std::thread processing_thread_;
     
-    // Queue of orders to process
-    mutable std::deque<OrderId> order_queue_;
+    // Queue of new orders to process (BLOCKING mode)
+    std::deque<OrderId> order_queue_;
     
-    // Mutex for thread safety
-    mutable std::mutex mutex_;
+    // Mutex for thread safety (BLOCKING mode)
+    std::mutex mutex_;
     
     // Condition variable for thread signaling
     std::condition_variable condition_;
     
+    // Order states
+    OrderStatusTable statuses_;
+    
+    // New order ring (BUSY_POLL mode)
+    std::unique_ptr<MpscQueue<ExecutionOrder, ORDER_QUEUE_CAPACITY>> new_orders_;
+    
+    // Working orders indexed like statuses_ (BUSY_POLL mode, processing thread only)
+    std::unique_ptr<WorkingOrder[]> slots_;
+    
+    // Orders being worked by the processing thread
+    std::vector<OrderId> working_;
+    
+    // Matching simulator (processing thread only)
+    MatchingSimulator simulator_;
+    
+    // Simulated clock (event_time mode)
+    std::atomic<Timestamp> market_time_;
+    
     // Running flag
     std::atomic<bool> running_;
     
-    // Order processing function
+    // Order processing function (BLOCKING mode)
     void process_orders();
     
-    // Simulate order execution
-    void simulate_execution(const ExecutionOrder& order);
+    // Order polling function (BUSY_POLL mode)
+    void poll_orders();
+    
+    // Get the working order slot of an order ID (BUSY_POLL mode)
+    WorkingOrder& slot_of(OrderId order_id) { return slots_[order_id & (statuses_.capacity() - 1)]; }
+    
+    // Match an order against its book at a time and send fill reports
+    // Reduces the order's quantity by the filled quantity. Every report
+    // follows a successful status transition, so nothing is reported for an
+    // order once a concurrent cancel won.
+    // Returns the resulting status
+    OrderStatus simulate_execution(WorkingOrder& working, Timestamp now);
+    
+    // Send an execution report through the callback
+    void send_report(const ExecutionOrder& order, OrderStatus status, Price price,
+                     Quantity exec_quantity, Quantity leaves_quantity, Timestamp timestamp);
 };
 
 } // namespace trading
\ No newline at end of file
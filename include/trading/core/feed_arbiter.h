@@ -0,0 +1,376 @@
+#pragma once
+
+#include "trading/core/feed_decoder.h"
+#include "trading/core/market_data.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace trading {
+
+// Redundant feed line a packet arrived on
+enum class FeedLine : uint8_t {
+    A = 0,
+    B = 1
+};
+
+// Feed arbiter configuration
+struct ArbiterConfig {
+    // Out-of-order packets held while waiting for the other line to fill a gap
+    size_t reorder_window = 64;
+    
+    // Largest packet payload that can be held in the reorder window
+    size_t max_packet_size = 2048;
+    
+    // How long a gap may stay open before it is declared (nanoseconds)
+    Timestamp gap_timeout_ns = 100 * 1000;
+};
+
+// Feed arbiter statistics
+struct ArbiterStats {
+    uint64_t packets[2] = {0, 0};         // Packets received per line
+    uint64_t first_arrivals[2] = {0, 0};  // Packets applied first from each line
+    uint64_t duplicates = 0;              // Packets already applied from the other line
+    uint64_t reordered = 0;               // Packets applied from the reorder window
+    uint64_t gaps = 0;                    // Gaps declared
+    uint64_t lost_messages = 0;           // Messages missing in declared gaps
+    uint64_t malformed = 0;               // Packets too short for a header
+};
+
+// Callback type for snapshot requests (inclusive range of missing sequence numbers)
+using SnapshotRequestCallback = std::function<void(uint64_t first_sequence, uint64_t last_sequence)>;
+
+// Arbiter merging the redundant A and B lines of a sequenced feed
+// Every packet starts with a PacketHeader. The first copy of each message
+// range to arrive is applied to the handler and the later copy is dropped.
+// Packets that skip ahead are held in a small reorder window while the other
+// line catches up; if the hole is not filled within the window or the
+// timeout, the gap is declared: all books are marked stale, a snapshot is
+// requested for the missing range and processing resumes after it.
+// The arbiter is driven by a single thread polling both lines, so no locks
+// are needed on the hot path.
+template<WireProtocol Protocol = NativeProtocol>
+class FeedArbiter {
+public:
+    // Constructor
+    explicit FeedArbiter(MarketDataHandler& handler, ArbiterConfig config = ArbiterConfig{});
+    
+    // Set the callback invoked when a gap is declared
+    void set_snapshot_request_callback(SnapshotRequestCallback callback) {
+        snapshot_request_callback_ = std::move(callback);
+    }
+    
+    // Process a packet received on one of the lines
+    // Returns the number of messages applied to the books
+    size_t on_packet(FeedLine line, const uint8_t* data, size_t length, Timestamp receive_ns);
+    
+    // Declare an open gap if it has timed out (call when the lines are idle)
+    // Returns the number of messages applied from the reorder window
+    size_t check_timeout(Timestamp now);
+    
+    // Restart sequencing at a given sequence number (e.g. after a snapshot)
+    // Returns the number of held messages applied after the restart point
+    size_t reset(uint64_t next_sequence);
+    
+    // Get the sequence number of the next expected message
+    uint64_t next_sequence() const { return next_sequence_; }
+    
+    // Check if a gap is currently open
+    bool in_gap() const { return gap_open_; }
+    
+    // Get arbiter statistics
+    const ArbiterStats& stats() const { return stats_; }
+    
+private:
+    // Packet held in the reorder window
+    struct PendingPacket {
+        uint64_t sequence;
+        uint16_t message_count;
+        size_t length;
+        bool used;
+        std::vector<uint8_t> payload;
+    };
+    
+    // Handler receiving the arbitrated messages
+    MarketDataHandler& handler_;
+    
+    // Configuration
+    ArbiterConfig config_;
+    
+    // Sequence number of the next expected message
+    uint64_t next_sequence_;
+    
+    // Highest sequence number announced by any packet (exclusive)
+    uint64_t highest_sequence_;
+    
+    // Set once the first packet has fixed the starting sequence
+    bool synchronized_;
+    
+    // Set while messages are missing
+    bool gap_open_;
+    
+    // Time the current gap was first seen
+    Timestamp gap_start_ns_;
+    
+    // Receive time of the latest packet
+    Timestamp last_receive_ns_;
+    
+    // Reorder window (pre-allocated slots)
+    std::vector<PendingPacket> pending_;
+    
+    // Number of used reorder window slots
+    size_t pending_count_;
+    
+    // Snapshot request callback
+    SnapshotRequestCallback snapshot_request_callback_;
+    
+    // Statistics
+    ArbiterStats stats_;
+    
+    // Apply a packet payload, skipping messages that were already applied
+    size_t deliver(const uint8_t* payload, size_t length, uint64_t skip);
+    
+    // Hold an out-of-order packet (false if it cannot be held)
+    bool hold(uint64_t sequence, uint16_t message_count, const uint8_t* payload, size_t length);
+    
+    // Apply held packets that are now in sequence
+    size_t drain();
+    
+    // Give up on the missing messages and resume at the next held packet
+    // (or at limit, whichever comes first)
+    size_t declare_gap(Timestamp now, uint64_t limit);
+};
+
+//
+// FeedArbiter template implementation
+//
+
+template<WireProtocol Protocol>
+FeedArbiter<Protocol>::FeedArbiter(MarketDataHandler& handler, ArbiterConfig config)
+    : handler_(handler), config_(config), next_sequence_(0), highest_sequence_(0),
+      synchronized_(false), gap_open_(false), gap_start_ns_(0), last_receive_ns_(0),
+      pending_count_(0) {
+    if (config_.reorder_window == 0) {
+        config_.reorder_window = 1;
+    }
+    
+    pending_.resize(config_.reorder_window);
+    for (auto& packet : pending_) {
+        packet.used = false;
+        packet.payload.resize(config_.max_packet_size);
+    }
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::on_packet(FeedLine line, const uint8_t* data, size_t length, Timestamp receive_ns) {
+    stats_.packets[static_cast<size_t>(line)]++;
+    
+    if (length < sizeof(PacketHeader)) {
+        stats_.malformed++;
+        return 0;
+    }
+    
+    uint64_t sequence;
+    uint16_t message_count;
+    std::memcpy(&sequence, data + offsetof(PacketHeader, sequence), sizeof(sequence));
+    std::memcpy(&message_count, data + offsetof(PacketHeader, message_count), sizeof(message_count));
+    
+    const uint8_t* payload = data + sizeof(PacketHeader);
+    size_t payload_length = length - sizeof(PacketHeader);
+    uint64_t end = sequence + message_count;
+    
+    if (!synchronized_) {
+        // Join the feed wherever it is; earlier state comes from a snapshot
+        next_sequence_ = sequence;
+        highest_sequence_ = sequence;
+        synchronized_ = true;
+    }
+    
+    if (end > highest_sequence_) {
+        highest_sequence_ = end;
+    }
+    
+    size_t applied = 0;
+    
+    if (sequence > next_sequence_) {
+        // Ahead of sequence: wait for the other line to fill the hole
+        if (!gap_open_) {
+            gap_open_ = true;
+            gap_start_ns_ = receive_ns;
+        }
+        
+        // If the window is exhausted, stop waiting and apply what we have
+        while (message_count > 0 && sequence > next_sequence_ &&
+               !hold(sequence, message_count, payload, payload_length)) {
+            applied += declare_gap(receive_ns, sequence);
+        }
+    }
+    
+    if (sequence <= next_sequence_) {
+        if (end > next_sequence_) {
+            // In sequence: the first copy wins
+            stats_.first_arrivals[static_cast<size_t>(line)]++;
+            applied += deliver(payload, payload_length, next_sequence_ - sequence);
+            next_sequence_ = end;
+            
+            if (pending_count_ > 0) {
+                applied += drain();
+            }
+        } else if (message_count > 0) {
+            // Already applied from the other line (heartbeats just confirm the sequence)
+            stats_.duplicates++;
+        }
+    }
+    
+    last_receive_ns_ = receive_ns;
+    gap_open_ = next_sequence_ < highest_sequence_;
+    if (gap_open_ && receive_ns >= gap_start_ns_ + config_.gap_timeout_ns) {
+        applied += declare_gap(receive_ns, highest_sequence_);
+    }
+    
+    return applied;
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::check_timeout(Timestamp now) {
+    if (!gap_open_ || now < gap_start_ns_ + config_.gap_timeout_ns) {
+        return 0;
+    }
+    return declare_gap(now, highest_sequence_);
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::reset(uint64_t next_sequence) {
+    next_sequence_ = next_sequence;
+    highest_sequence_ = next_sequence;
+    synchronized_ = true;
+    
+    for (const auto& packet : pending_) {
+        if (packet.used && packet.sequence + packet.message_count > highest_sequence_) {
+            highest_sequence_ = packet.sequence + packet.message_count;
+        }
+    }
+    
+    // Apply held packets that follow the restart point and drop obsolete ones
+    size_t applied = drain();
+    
+    gap_open_ = next_sequence_ < highest_sequence_;
+    gap_start_ns_ = last_receive_ns_;
+    return applied;
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::deliver(const uint8_t* payload, size_t length, uint64_t skip) {
+    // Skip a prefix already applied from a packet that overlapped this one
+    size_t offset = 0;
+    for (; skip > 0 && offset < length; --skip) {
+        size_t size = Protocol::message_size(payload + offset, length - offset);
+        if (size == 0) {
+            return 0;
+        }
+        offset += size;
+    }
+    
+    // Events carry their message's sequence number, so the handler can
+    // splice snapshots into the stream
+    handler_.set_sequence(next_sequence_);
+    return handler_.template process<Protocol>(payload + offset, length - offset);
+}
+
+template<WireProtocol Protocol>
+bool FeedArbiter<Protocol>::hold(uint64_t sequence, uint16_t message_count, const uint8_t* payload, size_t length) {
+    if (length > config_.max_packet_size) {
+        return false;
+    }
+    
+    PendingPacket* free_slot = nullptr;
+    for (auto& packet : pending_) {
+        if (packet.used && packet.sequence == sequence) {
+            stats_.duplicates++;  // Both lines skipped ahead past the same hole
+            return true;
+        }
+        if (!packet.used && !free_slot) {
+            free_slot = &packet;
+        }
+    }
+    
+    if (!free_slot) {
+        return false;
+    }
+    
+    free_slot->sequence = sequence;
+    free_slot->message_count = message_count;
+    free_slot->length = length;
+    free_slot->used = true;
+    std::memcpy(free_slot->payload.data(), payload, length);
+    pending_count_++;
+    return true;
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::drain() {
+    size_t applied = 0;
+    
+    bool progressed = true;
+    while (progressed && pending_count_ > 0) {
+        progressed = false;
+        for (auto& packet : pending_) {
+            if (!packet.used || packet.sequence > next_sequence_) {
+                continue;
+            }
+            
+            uint64_t end = packet.sequence + packet.message_count;
+            if (end > next_sequence_) {
+                applied += deliver(packet.payload.data(), packet.length, next_sequence_ - packet.sequence);
+                next_sequence_ = end;
+                stats_.reordered++;
+            } else {
+                stats_.duplicates++;
+            }
+            
+            packet.used = false;
+            pending_count_--;
+            progressed = true;
+        }
+    }
+    
+    return applied;
+}
+
+template<WireProtocol Protocol>
+size_t FeedArbiter<Protocol>::declare_gap(Timestamp now, uint64_t limit) {
+    // Resume at the earliest held packet (or the limit if nothing is held)
+    uint64_t resume = std::min(limit, highest_sequence_);
+    for (const auto& packet : pending_) {
+        if (packet.used && packet.sequence < resume) {
+            resume = packet.sequence;
+        }
+    }
+    
+    if (resume <= next_sequence_) {
+        return 0;
+    }
+    
+    uint64_t first_missing = next_sequence_;
+    stats_.gaps++;
+    stats_.lost_messages += resume - first_missing;
+    next_sequence_ = resume;
+    
+    // Any book may have missed updates until it is rebuilt from a snapshot
+    handler_.mark_stale();
+    if (snapshot_request_callback_) {
+        snapshot_request_callback_(first_missing, resume - 1);
+    }
+    
+    size_t applied = drain();
+    
+    // Holes further ahead get a fresh timeout
+    gap_open_ = next_sequence_ < highest_sequence_;
+    gap_start_ns_ = now;
+    return applied;
+}
+
+} // namespace trading
\ No newline at end of file
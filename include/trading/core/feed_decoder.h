@@ -0,0 +1,233 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace trading {
+
+// Market data message types
+enum class MessageType : uint8_t {
+    ADD_ORDER = 1,
+    MODIFY_ORDER = 2,
+    CANCEL_ORDER = 3,
+    EXECUTE_ORDER = 4,
+    TRADE = 5,
+    SNAPSHOT = 6,
+    HEARTBEAT = 7
+};
+
+// Market data message structure (compact binary format)
+#pragma pack(push, 1)
+// Define struct types outside the union
+struct AddOrderData {
+    OrderId order_id;
+    Price price;
+    Quantity quantity;
+    uint8_t side;    // 0 = Buy, 1 = Sell
+};
+
+struct ModifyOrderData {
+    OrderId order_id;
+    Quantity quantity;
+};
+
+struct CancelOrderData {
+    OrderId order_id;
+};
+
+struct ExecuteOrderData {
+    OrderId order_id;
+    Quantity exec_quantity;
+    Price exec_price;
+};
+
+struct TradeData {
+    Price price;
+    Quantity quantity;
+    uint8_t aggressor_side; // 0 = Buy, 1 = Sell
+};
+
+// Snapshot chunk flags
+constexpr uint8_t SNAPSHOT_FIRST = 0x01;  // First chunk, starts a new rebuild
+constexpr uint8_t SNAPSHOT_LAST = 0x02;   // Last chunk, completes the rebuild
+
+struct SnapshotData {
+    uint64_t sequence;       // Feed sequence number the snapshot is consistent with
+    uint8_t entry_count;     // Number of orders in this chunk
+    uint8_t flags;           // SNAPSHOT_FIRST / SNAPSHOT_LAST
+};
+
+// Resting order in a snapshot (entries follow the symbol, in time priority)
+using SnapshotEntry = AddOrderData;
+
+// Market data message structure (compact binary format)
+struct MarketDataMessage {
+    // Common header
+    uint64_t timestamp;      // Nanoseconds since epoch
+    MessageType type;        // Message type
+    uint8_t symbol_length;   // Length of symbol
+    
+    // Payload (varies by message type)
+    union {
+        AddOrderData add_order;
+        ModifyOrderData modify_order;
+        CancelOrderData cancel_order;
+        ExecuteOrderData execute_order;
+        TradeData trade;
+        SnapshotData snapshot;
+        // Heartbeat has no additional fields
+    };
+    
+    // Symbol follows the fixed portion (variable length)
+    // char symbol[symbol_length];
+};
+
+// Sequenced packet header (one per datagram, followed by message_count messages)
+// Messages are numbered consecutively across packets; a heartbeat packet
+// carries no messages and the sequence number of the next message
+struct PacketHeader {
+    uint64_t sequence;       // Sequence number of the first message
+    uint16_t message_count;  // Number of messages in the packet
+};
+#pragma pack(pop)
+
+// Decoded market data event (protocol independent)
+// The symbol view points into the buffer being decoded, so events are only
+// valid until the buffer is released
+struct FeedEvent {
+    MessageType type;
+    Side side;                // Order side, or aggressor side for trades
+    SymbolId symbol_id;       // Filled by the decoder or resolved by the handler
+    std::string_view symbol;  // Wire symbol (may be empty if the protocol sends IDs)
+    Timestamp timestamp;
+    OrderId order_id;
+    Price price;              // Order, execution or trade price
+    Quantity quantity;        // Order, modified, executed or traded quantity
+    uint64_t sequence;        // Feed sequence number of the message (0 if not sequenced),
+                              // for SNAPSHOT the one the snapshot is consistent with
+    
+    // Snapshot chunk (SNAPSHOT only)
+    const uint8_t* entries;      // Packed SnapshotEntry records in the wire buffer
+    uint8_t entry_count;         // Number of entries
+    uint8_t snapshot_flags;      // SNAPSHOT_FIRST / SNAPSHOT_LAST
+};
+
+// Fixed-capacity batch of decoded events
+struct FeedEventBatch {
+    // Maximum number of events decoded before they are applied
+    static constexpr size_t capacity = 64;
+    
+    std::array<FeedEvent, capacity> events;
+    size_t count = 0;
+    
+    // Check if the batch is full
+    bool full() const { return count == capacity; }
+    
+    // Iterators over the decoded events
+    const FeedEvent* begin() const { return events.data(); }
+    const FeedEvent* end() const { return events.data() + count; }
+};
+
+// Compile-time interface of a wire protocol decoder
+//   message_size: size of the next complete message starting at data, or 0 if
+//                 more bytes are needed to know it or to complete the message
+//   decode:       decode one complete message into an event, returning false
+//                 for messages that carry no market data (heartbeats, ...)
+//   max_message_size: upper bound on the size of a single message
+template<typename P>
+concept WireProtocol = requires(const uint8_t* data, size_t length, FeedEvent& event) {
+    { P::message_size(data, length) } -> std::convertible_to<size_t>;
+    { P::decode(data, event) } -> std::convertible_to<bool>;
+    { P::max_message_size } -> std::convertible_to<size_t>;
+};
+
+// Decoder for the native MarketDataMessage wire format
+struct NativeProtocol {
+    // Largest message: a full snapshot chunk with the longest symbol
+    static constexpr size_t max_message_size = sizeof(MarketDataMessage) + 255 + 255 * sizeof(SnapshotEntry);
+    
+    // Size of the next complete message (0 if incomplete)
+    static size_t message_size(const uint8_t* data, size_t length) {
+        if (length < sizeof(MarketDataMessage)) {
+            return 0;
+        }
+        
+        size_t total_size = sizeof(MarketDataMessage) + data[offsetof(MarketDataMessage, symbol_length)];
+        if (static_cast<MessageType>(data[offsetof(MarketDataMessage, type)]) == MessageType::SNAPSHOT) {
+            constexpr size_t count = offsetof(MarketDataMessage, snapshot) + offsetof(SnapshotData, entry_count);
+            total_size += data[count] * sizeof(SnapshotEntry);
+        }
+        return total_size <= length ? total_size : 0;
+    }
+    
+    // Decode one complete message
+    static bool decode(const uint8_t* data, FeedEvent& event) {
+        constexpr size_t payload = offsetof(MarketDataMessage, add_order);
+        
+        event.type = static_cast<MessageType>(data[offsetof(MarketDataMessage, type)]);
+        event.timestamp = load<Timestamp>(data + offsetof(MarketDataMessage, timestamp));
+        event.symbol_id = INVALID_SYMBOL_ID;
+        event.symbol = std::string_view(reinterpret_cast<const char*>(data + sizeof(MarketDataMessage)),
+                                        data[offsetof(MarketDataMessage, symbol_length)]);
+        
+        switch (event.type) {
+            case MessageType::ADD_ORDER:
+                event.order_id = load<OrderId>(data + payload + offsetof(AddOrderData, order_id));
+                event.price = load<Price>(data + payload + offsetof(AddOrderData, price));
+                event.quantity = load<Quantity>(data + payload + offsetof(AddOrderData, quantity));
+                event.side = data[payload + offsetof(AddOrderData, side)] == 0 ? Side::BUY : Side::SELL;
+                return true;
+            
+            case MessageType::MODIFY_ORDER:
+                event.order_id = load<OrderId>(data + payload + offsetof(ModifyOrderData, order_id));
+                event.quantity = load<Quantity>(data + payload + offsetof(ModifyOrderData, quantity));
+                return true;
+            
+            case MessageType::CANCEL_ORDER:
+                event.order_id = load<OrderId>(data + payload + offsetof(CancelOrderData, order_id));
+                return true;
+            
+            case MessageType::EXECUTE_ORDER:
+                event.order_id = load<OrderId>(data + payload + offsetof(ExecuteOrderData, order_id));
+                event.quantity = load<Quantity>(data + payload + offsetof(ExecuteOrderData, exec_quantity));
+                event.price = load<Price>(data + payload + offsetof(ExecuteOrderData, exec_price));
+                return true;
+            
+            case MessageType::TRADE:
+                event.order_id = 0;
+                event.price = load<Price>(data + payload + offsetof(TradeData, price));
+                event.quantity = load<Quantity>(data + payload + offsetof(TradeData, quantity));
+                event.side = data[payload + offsetof(TradeData, aggressor_side)] == 0 ? Side::BUY : Side::SELL;
+                return true;
+            
+            case MessageType::SNAPSHOT:
+                event.order_id = 0;
+                event.sequence = load<uint64_t>(data + payload + offsetof(SnapshotData, sequence));
+                event.entry_count = data[payload + offsetof(SnapshotData, entry_count)];
+                event.snapshot_flags = data[payload + offsetof(SnapshotData, flags)];
+                event.entries = data + sizeof(MarketDataMessage) + event.symbol.size();
+                return true;
+            
+            // Heartbeats (and unknown types) carry no market data
+            default:
+                return false;
+        }
+    }
+    
+    // Read an unaligned field straight from the wire buffer
+    template<typename T>
+    static T load(const uint8_t* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+};
+
+static_assert(WireProtocol<NativeProtocol>);
+
+} // namespace trading
\ No newline at end of file
@@ -1,86 +1,28 @@
 #pragma once
 
+#include "trading/core/feed_decoder.h"
 #include "trading/core/order_book.h"
+#include "trading/core/symbol_registry.h"
+#include "trading/utils/bitmap.h"
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
 namespace trading {
 
 // Forward declarations
 class RingBuffer;
-
-// Market data message types
-enum class MessageType : uint8_t {
-    ADD_ORDER = 1,
-    MODIFY_ORDER = 2,
-    CANCEL_ORDER = 3,
-    EXECUTE_ORDER = 4,
-    TRADE = 5,
-    SNAPSHOT = 6,
-    HEARTBEAT = 7
-};
-
-// Market data message structure (compact binary format)
-#pragma pack(push, 1)
-// Define struct types outside the union
-struct AddOrderData {
-    OrderId order_id;
-    Price price;
-    Quantity quantity;
-    uint8_t side;    // 0 = Buy, 1 = Sell
-};
-
-struct ModifyOrderData {
-    OrderId order_id;
-    Quantity quantity;
-};
-
-struct CancelOrderData {
-    OrderId order_id;
-};
-
-struct ExecuteOrderData {
-    OrderId order_id;
-    Quantity exec_quantity;
-    Price exec_price;
-};
-
-struct TradeData {
-    Price price;
-    Quantity quantity;
-    uint8_t aggressor_side; // 0 = Buy, 1 = Sell
-};
-
-// Market data message structure (compact binary format)
-struct MarketDataMessage {
-    // Common header
-    uint64_t timestamp;      // Nanoseconds since epoch
-    MessageType type;        // Message type
-    uint8_t symbol_length;   // Length of symbol
-    
-    // Payload (varies by message type)
-    union {
-        AddOrderData add_order;
-        ModifyOrderData modify_order;
-        CancelOrderData cancel_order;
-        ExecuteOrderData execute_order;
-        TradeData trade;
-        // Heartbeat has no additional fields
-    };
-    
-    // Symbol follows the fixed portion (variable length)
-    // char symbol[symbol_length];
-};
-#pragma pack(pop)
+class StrategyEngine;
 
 // Callback type for market data events
-using MarketDataCallback = std::function<void(const MarketDataMessage&, std::string_view)>;
+using MarketDataCallback = std::function<void(const FeedEvent&)>;
 
 // Market data handler class
 class MarketDataHandler {
@@ -91,33 +33,218 @@ public:
     // Destructor
     ~MarketDataHandler();
     
-    // Process a raw buffer of market data
+    // Process a raw buffer of market data in the native wire format
+    // Returns the number of messages processed
     size_t process_buffer(const uint8_t* data, size_t length);
     
+    // Process a raw buffer in the native wire format and drive a compile-time
+    // strategy engine (see the process() overload taking an engine)
+    template<typename Engine>
+    size_t process_buffer(const uint8_t* data, size_t length, Engine& engine) {
+        return process<NativeProtocol>(data, length, engine);
+    }
+    
+    // Process a raw buffer of market data in a specific wire format
+    // Messages are decoded in batches straight from the buffer and then
+    // applied to the books in one pass. A trailing partial message is kept
+    // in the ring buffer and completed by the next call.
+    // Returns the number of messages processed
+    template<WireProtocol Protocol>
+    size_t process(const uint8_t* data, size_t length);
+    
+    // Process a raw buffer and drive a compile-time strategy engine (such as
+    // StaticStrategyEngine) from the books it changes
+    // Delivery is the same as for set_strategy_engine(): per-event strategies
+    // after every event, conflated ones once per changed book at the end of
+    // the buffer, but every call binds statically and can be inlined.
+    // Returns the number of messages processed
+    template<WireProtocol Protocol, typename Engine>
+    size_t process(const uint8_t* data, size_t length, Engine& engine);
+    
+    // Decode messages starting at offset into a batch until the batch is full
+    // or no complete message is left; offset is advanced past decoded bytes
+    // On a sequenced feed every message consumes the next sequence number.
+    template<WireProtocol Protocol>
+    void decode_batch(const uint8_t* data, size_t length, size_t& offset, FeedEventBatch& batch);
+    
+    // Set the feed sequence number of the next message decoded (0 = the feed
+    // is not sequenced), e.g. from the packet header before each packet
+    // Decoded events carry the number of their message, so a snapshot can be
+    // spliced into the incremental stream: updates at or below its sequence
+    // are dropped, later ones replayed onto the rebuilt book. Sequence numbers
+    // must only increase over the handler's lifetime.
+    void set_sequence(uint64_t next_sequence);
+    
+    // Apply a batch of decoded events to the order books and callbacks
+    void apply_batch(const FeedEventBatch& batch);
+    
+    // Apply one decoded event to its order book and callbacks
+    // Once all symbols are subscribed, threads may apply events concurrently
+    // as long as each symbol is only ever handled by one of them (and no
+    // strategy engine is set)
+    void apply_event(const FeedEvent& event);
+    
+    // Drive a strategy engine from the books (nullptr to stop)
+    // Strategies with per-event delivery run after every event applied to a
+    // book. Conflated strategies run once per book changed since the last
+    // dispatch: the handler marks changed books in a bitmap and
+    // dispatch_updates() runs them at the end of every process() call, so a
+    // burst of updates to one book costs one strategy pass instead of one per
+    // message. The engine must outlive the handler or be reset.
+    void set_strategy_engine(StrategyEngine* engine);
+    
+    // Run the conflated strategies once per book changed since the last call
+    // (called by process(); call it after applying events directly, e.g. at
+    // the end of a queue drain)
+    void dispatch_updates();
+    
     // Subscribe to market data for a specific symbol
-    void subscribe(std::string_view symbol, MarketDataCallback callback);
+    // An empty callback subscribes the book only
+    // Returns the interned ID of the symbol
+    SymbolId subscribe(std::string_view symbol, MarketDataCallback callback);
     
     // Unsubscribe from market data for a specific symbol
     void unsubscribe(std::string_view symbol);
     
-    // Update order books based on market data
-    void update_order_books(const MarketDataMessage& msg, std::string_view symbol);
+    // Create the books of a symbol universe up front (book-only subscriptions)
+    // Each book and its snapshot spare is sized for orders_per_book resting
+    // orders, so neither the first orders after the open nor the first
+    // snapshot allocate on the hot path
+    void preload(std::span<const std::string> symbols, size_t orders_per_book);
+    
+    // Recreate a symbol's books on the calling thread, sized for orders
+    // Under the default first-touch policy their memory lands on the NUMA
+    // node of the caller, so a pinned stage calls this for the books it owns.
+    // The published views are kept; the contents are not (before feeding only).
+    void place_books(SymbolId symbol_id, size_t orders);
+    
+    // Run synthetic order flow through a symbol's book, then clear it
+    // Rounds of adds, modifies, executes and cancels on levels around price
+    // prime the caches, branch predictors and pools of the book path and
+    // center the ladder on price. Callbacks and strategies are not called
+    // and the book is left empty (before feeding only).
+    void warm_up(SymbolId symbol_id, Price price, size_t rounds);
+    
+    // Update order books based on a decoded market data event
+    void update_order_books(const FeedEvent& event);
     
     // Get order book for a specific symbol
+    // A snapshot rebuilds the book off to the side and swaps it in, so a
+    // reader holding the returned pointer keeps a consistent (older) view
     std::shared_ptr<OrderBook> get_order_book(std::string_view symbol);
     
-private:
-    // Parse a single market data message
-    std::pair<const MarketDataMessage*, std::string_view> parse_message(const uint8_t* data, size_t& offset, size_t max_length);
+    // Get order book for a specific symbol ID
+    std::shared_ptr<OrderBook> get_order_book(SymbolId symbol_id);
+    
+    // Get a symbol's book without taking a reference (nullptr if unknown)
+    // Only for the thread applying the symbol's events: it is the one that
+    // swaps the book on a snapshot, so it needs no atomic load of the slot.
+    // The pointer is valid until that thread applies the symbol's next event.
+    OrderBook* book(SymbolId symbol_id) const {
+        return symbol_id < order_books_.size() ? order_books_[symbol_id].get() : nullptr;
+    }
+    
+    // Get the published views of a symbol's book (nullptr if unknown)
+    // The views stay the same across snapshot rebuilds and can be read from
+    // any thread without taking a reference to the book
+    const BookPublication* book_publication(SymbolId symbol_id) const {
+        return symbol_id < publications_.size() ? publications_[symbol_id] : nullptr;
+    }
+    
+    // Set the levels per side every book publishes in its depth view
+    // (0 = top only); call before feeding
+    void set_published_depth(size_t levels);
+    
+    // Get the levels per side published in the depth views
+    size_t published_depth() const { return published_depth_; }
+    
+    // Mark every order book stale (e.g. after a feed sequence gap)
+    // On a sequenced feed only a snapshot at or past the message before the
+    // next one decoded can recover the books.
+    void mark_stale();
+    
+    // Get the ID of a subscribed symbol (INVALID_SYMBOL_ID if unknown)
+    SymbolId symbol_id(std::string_view symbol) const { return symbols_.find(symbol); }
     
-    // Ring buffer for zero-copy message processing
+    // Get the symbol registry
+    const SymbolRegistry& symbols() const { return symbols_; }
+    
+private:
+    // Ring buffer holding a trailing partial message between calls
     std::unique_ptr<RingBuffer> buffer_;
     
-    // Map of symbol to callbacks
-    std::unordered_map<std::string, std::vector<MarketDataCallback>> callbacks_;
+    // Contiguous scratch space for completing a partial message
+    std::vector<uint8_t> stitch_;
+    
+    // Batch of decoded events (reused across calls)
+    FeedEventBatch batch_;
+    
+    // Interned symbols (IDs index the tables below)
+    SymbolRegistry symbols_;
+    
+    // Callbacks indexed by symbol ID
+    std::vector<std::vector<MarketDataCallback>> callbacks_;
+    
+    // Order books indexed by symbol ID
+    std::vector<std::shared_ptr<OrderBook>> order_books_;
+    
+    // Spare books for double-buffered snapshot rebuilds, indexed by symbol ID
+    std::vector<std::shared_ptr<OrderBook>> spare_books_;
+    
+    // Orders of snapshots still being received, indexed by symbol ID
+    std::vector<std::vector<Order>> pending_snapshots_;
+    
+    // Set while a snapshot is being received, indexed by symbol ID
+    std::vector<uint8_t> snapshot_open_;
+    
+    // Sequenced updates received while a book is stale or its snapshot is
+    // being received (replayed after the snapshot), indexed by symbol ID
+    std::vector<std::vector<FeedEvent>> recovery_events_;
+    
+    // Lowest snapshot sequence + 1 that covers every update not kept in the
+    // recovery events, indexed by symbol ID (RECOVERY_PENDING until the next
+    // message after a gap is known)
+    std::vector<uint64_t> recovery_floors_;
+    
+    // Feed sequence number of the next message decoded (0 = not sequenced)
+    uint64_t next_sequence_ = 0;
+    
+    // Set by mark_stale() until the next sequence number is known
+    bool resume_pending_ = false;
+    
+    // Published views of the books, indexed by symbol ID
+    std::vector<const BookPublication*> publications_;
+    
+    // Levels per side published in the depth views
+    size_t published_depth_ = 0;
+    
+    // Strategies driven by this handler
+    StrategyEngine* strategy_engine_ = nullptr;
+    
+    // Books changed since the last dispatch, by symbol ID
+    Bitmap dirty_books_;
     
-    // Map of symbol to order book
-    std::unordered_map<std::string, std::shared_ptr<OrderBook>> order_books_;
+    // Most updates kept per book while it recovers
+    static constexpr size_t MAX_RECOVERY_EVENTS = 64 * 1024;
+    
+    // Recovery floor of a stale book until the message after the gap is known
+    static constexpr uint64_t RECOVERY_PENDING = UINT64_MAX;
+    
+    // Collect a snapshot chunk and swap in the rebuilt book after the last one
+    // The sequence the snapshot is consistent with decides what happens to
+    // the updates kept meanwhile; a snapshot older than updates the book has
+    // no copy of is discarded.
+    void apply_snapshot(const FeedEvent& event);
+    
+    // Keep a sequenced update for replay after a book's snapshot
+    void keep_recovery_event(const FeedEvent& event);
+    
+    // Apply an add, modify, cancel or execute to a book
+    static void apply_to_book(OrderBook& order_book, const FeedEvent& event);
+    
+    // Decode a buffer batch by batch, handing each batch to apply
+    template<WireProtocol Protocol, typename Apply>
+    size_t process_batches(const uint8_t* data, size_t length, Apply&& apply);
 };
 
 // Ring buffer implementation for zero-copy data processing
@@ -164,4 +291,128 @@ private:
     size_t advance(size_t pos, size_t length) const;
 };
 
+//
+// MarketDataHandler template implementation
+//
+
+template<WireProtocol Protocol>
+void MarketDataHandler::decode_batch(const uint8_t* data, size_t length, size_t& offset, FeedEventBatch& batch) {
+    while (!batch.full() && offset < length) {
+        size_t size = Protocol::message_size(data + offset, length - offset);
+        if (size == 0) {
+            break;  // Incomplete message
+        }
+        
+        FeedEvent& event = batch.events[batch.count];
+        uint64_t sequence = next_sequence_ != 0 ? next_sequence_++ : 0;
+        if (Protocol::decode(data + offset, event)) {
+            // Snapshots carry the sequence they are consistent with instead
+            if (event.type != MessageType::SNAPSHOT) {
+                event.sequence = sequence;
+            }
+            
+            // Resolve the symbol unless the protocol carries IDs
+            if (event.symbol_id == INVALID_SYMBOL_ID) {
+                event.symbol_id = symbols_.find(event.symbol);
+            }
+            if (event.symbol_id != INVALID_SYMBOL_ID) {
+                batch.count++;
+            }
+        }
+        
+        offset += size;
+    }
+}
+
+template<WireProtocol Protocol>
+size_t MarketDataHandler::process(const uint8_t* data, size_t length) {
+    size_t processed = process_batches<Protocol>(data, length, [this](const FeedEventBatch& batch) {
+        apply_batch(batch);
+    });
+    
+    // One conflated strategy pass per book this buffer changed
+    dispatch_updates();
+    return processed;
+}
+
+template<WireProtocol Protocol, typename Engine>
+size_t MarketDataHandler::process(const uint8_t* data, size_t length, Engine& engine) {
+    size_t processed = process_batches<Protocol>(data, length, [this, &engine](const FeedEventBatch& batch) {
+        for (const FeedEvent& event : batch) {
+            apply_event(event);
+            
+            OrderBook* book = event.symbol_id < order_books_.size() ? order_books_[event.symbol_id].get() : nullptr;
+            if (book) {
+                if constexpr (Engine::has_per_event()) {
+                    engine.process_event(*book);
+                }
+                dirty_books_.set(event.symbol_id);
+            }
+        }
+    });
+    
+    // One conflated pass per changed book (the bits stay set for a dynamic
+    // engine, which clears them in its own pass)
+    for (size_t i = dirty_books_.find_first(); i != Bitmap::npos; i = dirty_books_.find_next(i + 1)) {
+        if (!strategy_engine_) {
+            dirty_books_.clear(i);
+        }
+        engine.process_conflated(*order_books_[i]);
+    }
+    dispatch_updates();
+    return processed;
+}
+
+template<WireProtocol Protocol, typename Apply>
+size_t MarketDataHandler::process_batches(const uint8_t* data, size_t length, Apply&& apply) {
+    size_t offset = 0;
+    size_t processed = 0;
+    
+    // Complete a partial message left over from the previous buffer
+    size_t pending = buffer_->read_available();
+    if (pending > 0) {
+        if (stitch_.size() < Protocol::max_message_size) {
+            stitch_.resize(Protocol::max_message_size);
+        }
+        
+        buffer_->read(stitch_.data(), pending);
+        size_t copied = std::min(length, Protocol::max_message_size - pending);
+        std::memcpy(stitch_.data() + pending, data, copied);
+        
+        size_t size = Protocol::message_size(stitch_.data(), pending + copied);
+        if (size == 0) {
+            // Still incomplete, keep everything for the next call
+            buffer_->write(stitch_.data(), pending + copied);
+            return 0;
+        }
+        
+        batch_.count = 0;
+        size_t stitched = 0;
+        decode_batch<Protocol>(stitch_.data(), size, stitched, batch_);
+        apply(batch_);
+        processed += batch_.count;
+        offset = size - pending;
+    }
+    
+    // Decode and apply the rest of the buffer batch by batch
+    while (offset < length) {
+        size_t start = offset;
+        batch_.count = 0;
+        decode_batch<Protocol>(data, length, offset, batch_);
+        apply(batch_);
+        processed += batch_.count;
+        
+        if (offset == start) {
+            break;  // Incomplete trailing message
+        }
+    }
+    
+    // Keep the trailing partial message for the next call
+    if (offset < length) {
+        buffer_->write(data + offset, length - offset);
+    }
+    
+    return processed;
+}
+
 } // namespace trading
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace trading {
+
+// Distribution of the simulated order entry latency
+struct LatencyModel {
+    enum class Distribution : uint8_t {
+        FIXED = 0,        // Always base_ns
+        UNIFORM = 1,      // base_ns plus a uniform draw in [0, jitter_ns]
+        EXPONENTIAL = 2   // base_ns plus an exponential draw with mean jitter_ns
+    };
+    
+    Distribution distribution = Distribution::FIXED;
+    Timestamp base_ns = 100000;
+    Timestamp jitter_ns = 0;
+};
+
+// Matching simulator configuration
+struct SimulatorConfig {
+    // Seed of the latency generator (runs with the same seed and inputs match)
+    uint64_t seed = 1;
+    
+    // Latency between sending an order and its arrival at the exchange
+    LatencyModel latency;
+    
+    // Opposite-side levels an arriving order may walk (at most BOOK_DEPTH_LEVELS)
+    size_t max_depth = 10;
+};
+
+// Exchange-side state of a simulated order
+struct SimulatedOrder {
+    Timestamp arrival_ns = 0;    // Simulated time the order reaches the book
+    Quantity queue_ahead = 0;    // Resting quantity ahead of the order at its price
+    Quantity touch_taken = 0;    // Opposite quantity at the limit price already matched
+    Quantity through_taken = 0;  // Opposite quantity through the limit price already matched
+    bool resting = false;        // Rests in the queue at its limit price
+};
+
+// Fill produced by the simulator
+struct SimulatedFill {
+    Price price;
+    Quantity quantity;
+};
+
+// Deterministic event-time matching simulator
+// An order arrives at the book after a latency drawn from the configured
+// model, in simulated time. On arrival it walks the opposite levels that
+// cross its limit price; the rest joins the back of the queue at its price
+// behind the quantity showing there. While resting, the quantity ahead only
+// shrinks as the level's displayed quantity drops below it; the order fills
+// at its price against opposite quantity that shows through its price after
+// it arrived (which clears the queue ahead), or at its price once the queue
+// ahead is gone. Simulated orders never change the book, so the opposite
+// quantity already matched through and at the limit price is remembered
+// rather than matched again on the next call. Matching reads a published BookDepth, so the
+// simulator runs on its own thread without touching the live book; an order
+// joining a level behind the published depth waits until that level shows.
+class MatchingSimulator {
+public:
+    // Constructor
+    explicit MatchingSimulator(SimulatorConfig config = SimulatorConfig());
+    
+    // Send an order at a simulated time: draws its latency
+    void send(SimulatedOrder& state, Timestamp sent_ns);
+    
+    // Match an order's remaining quantity against a depth view of the book at
+    // a simulated time
+    // Returns the fills (valid until the next call); empty if the order has
+    // not arrived yet or nothing matched
+    std::span<const SimulatedFill> match(const BookDepth& book, Side side, Price limit, Quantity quantity,
+                                         SimulatedOrder& state, Timestamp now);
+    
+    // Draw an order entry latency
+    Timestamp draw_latency();
+    
+    // Restart the latency generator
+    void reseed(uint64_t seed) { rng_.seed(seed); }
+    
+    // Get the configuration
+    const SimulatorConfig& config() const { return config_; }
+    
+private:
+    // Configuration
+    SimulatorConfig config_;
+    
+    // Latency generator
+    std::mt19937_64 rng_;
+    
+    // Fills of the last match
+    std::vector<SimulatedFill> fills_;
+};
+
+} // namespace trading
\ No newline at end of file
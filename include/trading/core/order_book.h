@@ -1,42 +1,215 @@
 #pragma once
 
+#include "trading/utils/bitmap.h"
+#include "trading/utils/flat_index.h"
+#include "trading/utils/memory_pool.h"
+#include "trading/utils/seqlock.h"
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <iterator>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
 namespace trading {
 
 // Forward declarations
 struct Order;
+struct OrderNode;
 struct OrderBookLevel;
 
 // Price representation as fixed-point for performance (integer math vs floating point)
+// Prices are raw units of the instrument class's decimal scale (cents for
+// the native feed); FixedPoint and InstrumentClass give them a type
 using Price = std::int64_t;
 using OrderId = std::uint64_t;
 using Quantity = std::uint32_t;
 using Timestamp = std::uint64_t;
 
+// Dense interned symbol identifier (see SymbolRegistry)
+using SymbolId = std::uint32_t;
+constexpr SymbolId INVALID_SYMBOL_ID = std::numeric_limits<SymbolId>::max();
+
 // Order side (Buy/Sell)
 enum class Side : uint8_t {
     BUY = 0,
     SELL = 1
 };
 
+// Resting order in the book (intrusive node of its price level's FIFO queue)
+struct OrderNode {
+    OrderId id;
+    Price price;
+    Quantity quantity;
+    Quantity original_quantity;
+    Side side;
+    Timestamp timestamp;
+    
+    // Neighbours in time priority (prev is ahead in the queue)
+    OrderNode* prev;
+    OrderNode* next;
+};
+
 // Level in the order book (price level with total quantity)
 struct OrderBookLevel {
     Price price;
     Quantity quantity;
     
+    // Number of orders queued at this level
+    uint32_t order_count;
+    
+    // FIFO of orders at this level (head has time priority)
+    OrderNode* head;
+    OrderNode* tail;
+    
     // Constructor
-    OrderBookLevel(Price p, Quantity q) : price(p), quantity(q) {}
+    OrderBookLevel(Price p, Quantity q) : price(p), quantity(q), order_count(0), head(nullptr), tail(nullptr) {}
     
     // Default constructor for empty levels
-    OrderBookLevel() : price(0), quantity(0) {}
+    OrderBookLevel() : price(0), quantity(0), order_count(0), head(nullptr), tail(nullptr) {}
+};
+
+// Position of an order in its price level's queue
+struct QueuePosition {
+    size_t orders_ahead;
+    Quantity quantity_ahead;
+};
+
+// Price level of a published book view
+struct BookLevel {
+    Price price = 0;
+    Quantity quantity = 0;
+    uint32_t order_count = 0;
+    
+    bool operator==(const BookLevel&) const = default;
+};
+
+// Best level of each side of a book (fits one cache line with its seqlock)
+struct BookTop {
+    uint64_t updates = 0;    // Changes published so far
+    BookLevel bid;           // Quantity 0 if there are no bids
+    BookLevel ask;           // Quantity 0 if there are no asks
+    
+    // Get the best prices
+    std::optional<Price> best_bid() const { return bid.quantity > 0 ? std::optional<Price>(bid.price) : std::nullopt; }
+    std::optional<Price> best_ask() const { return ask.quantity > 0 ? std::optional<Price>(ask.price) : std::nullopt; }
+    
+    // Get the spread and the mid price (both sides needed)
+    std::optional<Price> spread() const {
+        return bid.quantity > 0 && ask.quantity > 0 ? std::optional<Price>(ask.price - bid.price) : std::nullopt;
+    }
+    std::optional<Price> mid_price() const {
+        return bid.quantity > 0 && ask.quantity > 0 ? std::optional<Price>((bid.price + ask.price) / 2) : std::nullopt;
+    }
+    std::optional<Price> mid_price_x2() const {
+        return bid.quantity > 0 && ask.quantity > 0 ? std::optional<Price>(bid.price + ask.price) : std::nullopt;
+    }
+};
+
+// Most levels per side of a published depth view
+constexpr size_t BOOK_DEPTH_LEVELS = 10;
+
+// Best levels of each side of a book, best first
+struct BookDepth {
+    uint64_t updates = 0;          // Changes published so far
+    uint32_t bid_count = 0;        // Valid entries in bids
+    uint32_t ask_count = 0;        // Valid entries in asks
+    bool bids_truncated = false;   // More bids rest behind the last entry
+    bool asks_truncated = false;   // More asks rest behind the last entry
+    std::array<BookLevel, BOOK_DEPTH_LEVELS> bids{};
+    std::array<BookLevel, BOOK_DEPTH_LEVELS> asks{};
+    
+    // Get the published levels of a side
+    std::span<const BookLevel> levels(Side side) const {
+        return side == Side::BUY ? std::span<const BookLevel>(bids.data(), bid_count)
+                                 : std::span<const BookLevel>(asks.data(), ask_count);
+    }
+    
+    // Get the displayed quantity at a price: 0 if the price is empty,
+    // nullopt if it lies behind the published levels
+    std::optional<Quantity> quantity_at(Side side, Price price) const;
+};
+
+// Seqlock-published views of a book, readable from any thread
+// The book's writer publishes the top on every change to a best level and
+// the depth (if enabled) on every change within the published levels.
+struct BookPublication {
+    SeqLock<BookTop> top;
+    SeqLock<BookDepth> depth;
+};
+
+// Non-empty price levels of one side of a book, best first
+// A view into the ladder: iterating walks the side's bitmap, so every step
+// is a couple of word scans however sparse the ladder is, and nothing is
+// copied or sorted. Invalidated by any change to the book.
+class LevelRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OrderBookLevel;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const OrderBookLevel*;
+        using reference = const OrderBookLevel&;
+        
+        iterator() = default;
+        
+        reference operator*() const { return levels_[index_]; }
+        pointer operator->() const { return &levels_[index_]; }
+        
+        iterator& operator++() {
+            if (descending_) {
+                index_ = index_ == 0 ? Bitmap::npos : bitmap_->find_prev(index_ - 1);
+            } else {
+                index_ = bitmap_->find_next(index_ + 1);
+            }
+            return *this;
+        }
+        
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+    
+    private:
+        friend class LevelRange;
+        
+        iterator(const OrderBookLevel* levels, const Bitmap* bitmap, bool descending, size_t index)
+            : levels_(levels), bitmap_(bitmap), descending_(descending), index_(index) {}
+        
+        const OrderBookLevel* levels_ = nullptr;
+        const Bitmap* bitmap_ = nullptr;
+        bool descending_ = false;
+        size_t index_ = Bitmap::npos;
+    };
+    
+    // Constructor (bids are walked from the top of the ladder down)
+    LevelRange(const OrderBookLevel* levels, const Bitmap& bitmap, bool descending, size_t count)
+        : levels_(levels), bitmap_(&bitmap), descending_(descending), count_(count) {}
+    
+    iterator begin() const {
+        return iterator(levels_, bitmap_, descending_, descending_ ? bitmap_->find_last() : bitmap_->find_first());
+    }
+    iterator end() const { return iterator(); }
+    
+    // Get the number of levels
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    
+private:
+    const OrderBookLevel* levels_;
+    const Bitmap* bitmap_;
+    bool descending_;
+    size_t count_;
 };
 
 // Representation of an order
@@ -47,26 +220,39 @@ struct Order {
     Quantity original_quantity;
     Side side;
     Timestamp timestamp;
-    std::string symbol;
+    SymbolId symbol_id;
     
     // Create a new order
-    Order(OrderId order_id, Price p, Quantity q, Side s, Timestamp ts, std::string_view sym)
-        : id(order_id), price(p), quantity(q), original_quantity(q), side(s), timestamp(ts), symbol(std::string(sym)) {}
+    Order(OrderId order_id, Price p, Quantity q, Side s, Timestamp ts, SymbolId sym = INVALID_SYMBOL_ID)
+        : id(order_id), price(p), quantity(q), original_quantity(q), side(s), timestamp(ts), symbol_id(sym) {}
     
     // Default constructor
-    Order() : id(0), price(0), quantity(0), original_quantity(0), side(Side::BUY), timestamp(0) {}
+    Order() : id(0), price(0), quantity(0), original_quantity(0), side(Side::BUY), timestamp(0), symbol_id(INVALID_SYMBOL_ID) {}
 };
 
 // The main OrderBook class - this maintains the state of the market
 class OrderBook {
 public:
+    // Widest ladder a book grows to, in ticks per side
+    // A price the ladder cannot cover within this width (e.g. a stray or
+    // corrupt price far from the book) is rejected instead of growing it
+    static constexpr size_t MAX_PRICE_LEVELS = 64 * 1024;
+    
     // Constructor
-    explicit OrderBook(std::string_view symbol, uint32_t price_levels = 256);
+    // price_levels is the initial ladder width in ticks; the ladder re-centers
+    // (and grows up to MAX_PRICE_LEVELS if needed) when prices drift outside of it
+    explicit OrderBook(std::string_view symbol, uint32_t price_levels = 256, Price tick_size = 1,
+                       SymbolId symbol_id = INVALID_SYMBOL_ID);
     
     // Add a new order to the book
-    void add_order(const Order& order);
+    // Returns false for orders without quantity, duplicate order IDs, prices
+    // that are not on the tick grid and prices the ladder cannot cover
+    // (counted in out_of_range_orders())
+    bool add_order(const Order& order);
     
-    // Modify an existing order
+    // Modify an existing order (a quantity of zero removes the order)
+    // Reducing the quantity keeps time priority, increasing it moves the
+    // order to the back of its level's queue
     bool modify_order(OrderId order_id, Quantity new_quantity);
     
     // Cancel an existing order
@@ -81,43 +267,215 @@ public:
     // Get best ask price
     std::optional<Price> best_ask() const;
     
-    // Get order book depth (number of bids and asks)
-    std::pair<size_t, size_t> depth() const;
+    // Get order book depth (number of non-empty bid and ask levels)
+    std::pair<size_t, size_t> depth() const { return {bid_level_count_, ask_level_count_}; }
+    
+    // Get the number of non-empty levels of a side
+    size_t level_count(Side side) const { return side == Side::BUY ? bid_level_count_ : ask_level_count_; }
     
     // Get the spread (difference between best ask and best bid)
     std::optional<Price> spread() const;
     
-    // Get the mid price ((best bid + best ask) / 2)
+    // Get the mid price ((best bid + best ask) / 2, truncated to a whole unit)
     std::optional<Price> mid_price() const;
     
+    // Get twice the mid price (best bid + best ask), exact where the mid
+    // falls on a half unit; FixedPoint::midpoint() gives it a scale
+    std::optional<Price> mid_price_x2() const;
+    
+    // Get the non-empty levels of a side, best first (no allocation)
+    LevelRange levels(Side side) const {
+        return side == Side::BUY ? LevelRange(bid_levels_.data(), bid_bitmap_, true, bid_level_count_)
+                                 : LevelRange(ask_levels_.data(), ask_bitmap_, false, ask_level_count_);
+    }
+    
+    // Copy up to out.size() best levels of a side into out
+    // Returns the number of levels copied
+    size_t copy_levels(Side side, std::span<OrderBookLevel> out) const;
+    
     // Get the current state of the order book for a specific side
+    // (allocates; prefer levels() or copy_levels() on hot paths)
     std::vector<OrderBookLevel> get_levels(Side side, size_t depth = 10) const;
     
+    // Find a resting order (nullptr if not in the book)
+    const OrderNode* find_order(OrderId order_id) const;
+    
+    // Get the queue position of a resting order within its price level
+    std::optional<QueuePosition> queue_position(OrderId order_id) const;
+    
+    // Get the first order in time priority at a price (nullptr if the level is empty)
+    // Follow OrderNode::next to walk the rest of the queue
+    const OrderNode* level_front(Side side, Price price) const;
+    
+    // Get the number of resting orders
+    size_t order_count() const { return order_index_.size(); }
+    
+    // Pre-size the order index and node pool for a number of resting orders
+    void reserve(size_t orders);
+    
+    // Remove all resting orders
+    void clear();
+    
+    // Replace the contents of the book with a snapshot of resting orders
+    // Orders are given in time priority per level. The ladder is sized once
+    // for the whole snapshot, levels are filled in a single pass and the best
+    // prices are computed at the end. Orders with a reserved or duplicate ID,
+    // an off-grid price or no quantity are skipped. If the prices span more
+    // than the ladder can cover, orders outside the widest ladder centered on
+    // the touch are skipped and counted in out_of_range_orders(). Clears the
+    // stale flag.
+    // Returns the number of orders loaded
+    size_t load_snapshot(std::span<const Order> orders);
+    
     // Get symbol for this order book
     std::string_view symbol() const { return symbol_; }
     
+    // Get interned symbol ID for this order book
+    SymbolId symbol_id() const { return symbol_id_; }
+    
+    // Get the tick size of the price ladder
+    Price tick_size() const { return tick_size_; }
+    
+    // Get the number of orders rejected for a price the ladder cannot cover
+    uint64_t out_of_range_orders() const { return out_of_range_orders_; }
+    
+    // Check if the book may have missed updates (feed gap) and awaits a snapshot
+    bool is_stale() const { return stale_.load(std::memory_order_acquire); }
+    
+    // Mark the book as stale or recovered
+    void set_stale(bool stale) { stale_.store(stale, std::memory_order_release); }
+    
+    // Get the feed sequence number of the last message applied to the book,
+    // or the one its snapshot is consistent with (0 if the feed is not sequenced)
+    uint64_t sequence() const { return sequence_; }
+    
+    // Set the feed sequence number the book's contents are consistent with
+    void set_sequence(uint64_t sequence) { sequence_ = sequence; }
+    
+    // Get the published views of the book (any thread)
+    const BookPublication& publication() const { return *publication_; }
+    
+    // Read the published top of the book (any thread)
+    BookTop top() const { return publication_->top.load(); }
+    
+    // Read the published depth of the book (any thread)
+    BookDepth published_depth() const { return publication_->depth.load(); }
+    
+    // Set the levels per side published in the depth view (0 = top only,
+    // at most BOOK_DEPTH_LEVELS); writer thread only
+    void set_published_depth(size_t levels);
+    
+    // Get the levels per side published in the depth view
+    size_t published_levels() const { return published_levels_; }
+    
+    // Publish into the views of another book of the same symbol (e.g. the
+    // double-buffered rebuild of a book), so readers keep one view per symbol
+    void share_publication(const OrderBook& other);
+
 private:
-    // Price levels for bids (indexed by price)
+    // Price levels for bids (indexed by tick offset from base_price_)
     std::vector<OrderBookLevel> bid_levels_;
     
-    // Price levels for asks (indexed by price)
+    // Price levels for asks (indexed by tick offset from base_price_)
     std::vector<OrderBookLevel> ask_levels_;
     
-    // Map of order ID to Order
-    std::unordered_map<OrderId, Order> orders_;
+    // Non-empty bid levels
+    Bitmap bid_bitmap_;
+    
+    // Non-empty ask levels
+    Bitmap ask_bitmap_;
+    
+    // Number of non-empty levels per side
+    size_t bid_level_count_;
+    size_t ask_level_count_;
+    
+    // Minimum price increment
+    Price tick_size_;
+    
+    // Price of ladder index 0 (the ladder is anchored on the first order)
+    Price base_price_;
+    
+    // Orders rejected for a price the ladder cannot cover
+    uint64_t out_of_range_orders_ = 0;
+    
+    // Pool for resting order nodes
+    MemoryPool<OrderNode, 64 * 1024> node_pool_;
+    
+    // Index of order ID to resting order node
+    FlatIndex<OrderNode*> order_index_;
     
     // Symbol for this order book
     std::string symbol_;
     
+    // Interned symbol ID for this order book
+    SymbolId symbol_id_;
+    
     // Track best bid/ask for O(1) access
     std::optional<Price> best_bid_;
     std::optional<Price> best_ask_;
     
+    // Set when a feed gap may have dropped updates for this book
+    std::atomic<bool> stale_;
+    
+    // Feed sequence number the contents are consistent with (0 = not sequenced)
+    uint64_t sequence_ = 0;
+    
+    // Published views (shared with the other book of a double buffer)
+    std::shared_ptr<BookPublication> publication_;
+    
+    // Levels per side published in the depth view
+    size_t published_levels_;
+    
+    // Last published values (writer side)
+    BookTop top_;
+    BookDepth depth_;
+    
+    // Publish the views after a change at a price level
+    void publish(Side side, Price price);
+    
+    // Publish the views of the whole book
+    void publish_all();
+    
+    // Fill one side of the depth view from the ladder
+    void fill_depth(Side side);
+    
+    // Get the published form of a level
+    BookLevel book_level(Side side, std::optional<Price> price) const;
+    
     // Convert price to index in the price array
-    size_t price_to_index(Price price, Side side) const;
+    size_t price_to_index(Price price) const;
+    
+    // Check if a price falls inside the current ladder
+    bool in_ladder(Price price) const;
+    
+    // Get the ladder size covering a price range with a quarter of it free,
+    // grown from the current size (0 if it would exceed MAX_PRICE_LEVELS)
+    size_t ladder_size(Price low, Price high) const;
+    
+    // Re-center (and grow if needed) the ladder so that a price fits
+    // Returns false (leaving the ladder alone) if the ladder cannot cover it
+    bool recenter(Price price);
+    
+    // Get the level an order rests at
+    OrderBookLevel& level_of(const OrderNode& node);
+    
+    // Add quantity to a price level
+    void add_to_level(Side side, Price price, Quantity quantity);
+    
+    // Remove quantity from a price level
+    void remove_from_level(Side side, Price price, Quantity quantity);
+    
+    // Append an order to the back of its level's queue
+    void link_back(OrderNode* node);
+    
+    // Remove an order from its level's queue
+    void unlink(OrderNode* node);
+    
+    // Remove an order from the book and return its node to the pool
+    void remove_order(OrderNode* node);
     
-    // Update best bid/ask after a change
-    void update_best_prices();
+    // Return every resting order to the pool and empty the ladder (unpublished)
+    void release_orders();
 };
 
 } // namespace trading
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace trading {
+
+// Order status
+// NEW -> PENDING -> PARTIALLY_FILLED -> FILLED, with CANCELED and REJECTED
+// reachable from any working state
+enum class OrderStatus : uint8_t {
+    NEW = 0,
+    PENDING = 1,
+    PARTIALLY_FILLED = 2,
+    FILLED = 3,
+    CANCELED = 4,
+    REJECTED = 5
+};
+
+// Check if an order in this status can no longer trade
+constexpr bool is_terminal(OrderStatus status) {
+    return status == OrderStatus::FILLED || status == OrderStatus::CANCELED ||
+           status == OrderStatus::REJECTED;
+}
+
+// Check if the order state machine allows a transition
+constexpr bool is_valid_transition(OrderStatus from, OrderStatus to) {
+    if (is_terminal(from)) {
+        return false;
+    }
+    
+    switch (to) {
+        case OrderStatus::PENDING:
+            return from == OrderStatus::NEW;
+        case OrderStatus::PARTIALLY_FILLED:
+        case OrderStatus::FILLED:
+        case OrderStatus::CANCELED:
+        case OrderStatus::REJECTED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Lock-free table of order states indexed by order ID
+// Each slot is one atomic word holding the low 56 bits of the order ID, a
+// retired bit and the status, so a reader always sees a consistent pair and
+// every transition is one CAS that fails if the order moved on or its slot
+// was reused. A slot can be claimed by a new order once its previous order
+// was retired by its owner. All operations are constant time.
+class OrderStatusTable {
+public:
+    // Constructor
+    // capacity is rounded up to a power of two; it bounds the live orders
+    explicit OrderStatusTable(size_t capacity = 64 * 1024) {
+        size_t slots = 2;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        words_ = std::make_unique<std::atomic<uint64_t>[]>(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            words_[i].store(RETIRED_BIT | static_cast<uint64_t>(OrderStatus::REJECTED),
+                            std::memory_order_relaxed);
+        }
+        mask_ = slots - 1;
+    }
+    
+    // Claim the slot of a new order and set it to NEW
+    // Returns false if the slot still belongs to an unretired order
+    bool claim(OrderId order_id) {
+        std::atomic<uint64_t>& word = slot(order_id);
+        uint64_t current = word.load(std::memory_order_acquire);
+        return (current & RETIRED_BIT) &&
+               word.compare_exchange_strong(current, pack(order_id, OrderStatus::NEW),
+                                            std::memory_order_acq_rel);
+    }
+    
+    // Move an order to a new status
+    // Returns false if the order is unknown or the state machine forbids it
+    bool transition(OrderId order_id, OrderStatus status) {
+        std::atomic<uint64_t>& word = slot(order_id);
+        uint64_t current = word.load(std::memory_order_acquire);
+        
+        for (;;) {
+            if ((current >> ID_SHIFT) != (order_id & ID_MASK) ||
+                !is_valid_transition(unpack_status(current), status)) {
+                return false;
+            }
+            if (word.compare_exchange_weak(current, pack(order_id, status), std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+                return true;
+            }
+        }
+    }
+    
+    // Release a finished order's slot for reuse (its status stays readable
+    // until then)
+    void retire(OrderId order_id) {
+        std::atomic<uint64_t>& word = slot(order_id);
+        uint64_t current = word.load(std::memory_order_acquire);
+        if ((current >> ID_SHIFT) == (order_id & ID_MASK) && is_terminal(unpack_status(current))) {
+            word.fetch_or(RETIRED_BIT, std::memory_order_release);
+        }
+    }
+    
+    // Get an order's status (REJECTED if unknown or its slot was reused)
+    OrderStatus status(OrderId order_id) const {
+        uint64_t current = slot(order_id).load(std::memory_order_acquire);
+        if ((current >> ID_SHIFT) != (order_id & ID_MASK)) {
+            return OrderStatus::REJECTED;
+        }
+        return unpack_status(current);
+    }
+    
+    // Number of slots
+    size_t capacity() const { return mask_ + 1; }
+    
+private:
+    // Word layout
+    static constexpr unsigned ID_SHIFT = 8;
+    static constexpr uint64_t ID_MASK = (uint64_t(1) << (64 - ID_SHIFT)) - 1;
+    static constexpr uint64_t RETIRED_BIT = 0x80;
+    static constexpr uint64_t STATUS_MASK = 0x7F;
+    
+    // Status words
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    
+    // Index mask
+    size_t mask_;
+    
+    // Get the slot of an order ID
+    std::atomic<uint64_t>& slot(OrderId order_id) const { return words_[order_id & mask_]; }
+    
+    // Pack an order ID and status
+    static uint64_t pack(OrderId order_id, OrderStatus status) {
+        return ((order_id & ID_MASK) << ID_SHIFT) | static_cast<uint64_t>(status);
+    }
+    
+    // Unpack the status of a word
+    static OrderStatus unpack_status(uint64_t word) {
+        return static_cast<OrderStatus>(word & STATUS_MASK);
+    }
+};
+
+} // namespace trading
\ No newline at end of file
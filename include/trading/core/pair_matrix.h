@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Peer whose log price ratio against the updated symbol crossed the threshold
+struct PairSignal {
+    uint32_t peer;    // Slot of the peer symbol
+    double z_score;   // Z-score of log(p_symbol / p_peer) over the row's window
+};
+
+// Structure-of-arrays matrix of rolling log price ratios across a universe
+// Row i holds, for every peer j, the rolling mean and sum of squared
+// deviations of log(p_i / p_j) sampled on each update of symbol i. The
+// samples of one update share a ring slot, so a whole row is updated with
+// contiguous loads and stores. The row kernel uses AVX-512, AVX2 or NEON when
+// the build targets them and a scalar loop otherwise.
+// A pair is only reported once both legs have a price and the row has taken
+// a full window of samples since then, so an unpriced (e.g. halted) symbol
+// silences its own pairs only.
+class PairMatrix {
+public:
+    // Constructor
+    explicit PairMatrix(size_t symbols = 0, size_t window = 100);
+    
+    // Clear all state and resize the matrix
+    void reset(size_t symbols, size_t window);
+    
+    // Record the latest log mid price of a symbol and update its row
+    // Writes the peers whose |z-score| exceeds the threshold to out (which
+    // must have room for symbols() entries); nothing is reported for a peer
+    // until the pair is ready
+    // Returns the number of signals written
+    size_t update(size_t symbol, double log_price, double threshold, PairSignal* out);
+    
+    // Check if a symbol's row has a full window
+    bool ready(size_t symbol) const { return counts_[symbol] == window_; }
+    
+    // Check if a pair has a full window of samples taken while both legs had a price
+    bool ready(size_t symbol, size_t peer) const {
+        return updates_[symbol] - pair_starts_[symbol * stride_ + peer] >= window_ &&
+               !std::isnan(log_prices_[peer]);
+    }
+    
+    // Rolling mean of log(p_symbol / p_peer)
+    double mean(size_t symbol, size_t peer) const { return means_[symbol * stride_ + peer]; }
+    
+    // Rolling population variance of log(p_symbol / p_peer)
+    double variance(size_t symbol, size_t peer) const;
+    
+    // Number of symbols
+    size_t symbols() const { return symbols_; }
+    
+    // Window size
+    size_t window() const { return window_; }
+    
+    // Name of the row kernel selected at build time
+    static const char* kernel_name();
+    
+private:
+    // Row updates between exact recomputations of the running sums
+    static constexpr uint32_t RECOMPUTE_INTERVAL = 4096;
+    
+    // Number of symbols
+    size_t symbols_;
+    
+    // Row stride in doubles (symbols rounded up to the widest vector)
+    size_t stride_;
+    
+    // Window size
+    size_t window_;
+    
+    // Latest log price per symbol (padded to stride_)
+    std::vector<double> log_prices_;
+    
+    // Rolling means, one row of stride_ per symbol
+    std::vector<double> means_;
+    
+    // Rolling sums of squared deviations, one row of stride_ per symbol
+    std::vector<double> m2s_;
+    
+    // Sample rings, window_ slots of stride_ per symbol
+    std::vector<double> ring_;
+    
+    // Per-row sample count, ring head and replacements since recomputation
+    std::vector<size_t> counts_;
+    std::vector<size_t> heads_;
+    std::vector<uint32_t> replacements_;
+    
+    // Per-row update count, and per pair the row's update count when both
+    // legs first had a price
+    std::vector<size_t> updates_;
+    std::vector<size_t> pair_starts_;
+    
+    // Threshold crossing flags of the last update (one bit per peer)
+    std::vector<uint64_t> flags_;
+    
+    // Recompute a row's means and sums of squared deviations from its ring
+    void recompute(size_t symbol);
+    
+    // Start the pairs of a symbol that just got its first price: its column
+    // in every sampled row is refilled with the current ratio, and the pairs
+    // count their window from here
+    void start_pairs(size_t symbol);
+};
+
+} // namespace trading
\ No newline at end of file
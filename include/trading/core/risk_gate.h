@@ -0,0 +1,157 @@
+#pragma once
+
+#include "trading/core/execution_engine.h"
+#include "trading/core/order_book.h"
+#include "trading/core/strategy_engine.h"
+#include "trading/utils/rcu_cell.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace trading {
+
+// Forward declarations
+class ConfigManager;
+
+// Pre-trade risk limits (a zero limit disables its check)
+struct RiskLimits {
+    // Fat-finger: largest quantity of a single order
+    Quantity max_order_quantity = 10000;
+    
+    // Fat-finger: largest price * quantity of a single order
+    int64_t max_order_notional = 0;
+    
+    // Fat-finger: largest distance of the order price from the symbol's
+    // reference price, in basis points
+    // The band is off for a symbol until its reference price is set with
+    // RiskGate::set_reference_price (TradingRuntime sets the mid of every
+    // book a packet changed; other callers have to supply it).
+    uint32_t max_price_deviation_bps = 500;
+    
+    // Largest absolute position per symbol, counting open orders as filled
+    int64_t max_position = 100000;
+    
+    // Order rate across all symbols
+    uint32_t max_orders_per_second = 1000;
+    
+    // Orders that may be sent back to back before the rate applies
+    uint32_t burst = 100;
+    
+    // Read the limits from risk.* keys (missing keys keep the defaults):
+    //   risk.max_order_quantity, risk.max_order_notional,
+    //   risk.max_price_deviation_bps, risk.max_position,
+    //   risk.max_orders_per_second, risk.burst
+    static RiskLimits from_config(const ConfigManager& config);
+};
+
+// Outcome of a pre-trade check
+enum class RiskResult : uint8_t {
+    ACCEPTED = 0,
+    REJECTED_SYMBOL = 1,     // Symbol ID outside the gate's table
+    REJECTED_QUANTITY = 2,   // Zero or above max_order_quantity
+    REJECTED_NOTIONAL = 3,   // Above max_order_notional
+    REJECTED_PRICE = 4,      // Too far from the reference price
+    REJECTED_POSITION = 5,   // Would breach max_position
+    REJECTED_RATE = 6,       // Above max_orders_per_second
+    REJECTED_EXECUTION = 7   // Passed, but the execution engine refused the order
+};
+
+// Pre-trade risk gate between the strategy and the execution engine
+// Per-symbol positions, open quantities and reference prices live in a
+// table of atomics indexed by symbol ID, so a check is a handful of loads
+// and one CAS for the rate limiter (a GCRA token bucket), with no lock or
+// lookup. All checks are evaluated branch-free and combined, so the accept
+// path takes a single well-predicted branch. Open quantity is reserved
+// before an order is submitted and released by its execution reports, so
+// position limits also hold across orders in flight.
+class RiskGate : public SignalSink {
+public:
+    // Constructor
+    // max_symbols bounds the symbol IDs the gate accepts
+    RiskGate(std::shared_ptr<ExecutionEngine> execution, RiskLimits limits = RiskLimits(),
+             size_t max_symbols = 1024);
+    
+    // Constructor with limits published elsewhere (e.g. a configuration
+    // snapshot); every check reads the current ones with one pointer load,
+    // so limits can be changed while orders are flowing
+    RiskGate(std::shared_ptr<ExecutionEngine> execution, std::shared_ptr<const RcuCell<RiskLimits>> limits,
+             size_t max_symbols = 1024);
+    
+    // Check a signal and submit it as an order if it passes
+    // Returns the order ID, or 0 if the order was rejected
+    OrderId submit(const Signal& signal);
+    
+    // Check and submit all signals of a tick
+    void on_signals(std::span<const Signal> signals) override;
+    
+    // Update positions and open quantities from an execution report
+    // Must see every report of the orders this gate submitted
+    void on_execution_report(const ExecutionReport& report);
+    
+    // Set a symbol's reference price for the price band check (0 disables it)
+    void set_reference_price(SymbolId symbol_id, Price price);
+    
+    // Check a signal without submitting it or consuming rate budget
+    RiskResult check(const Signal& signal) const;
+    
+    // Get a symbol's filled position (positive = long)
+    int64_t position(SymbolId symbol_id) const;
+    
+    // Get a symbol's open buy and sell quantities
+    int64_t open_buy_quantity(SymbolId symbol_id) const;
+    int64_t open_sell_quantity(SymbolId symbol_id) const;
+    
+    // Get the number of signals that ended with a result
+    uint64_t count(RiskResult result) const;
+    
+    // Result of the last rejected signal
+    RiskResult last_rejection() const { return last_rejection_.load(std::memory_order_relaxed); }
+    
+    // Get the current limits
+    const RiskLimits& limits() const { return *limits_->load(); }
+    
+private:
+    // Risk state of one symbol (one cache line, updated by both the
+    // submitting and the reporting thread)
+    struct alignas(64) SymbolRisk {
+        std::atomic<int64_t> position{0};
+        std::atomic<int64_t> open_buy{0};
+        std::atomic<int64_t> open_sell{0};
+        std::atomic<Price> reference_price{0};
+    };
+    
+    // Number of RiskResult values
+    static constexpr size_t RESULT_COUNT = 8;
+    
+    // Execution engine
+    std::shared_ptr<ExecutionEngine> execution_;
+    
+    // Limits
+    std::shared_ptr<const RcuCell<RiskLimits>> limits_;
+    
+    // Per-symbol state indexed by symbol ID
+    std::unique_ptr<SymbolRisk[]> symbols_;
+    size_t max_symbols_;
+    
+    // Rate limiter: theoretical arrival time of the next order (GCRA)
+    alignas(64) std::atomic<int64_t> rate_tat_ns_;
+    
+    // Outcome counters
+    std::atomic<uint64_t> counts_[RESULT_COUNT];
+    
+    // Result of the last rejected signal
+    std::atomic<RiskResult> last_rejection_;
+    
+    // Evaluate the stateless checks
+    RiskResult evaluate(const Signal& signal, const RiskLimits& limits) const;
+    
+    // Consume one order of rate budget (false if over the limit)
+    bool acquire_rate(int64_t now_ns, const RiskLimits& limits);
+    
+    // Count a rejection
+    OrderId reject(RiskResult result);
+};
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include "trading/core/strategy_engine.h"
+#include "trading/utils/perf_counters.h"
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+
+namespace trading {
+
+// Strategy usable by StaticStrategyEngine
+// Any type with these members works, including Strategy subclasses; mark
+// those final so the calls bind statically.
+template<typename S>
+concept StaticStrategy = requires(S& strategy, const OrderBook& order_book, SignalBuffer& signals) {
+    strategy.initialize();
+    strategy.process_update(order_book, signals);
+};
+
+// Receiver of the signals of a StaticStrategyEngine tick
+template<typename S>
+concept StaticSignalSink = requires(S& sink, std::span<const Signal> signals) {
+    sink.on_signals(signals);
+};
+
+// Get how a static strategy wants book updates delivered
+// A strategy asks with a static constexpr DeliveryMode delivery_mode member
+// (conflated if it has none); a Strategy subclass can return the same value
+// from delivery() to behave alike in both engines.
+template<typename S>
+constexpr DeliveryMode static_delivery() {
+    if constexpr (requires { { S::delivery_mode } -> std::convertible_to<DeliveryMode>; }) {
+        return S::delivery_mode;
+    } else {
+        return DeliveryMode::CONFLATED;
+    }
+}
+
+// Sink submitting every signal of a tick to an execution target
+// Target is anything with submit(const Signal&), e.g. RiskGate or a wrapper
+// around ExecutionEngine::submit_order.
+template<typename Target>
+class SubmitSignals {
+public:
+    // Constructor
+    explicit SubmitSignals(Target& target) : target_(target) {}
+    
+    // Submit all signals of a tick
+    void on_signals(std::span<const Signal> signals) {
+        for (const Signal& signal : signals) {
+            target_.submit(signal);
+        }
+    }
+    
+private:
+    Target& target_;
+};
+
+// Strategy engine with the strategy set and signal sink fixed at compile time
+// The strategies are held by value and run in order through a fold over the
+// tuple, and the sink is called through its concrete type, so the whole
+// book -> strategies -> sink pass has no virtual call, no std::function and
+// no shared_ptr and can be inlined end to end (see the release -flto
+// -march=native flags). It exposes the same process_order_book(),
+// process_event() and process_conflated() entry points as StrategyEngine and
+// is driven by MarketDataHandler::process() the same way. The dynamic
+// StrategyEngine stays for strategies chosen at run time.
+template<StaticSignalSink Sink, StaticStrategy... Strategies>
+class StaticStrategyEngine {
+public:
+    // Constructor
+    explicit StaticStrategyEngine(Sink& sink, Strategies... strategies)
+        : sink_(sink), strategies_(std::move(strategies)...) {}
+    
+    // Start the engine (initializes every strategy)
+    void start() {
+        if (running_) {
+            return;  // Already running
+        }
+        running_ = true;
+        std::apply([](auto&... strategy) { (strategy.initialize(), ...); }, strategies_);
+    }
+    
+    // Stop the engine
+    void stop() { running_ = false; }
+    
+    // Get a strategy by position
+    template<size_t I>
+    auto& strategy() { return std::get<I>(strategies_); }
+    
+    // Run every strategy on a book and emit their signals
+    void process_order_book(const OrderBook& order_book) { run<true, true>(order_book); }
+    
+    // Run the per-event strategies on a book that just changed
+    void process_event(const OrderBook& order_book) {
+        if constexpr (has_per_event()) {
+            run<true, false>(order_book);
+        }
+    }
+    
+    // Run the conflated strategies on a book that changed since their last run
+    void process_conflated(const OrderBook& order_book) { run<false, true>(order_book); }
+    
+    // Check if any strategy wants per-event delivery
+    static constexpr bool has_per_event() {
+        return (... || (static_delivery<Strategies>() == DeliveryMode::PER_EVENT));
+    }
+    
+private:
+    // Sink receiving the signals
+    Sink& sink_;
+    
+    // Strategies in run order
+    std::tuple<Strategies...> strategies_;
+    
+    // Signals of the current tick (reused across ticks)
+    SignalBuffer signals_;
+    
+    // Running flag
+    bool running_ = false;
+    
+    // Run the strategies of the selected delivery modes and emit their signals
+    template<bool PerEvent, bool Conflated>
+    void run(const OrderBook& order_book) {
+        if (!running_) {
+            return;  // Not running
+        }
+        
+        if (order_book.is_stale()) {
+            return;  // Don't trade on a book that missed updates
+        }
+        
+        signals_.clear();
+        {
+            TRADING_PERF_SCOPE(STRATEGY_UPDATE);
+            std::apply([&](auto&... strategy) {
+                (run_one<PerEvent, Conflated>(strategy, order_book), ...);
+            }, strategies_);
+        }
+        
+        if (!signals_.empty()) {
+            sink_.on_signals(signals_.signals());
+        }
+    }
+    
+    // Run one strategy if its delivery mode is selected
+    template<bool PerEvent, bool Conflated, typename S>
+    void run_one(S& strategy, const OrderBook& order_book) {
+        constexpr bool per_event = static_delivery<S>() == DeliveryMode::PER_EVENT;
+        if constexpr (per_event ? PerEvent : Conflated) {
+            strategy.process_update(order_book, signals_);
+        }
+    }
+};
+
+} // namespace trading
\ No newline at end of file
@@ -1,16 +1,22 @@
 #pragma once
 
 #include "trading/core/order_book.h"
+#include "trading/core/pair_matrix.h"
+#include "trading/utils/fixed_point.h"
+#include "trading/utils/rcu_cell.h"
+#include <array>
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace trading {
 
 // Forward declarations
+class ConfigManager;
 class MarketDataHandler;
 
 // Signal types generated by strategies
@@ -23,21 +29,96 @@ enum class SignalType : uint8_t {
 // Signal structure
 struct Signal {
     SignalType type;
-    std::string symbol;
+    SymbolId symbol_id;
     Price price;
     Quantity quantity;
     double confidence;
     Timestamp timestamp;
     
     // Constructor
-    Signal(SignalType t, std::string_view sym, Price p, Quantity q, double conf, Timestamp ts)
-        : type(t), symbol(sym), price(p), quantity(q), confidence(conf), timestamp(ts) {}
+    Signal(SignalType t, SymbolId sym, Price p, Quantity q, double conf, Timestamp ts)
+        : type(t), symbol_id(sym), price(p), quantity(q), confidence(conf), timestamp(ts) {}
     
     // Default constructor
-    Signal() : type(SignalType::NONE), price(0), quantity(0), confidence(0.0), timestamp(0) {}
+    Signal() : type(SignalType::NONE), symbol_id(INVALID_SYMBOL_ID), price(0), quantity(0), confidence(0.0), timestamp(0) {}
+};
+
+// Fixed-capacity buffer of signals owned by the caller and reused across ticks
+class SignalBuffer {
+public:
+    // Maximum number of signals per tick
+    static constexpr size_t capacity = 256;
+    
+    // Append a signal
+    // Returns false (and counts the signal as dropped) if the buffer is full
+    bool push(const Signal& signal) {
+        if (count_ == capacity) {
+            dropped_++;
+            return false;
+        }
+        signals_[count_++] = signal;
+        return true;
+    }
+    
+    // Construct a signal in place
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        return push(Signal(std::forward<Args>(args)...));
+    }
+    
+    // Remove all signals (the dropped count is kept)
+    void clear() { count_ = 0; }
+    
+    // Number of signals
+    size_t size() const { return count_; }
+    
+    // Check if the buffer is empty
+    bool empty() const { return count_ == 0; }
+    
+    // Check if the buffer is full
+    bool full() const { return count_ == capacity; }
+    
+    // Number of signals dropped because the buffer was full
+    uint64_t dropped() const { return dropped_; }
+    
+    // Signals in the buffer
+    std::span<const Signal> signals() const { return {signals_.data(), count_}; }
+    
+    // Iterators over the signals
+    const Signal* begin() const { return signals_.data(); }
+    const Signal* end() const { return signals_.data() + count_; }
+    
+private:
+    // Signal storage
+    std::array<Signal, capacity> signals_;
+    
+    // Number of signals
+    size_t count_ = 0;
+    
+    // Signals dropped because the buffer was full
+    uint64_t dropped_ = 0;
+};
+
+// Receiver of the signals produced by one tick
+class SignalSink {
+public:
+    virtual ~SignalSink() = default;
+    
+    // Handle all signals of a tick (the span is only valid during the call)
+    virtual void on_signals(std::span<const Signal> signals) = 0;
+};
+
+// How a strategy driven by MarketDataHandler receives book updates
+enum class DeliveryMode : uint8_t {
+    PER_EVENT,  // After every event applied to a book
+    CONFLATED   // Once per changed book at the end of a batch (latest state only)
 };
 
 // Strategy interface
+// Strategies implement the buffer process method; the vector one defaults to
+// an adapter around it. Strategies written against the vector interface
+// derive from LegacyStrategy instead, which adapts the other way round, so
+// no strategy can end up with two defaults calling each other.
 class Strategy {
 public:
     virtual ~Strategy() = default;
@@ -45,26 +126,69 @@ public:
     // Initialize the strategy
     virtual void initialize() = 0;
     
+    // Process an order book update and append signals to a caller-owned buffer
+    // This is the allocation-free path used by StrategyEngine
+    virtual void process_update(const OrderBook& order_book, SignalBuffer& signals) = 0;
+    
     // Process an order book update and generate signals
-    virtual std::vector<Signal> process_update(const std::shared_ptr<OrderBook>& order_book) = 0;
+    virtual std::vector<Signal> process_update(const std::shared_ptr<OrderBook>& order_book);
     
     // Get strategy name
     virtual std::string name() const = 0;
+    
+    // Get how the strategy wants book updates delivered
+    // Strategies that only look at the current state of a book lose nothing
+    // by skipping the intermediate ones; those that count or react to every
+    // change (queue position, trade flow) should ask for every event.
+    virtual DeliveryMode delivery() const { return DeliveryMode::CONFLATED; }
+};
+
+// Base for strategies implementing only the vector process method
+// The buffer method copies the returned signals into the buffer, so these
+// strategies allocate on every update; port them to the buffer method to
+// get the allocation-free path.
+class LegacyStrategy : public Strategy {
+public:
+    // Process an order book update and append signals to a caller-owned buffer
+    void process_update(const OrderBook& order_book, SignalBuffer& signals) override;
+    
+    // Process an order book update and generate signals
+    std::vector<Signal> process_update(const std::shared_ptr<OrderBook>& order_book) override = 0;
+};
+
+// Live-tunable parameters of StatArbitrageStrategy
+struct StatArbParameters {
+    // |z-score| above which a pair signals
+    double z_score_threshold = 2.0;
+    
+    // Build from the configuration (key strategy.stat_arb.z_score_threshold)
+    static StatArbParameters from_config(const ConfigManager& config);
 };
 
 // Statistical arbitrage strategy implementation
 class StatArbitrageStrategy : public Strategy {
 public:
+    // Instrument class of the traded books (book prices are its raw units)
+    using PriceClass = EquityClass;
+    using PriceValue = PriceClass::Value;
+    
     // Constructor
     StatArbitrageStrategy(std::vector<std::string> symbols, 
                          double z_score_threshold = 2.0, 
                          size_t window_size = 100);
     
+    // Constructor with parameters published elsewhere (e.g. a configuration
+    // snapshot); every update reads the current ones with one pointer load
+    StatArbitrageStrategy(std::vector<std::string> symbols,
+                         std::shared_ptr<const RcuCell<StatArbParameters>> parameters,
+                         size_t window_size = 100);
+    
     // Initialize the strategy
     void initialize() override;
     
-    // Process an order book update and generate signals
-    std::vector<Signal> process_update(const std::shared_ptr<OrderBook>& order_book) override;
+    // Process an order book update and append signals to a caller-owned buffer
+    void process_update(const OrderBook& order_book, SignalBuffer& signals) override;
+    using Strategy::process_update;
     
     // Get strategy name
     std::string name() const override;
@@ -73,17 +197,24 @@ private:
     // Symbols to monitor
     std::vector<std::string> symbols_;
     
-    // Z-score threshold for generating signals
-    double z_score_threshold_;
+    // Parameters (z-score threshold for generating signals)
+    std::shared_ptr<const RcuCell<StatArbParameters>> parameters_;
     
     // Window size for calculation
     size_t window_size_;
     
-    // Historical mid prices for each symbol
-    std::unordered_map<std::string, std::vector<double>> price_history_;
+    // Rolling log price ratios of every tracked symbol against its peers
+    PairMatrix pairs_;
     
-    // Calculate Z-score for a pair of symbols
-    double calculate_z_score(const std::string& symbol1, const std::string& symbol2);
+    // Threshold crossings of the latest update (sized to the universe)
+    std::vector<PairSignal> pair_signals_;
+    
+    // Index into symbols_ by symbol ID (-1 if not tracked, -2 if not yet resolved)
+    std::vector<int32_t> slot_by_symbol_id_;
+    
+    // Resolve the tracked slot of an order book's symbol
+    int32_t resolve_slot(const OrderBook& order_book);
+
 };
 
 // Strategy engine class to manage strategies and generate signals
@@ -101,12 +232,28 @@ public:
     // Register a strategy
     void register_strategy(std::shared_ptr<Strategy> strategy);
     
-    // Set signal callback
+    // Set signal callback (called once per signal)
     void set_signal_callback(std::function<void(const Signal&)> callback);
     
+    // Set a sink receiving all signals of a tick at once (takes precedence
+    // over the callback; the sink must outlive the engine or be reset)
+    void set_signal_sink(SignalSink* sink);
+    
     // Process order book updates
     void process_order_book(const std::shared_ptr<OrderBook>& order_book);
     
+    // Process order book updates (no allocation on the signal path)
+    void process_order_book(const OrderBook& order_book);
+    
+    // Run the per-event strategies on a book that just changed
+    void process_event(const OrderBook& order_book);
+    
+    // Run the conflated strategies on a book that changed since their last run
+    void process_conflated(const OrderBook& order_book);
+    
+    // Check if any strategy wants per-event delivery
+    bool has_per_event() const { return !per_event_.empty(); }
+    
 private:
     // Market data handler
     std::shared_ptr<MarketDataHandler> market_data_;
@@ -114,11 +261,25 @@ private:
     // Registered strategies
     std::vector<std::shared_ptr<Strategy>> strategies_;
     
+    // Registered strategies by delivery mode
+    std::vector<Strategy*> per_event_;
+    std::vector<Strategy*> conflated_;
+    
     // Signal callback
     std::function<void(const Signal&)> signal_callback_;
     
+    // Signal sink
+    SignalSink* signal_sink_;
+    
+    // Signals of the current tick (reused across ticks)
+    SignalBuffer signals_;
+    
     // Running flag
     bool running_;
+    
+    // Run strategies on a book and emit their signals
+    template<typename Strategies>
+    void run(const Strategies& strategies, const OrderBook& order_book);
 };
 
 } // namespace trading
\ No newline at end of file
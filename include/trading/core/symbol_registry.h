@@ -0,0 +1,55 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trading {
+
+// Registry that interns symbols into dense SymbolId values
+// IDs are assigned in registration order starting at 0, so they can index
+// plain vectors. Lookups hash the symbol bytes in place and never allocate.
+class SymbolRegistry {
+public:
+    // Constructor
+    explicit SymbolRegistry(size_t expected_symbols = 64);
+    
+    // Get the ID of a symbol, registering it if needed
+    SymbolId intern(std::string_view symbol);
+    
+    // Get the ID of a registered symbol (INVALID_SYMBOL_ID if unknown)
+    SymbolId find(std::string_view symbol) const;
+    
+    // Get the name of a registered symbol (empty if unknown)
+    std::string_view name(SymbolId id) const;
+    
+    // Number of registered symbols
+    size_t size() const { return names_.size(); }
+    
+private:
+    // Hash table slot
+    struct Slot {
+        uint32_t hash;
+        SymbolId id;
+    };
+    
+    // Symbol names indexed by ID (deque keeps views stable on growth)
+    std::deque<std::string> names_;
+    
+    // Open-addressing table of symbol hash to ID
+    std::vector<Slot> table_;
+    
+    // Capacity mask
+    size_t mask_;
+    
+    // Hash symbol bytes (FNV-1a)
+    static uint32_t hash(std::string_view symbol);
+    
+    // Rebuild the table with a new capacity
+    void rehash(size_t capacity);
+};
+
+} // namespace trading
\ No newline at end of file
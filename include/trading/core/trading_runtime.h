@@ -0,0 +1,282 @@
+#pragma once
+
+#include "trading/core/execution_engine.h"
+#include "trading/core/feed_decoder.h"
+#include "trading/core/market_data.h"
+#include "trading/core/risk_gate.h"
+#include "trading/core/strategy_engine.h"
+#include "trading/utils/backoff.h"
+#include "trading/utils/latency_histogram.h"
+#include "trading/utils/lockfree_queue.h"
+#include "trading/utils/page_allocator.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+// Forward declarations
+class ConfigManager;
+
+// Runtime configuration
+struct RuntimeConfig {
+    // Number of book/strategy shards (symbols are assigned by ID % shards)
+    size_t shards = 1;
+    
+    // CPUs of the stages (-1 = no pinning)
+    int feed_cpu = -1;
+    std::vector<int> shard_cpus;   // One per shard; missing entries are unpinned
+    int risk_cpu = -1;
+    int execution_cpu = -1;
+    
+    // Packet buffers between the publisher and the feed stage
+    size_t packet_slots = 1024;    // At most MAX_PACKET_SLOTS
+    size_t packet_size = 64 * 1024;
+    
+    // Back the packet buffers with huge pages (explicit, falling back to
+    // transparent); they are pre-faulted either way
+    bool huge_pages = false;
+    
+    // Lock all memory of the process at start (see lock_memory())
+    bool lock_memory = false;
+    
+    // Warm start: on the first start every shard recreates the books it owns
+    // on its own (pinned) core, sized for orders_per_book resting orders, and
+    // runs warm_up_rounds rounds of synthetic order flow around
+    // warm_up_price through them before the feed stage starts
+    bool warm_start = false;
+    size_t orders_per_book = 4096;
+    size_t warm_up_rounds = 64;
+    Price warm_up_price = 10000;
+    
+    // Idle policy of every stage
+    BackoffPolicy backoff;
+    
+    // Read the configuration from runtime.* keys:
+    //   runtime.shards, runtime.feed_cpu, runtime.shard_cpus (list),
+    //   runtime.risk_cpu, runtime.execution_cpu, runtime.packet_slots,
+    //   runtime.packet_size, runtime.huge_pages, runtime.lock_memory,
+    //   runtime.warm_start, runtime.orders_per_book, runtime.warm_up_rounds,
+    //   runtime.warm_up_price
+    // shards defaults to the number of shard CPUs when only those are given
+    static RuntimeConfig from_config(const ConfigManager& config);
+};
+
+// Runtime counters
+struct RuntimeStats {
+    uint64_t packets = 0;           // Packets decoded by the feed stage
+    uint64_t dropped_packets = 0;   // Packets refused by publish()
+    uint64_t events = 0;            // Events routed to shards
+    uint64_t signals = 0;           // Signals passed to the risk stage
+    uint64_t dropped_signals = 0;   // Signals lost to a full risk queue
+};
+
+// Registers the strategies of one shard
+// Called once per shard with the symbols the shard owns
+using StrategyFactory = std::function<void(size_t shard, const std::vector<std::string>& symbols,
+                                           StrategyEngine& engine)>;
+
+// Pinned, pipelined runtime
+// Stages run on their own (optionally pinned) threads and are connected by
+// lock-free queues:
+//   publish() -> feed -> book/strategy shards -> risk -> execution
+// The feed stage decodes each packet once and routes every event to the
+// shard owning its symbol (symbol ID % shards). A shard applies the events to
+// its books, runs its per-event strategies after every event and, at the end
+// of each packet, its conflated strategies once per updated book. Signals of all shards go to the risk stage, which submits the
+// orders that pass the RiskGate to a BUSY_POLL ExecutionEngine. Packets must
+// hold complete messages in the native wire format; a packet's buffer is
+// recycled once every shard it touched is done with it. Books and strategies
+// are shard-local, so a strategy only sees the symbols of its own shard.
+class TradingRuntime {
+public:
+    // Most packet buffers the runtime can manage
+    static constexpr size_t MAX_PACKET_SLOTS = 4096;
+    
+    // Constructor
+    // All symbols must be subscribed on market_data beforehand
+    TradingRuntime(std::shared_ptr<MarketDataHandler> market_data, RuntimeConfig config = RuntimeConfig(),
+                   ExecutionConfig execution = ExecutionConfig(), RiskLimits limits = RiskLimits());
+    
+    // Destructor
+    ~TradingRuntime();
+    
+    // Register strategies on every shard (before start)
+    void add_strategies(const StrategyFactory& factory);
+    
+    // Set the execution report callback (called on the execution thread,
+    // after the risk gate has seen the report)
+    void set_execution_callback(std::function<void(const ExecutionReport&)> callback);
+    
+    // Start all stages
+    // The feed stage starts once every shard is ready (with warm_start, once
+    // its books are placed and warm)
+    void start();
+    
+    // Stop all stages
+    void stop();
+    
+    // Hand a packet of market data to the feed stage (one producer thread)
+    // Returns false if the packet is too large or no buffer is free
+    bool publish(const uint8_t* data, size_t length);
+    
+    // Get the shard owning a symbol
+    size_t shard_of(SymbolId symbol_id) const { return symbol_id % shards_.size(); }
+    
+    // Get the number of shards
+    size_t shard_count() const { return shards_.size(); }
+    
+    // Get the execution engine
+    ExecutionEngine& execution() { return *execution_; }
+    
+    // Get the risk gate
+    RiskGate& risk() { return *risk_; }
+    
+    // Get the counters
+    RuntimeStats stats() const;
+    
+    // Get the tick-to-signal latency of all shards: nanoseconds from
+    // publish() of a packet to the end of the strategy pass it triggered on
+    // a shard (safe while running; pass the previous result to interval()
+    // for per-interval percentiles)
+    LatencyHistogram tick_to_signal() const;
+    
+    // Get the configuration
+    const RuntimeConfig& config() const { return config_; }
+    
+    // Check if start() locked the process memory (see RuntimeConfig::lock_memory)
+    bool memory_locked() const { return memory_locked_; }
+    
+private:
+    // Capacities of the stage queues
+    static constexpr size_t PACKET_QUEUE_CAPACITY = MAX_PACKET_SLOTS;
+    static constexpr size_t EVENT_QUEUE_CAPACITY = 16 * 1024;
+    static constexpr size_t SIGNAL_QUEUE_CAPACITY = 4096;
+    
+    // Events and signals drained per queue read
+    static constexpr size_t EVENT_BATCH_SIZE = 64;
+    static constexpr size_t SIGNAL_BATCH_SIZE = 64;
+    
+    // Packet handed from the publisher to the feed stage
+    struct Packet {
+        uint32_t slot;
+        uint32_t length;
+        Timestamp received;   // TscClock time of publish()
+    };
+    
+    // Sink forwarding a shard's signals to the risk stage
+    class ShardSink : public SignalSink {
+    public:
+        // Constructor
+        ShardSink(LockFreeQueue<Signal, SIGNAL_QUEUE_CAPACITY>& queue, std::atomic<uint64_t>& dropped)
+            : queue_(queue), dropped_(dropped) {}
+        
+        // Queue all signals of a tick
+        void on_signals(std::span<const Signal> signals) override;
+    
+    private:
+        LockFreeQueue<Signal, SIGNAL_QUEUE_CAPACITY>& queue_;
+        std::atomic<uint64_t>& dropped_;
+    };
+    
+    // Book/strategy shard
+    struct Shard {
+        // Constructor
+        Shard(std::shared_ptr<MarketDataHandler> market_data, std::atomic<uint64_t>& dropped_signals);
+        
+        // Events from the feed stage (packet ends are marked by a HEARTBEAT
+        // event whose sequence is the packet's slot and whose timestamp is
+        // the packet's publish time)
+        LockFreeQueue<FeedEvent, EVENT_QUEUE_CAPACITY> events;
+        
+        // Signals to the risk stage
+        LockFreeQueue<Signal, SIGNAL_QUEUE_CAPACITY> signals;
+        
+        // Strategies of this shard
+        StrategyEngine strategies;
+        ShardSink sink;
+        
+        // Books updated by the current packet, by symbol ID
+        Bitmap dirty;
+        
+        // Time from publish() to the end of the packet's strategy pass
+        // (recorded by the shard thread only)
+        LatencyHistogram tick_to_signal;
+        
+        // Stage thread
+        std::thread thread;
+        size_t index = 0;
+        int cpu = -1;
+        
+        // Set by the shard thread once its books are placed and warm
+        std::atomic<bool> ready{false};
+    };
+    
+    // Market data handler (owns the books)
+    std::shared_ptr<MarketDataHandler> market_data_;
+    
+    // Configuration
+    RuntimeConfig config_;
+    
+    // Execution stage
+    std::shared_ptr<ExecutionEngine> execution_;
+    
+    // Risk gate
+    std::shared_ptr<RiskGate> risk_;
+    
+    // User execution report callback
+    std::function<void(const ExecutionReport&)> execution_callback_;
+    
+    // Packet buffers and the shards still using each one
+    PageAllocation packet_pages_;
+    uint8_t* packet_memory_ = nullptr;
+    std::unique_ptr<std::atomic<uint32_t>[]> packet_refs_;
+    
+    // Free packet buffers (returned by the feed stage and the shards)
+    std::unique_ptr<MpscQueue<uint32_t, MAX_PACKET_SLOTS>> free_packets_;
+    
+    // Packets for the feed stage
+    std::unique_ptr<LockFreeQueue<Packet, PACKET_QUEUE_CAPACITY>> packets_;
+    
+    // Shards
+    std::vector<std::unique_ptr<Shard>> shards_;
+    
+    // Stage threads
+    std::thread feed_thread_;
+    std::thread risk_thread_;
+    
+    // Counters
+    std::atomic<uint64_t> packet_count_;
+    std::atomic<uint64_t> dropped_packets_;
+    std::atomic<uint64_t> event_count_;
+    std::atomic<uint64_t> signal_count_;
+    std::atomic<uint64_t> dropped_signals_;
+    
+    // Running flag
+    std::atomic<bool> running_;
+    
+    // Memory locked by start()
+    bool memory_locked_ = false;
+    
+    // Stage loops
+    void run_feed();
+    void run_shard(Shard& shard);
+    void run_risk();
+    
+    // Place and warm the books of a shard (on the shard thread)
+    void warm_start(Shard& shard);
+    
+    // Return a packet buffer once its last user is done with it
+    void release_packet(uint32_t slot);
+    
+    // Push into a full queue by spinning (never drops market data)
+    template<typename Queue, typename T>
+    bool push_spinning(Queue& queue, const T& value);
+};
+
+} // namespace trading
\ No newline at end of file
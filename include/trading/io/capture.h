@@ -0,0 +1,290 @@
+#pragma once
+
+#include "trading/io/multicast_receiver.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Forward declarations
+class MarketDataHandler;
+
+// Capture file layout
+// A capture file is a header page followed by records, each a
+// CaptureRecordHeader and the raw datagram, padded to 8 bytes. Records are
+// packed across page boundaries; the writer only ever writes whole pages, so
+// the file size is always a multiple of CAPTURE_PAGE_SIZE and the unused tail
+// of the last page of every flush is zero. A zero header (or less than a
+// header left in the page) means the rest of the page is padding.
+constexpr size_t CAPTURE_PAGE_SIZE = 4096;
+
+// Magic bytes of a capture file
+constexpr char CAPTURE_FILE_MAGIC[8] = {'T', 'R', 'D', 'C', 'A', 'P', '1', '\0'};
+
+// Header at the start of a capture file (the rest of the page is zero)
+struct CaptureFileHeader {
+    char magic[8];        // CAPTURE_FILE_MAGIC
+    uint32_t version;     // 1
+    uint32_t page_size;   // CAPTURE_PAGE_SIZE
+    uint64_t created_ns;  // Nanoseconds since the epoch
+};
+
+// Header of one captured datagram
+struct CaptureRecordHeader {
+    uint64_t receive_ns;  // Receive timestamp, nanoseconds since the epoch
+    uint32_t length;      // Datagram bytes that follow
+    uint16_t flags;       // CAPTURE_HARDWARE_TIMESTAMP
+    uint16_t reserved;
+};
+
+static_assert(sizeof(CaptureRecordHeader) == 16, "Records are laid out in 8-byte units");
+
+// Record flag: receive_ns came from the NIC
+constexpr uint16_t CAPTURE_HARDWARE_TIMESTAMP = 1;
+
+// Append-only writer of capture files
+// Records are copied into a page-aligned buffer that is written out in whole
+// pages when it fills, so the capture path costs a memcpy per datagram and a
+// write() per buffer. Not thread-safe; use one writer per receive thread.
+class CaptureWriter {
+public:
+    // Constructor (the buffer is rounded up to whole pages)
+    explicit CaptureWriter(size_t buffer_bytes = 1024 * 1024);
+    
+    // Destructor (flushes and closes the file)
+    ~CaptureWriter();
+    
+    // Create a capture file, or continue an existing one if append is set
+    // Returns false if the file cannot be opened or is not a capture file
+    bool open(const std::string& path, bool append = false);
+    
+    // Flush and close the file
+    void close();
+    
+    // Check if a file is open
+    bool is_open() const { return fd_ >= 0; }
+    
+    // Append a datagram (empty datagrams are skipped)
+    // Returns false if a write failed
+    bool write(const uint8_t* data, size_t length, Timestamp receive_ns, bool hardware_timestamp = false);
+    
+    // Append a received datagram
+    bool write(const ReceivedPacket& packet) {
+        return write(packet.data, packet.length, packet.receive_ns, packet.hardware_timestamp);
+    }
+    
+    // Write out the buffered records, padding the last page
+    bool flush();
+    
+    // Get the number of records written
+    uint64_t records() const { return records_; }
+    
+    // Get the file size including buffered records
+    uint64_t bytes() const { return file_bytes_ + used_; }
+    
+private:
+    // File descriptor
+    int fd_;
+    
+    // Page buffer
+    std::unique_ptr<uint8_t[]> buffer_;
+    size_t capacity_;
+    size_t used_;
+    
+    // Counters
+    uint64_t records_;
+    uint64_t file_bytes_;
+    
+    // Copy bytes into the buffer, writing it out whenever it fills
+    bool append(const void* data, size_t size);
+    
+    // Write the first size bytes of the buffer (a multiple of the page size)
+    bool write_buffer(size_t size);
+};
+
+// Read-only memory mapping of a capture file
+// Datagrams are handed out in place, pointing into the mapping.
+class CaptureFile {
+public:
+    // Constructor
+    CaptureFile() = default;
+    
+    // Destructor
+    ~CaptureFile();
+    
+    CaptureFile(const CaptureFile&) = delete;
+    CaptureFile& operator=(const CaptureFile&) = delete;
+    
+    // Map a capture file (prefault reads the whole file in up front)
+    // Returns false if the file cannot be mapped or is not a capture file
+    bool open(const std::string& path, bool prefault = false);
+    
+    // Unmap the file
+    void close();
+    
+    // Check if a file is mapped
+    bool is_open() const { return data_ != nullptr; }
+    
+    // Read the next datagram (valid while the file is mapped)
+    // Returns false at the end of the file
+    bool next(ReceivedPacket& packet);
+    
+    // Go back to the first record
+    void rewind() { offset_ = CAPTURE_PAGE_SIZE; }
+    
+    // Check if the file ended in the middle of a record (e.g. after a crash)
+    bool truncated() const { return truncated_; }
+    
+    // Get the mapped size in bytes
+    size_t size() const { return size_; }
+    
+    // Get the path
+    const std::string& path() const { return path_; }
+    
+private:
+    // Mapping
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    
+    // Offset of the next record
+    size_t offset_ = CAPTURE_PAGE_SIZE;
+    
+    // Set when the last record is incomplete
+    bool truncated_ = false;
+    
+    // Path
+    std::string path_;
+};
+
+// Replay configuration
+struct ReplayConfig {
+    // Replay speed relative to the capture: 0 = as fast as possible,
+    // 1 = original pacing, 10 = ten times faster
+    double speed = 0.0;
+    
+    // Read every file in before starting (no page faults during the replay)
+    bool prefault = true;
+};
+
+// Replay statistics
+struct ReplayStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    Timestamp first_ns = 0;    // Earliest receive timestamp replayed
+    Timestamp last_ns = 0;     // Latest receive timestamp replayed
+    uint64_t elapsed_ns = 0;   // Wall time of the replay
+};
+
+// Replays capture files in receive-timestamp order
+// Files are memory-mapped and merged with a min-heap on the timestamp of
+// their next record (ties go to the file added first), and every datagram is
+// handed to the handler straight out of the mapping.
+class CaptureReplay {
+public:
+    // Constructor
+    explicit CaptureReplay(ReplayConfig config = ReplayConfig());
+    
+    // Add a capture file
+    // Returns false if it cannot be mapped
+    bool add_file(const std::string& path);
+    
+    // Replay all files, calling handler(const ReceivedPacket&) per datagram
+    // Returns the number of datagrams replayed (stops early after stop())
+    template<typename Handler>
+    size_t run(Handler&& handler);
+    
+    // Replay all files into a market data handler
+    size_t run(MarketDataHandler& market_data);
+    
+    // Stop a running replay (any thread)
+    void stop() { stopping_.store(true, std::memory_order_relaxed); }
+    
+    // Get the statistics of the last run
+    const ReplayStats& stats() const { return stats_; }
+    
+    // Get the configuration
+    const ReplayConfig& config() const { return config_; }
+    
+private:
+    // File and its next record
+    struct Source {
+        std::unique_ptr<CaptureFile> file;
+        ReceivedPacket head;
+    };
+    
+    // Configuration
+    ReplayConfig config_;
+    
+    // Capture files
+    std::vector<Source> sources_;
+    
+    // Indices of the sources with records left, ordered by head timestamp
+    std::vector<size_t> heap_;
+    
+    // Statistics
+    ReplayStats stats_;
+    
+    // Stop flag
+    std::atomic<bool> stopping_{false};
+    
+    // Heap order: later timestamps (then later files) sink
+    bool later(size_t a, size_t b) const {
+        const Timestamp ta = sources_[a].head.receive_ns;
+        const Timestamp tb = sources_[b].head.receive_ns;
+        return ta != tb ? ta > tb : a > b;
+    }
+    
+    // Rewind every file and fill the heap
+    void prepare();
+    
+    // Wait until a capture timestamp is due (paced replay)
+    void pace(Timestamp receive_ns, uint64_t start_ns) const;
+    
+    // Current wall time in nanoseconds
+    static uint64_t now_ns();
+};
+
+template<typename Handler>
+size_t CaptureReplay::run(Handler&& handler) {
+    stopping_.store(false, std::memory_order_relaxed);
+    prepare();
+    
+    auto order = [this](size_t a, size_t b) { return later(a, b); };
+    const uint64_t start_ns = now_ns();
+    const bool paced = config_.speed > 0.0;
+    
+    while (!heap_.empty() && !stopping_.load(std::memory_order_relaxed)) {
+        std::pop_heap(heap_.begin(), heap_.end(), order);
+        Source& source = sources_[heap_.back()];
+        const ReceivedPacket& packet = source.head;
+        
+        if (stats_.packets == 0) {
+            stats_.first_ns = packet.receive_ns;
+        }
+        if (paced) {
+            pace(packet.receive_ns, start_ns);
+        }
+        
+        handler(packet);
+        stats_.packets++;
+        stats_.bytes += packet.length;
+        stats_.last_ns = std::max(stats_.last_ns, packet.receive_ns);
+        
+        // Put the file back with its next record, or drop it at its end
+        if (source.file->next(source.head)) {
+            std::push_heap(heap_.begin(), heap_.end(), order);
+        } else {
+            heap_.pop_back();
+        }
+    }
+    
+    stats_.elapsed_ns = now_ns() - start_ns;
+    return static_cast<size_t>(stats_.packets);
+}
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "trading/core/order_book.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+// Forward declarations
+class MarketDataHandler;
+
+// Multicast receiver configuration
+struct MulticastConfig {
+    // Multicast group address and port
+    std::string group;
+    uint16_t port = 0;
+    
+    // Local interface address to join on (empty = any)
+    std::string interface_address;
+    
+    // Interface name, required to enable NIC hardware timestamping (e.g. "eth0")
+    std::string interface_name;
+    
+    // Datagrams received per recvmmsg call
+    size_t batch_size = 64;
+    
+    // Bytes per pre-registered datagram buffer (must fit the largest datagram)
+    size_t datagram_size = 2048;
+    
+    // Kernel socket receive buffer size in bytes (0 = system default)
+    int receive_buffer_bytes = 8 * 1024 * 1024;
+    
+    // SO_BUSY_POLL budget in microseconds (0 = disabled)
+    int busy_poll_us = 0;
+    
+    // Request SO_TIMESTAMPING receive timestamps (hardware when available)
+    bool hardware_timestamps = false;
+    
+    // Spin on non-blocking reads instead of blocking in the kernel
+    bool spin = true;
+    
+    // CPU to pin the receive thread to (-1 = no pinning)
+    int cpu = -1;
+};
+
+// Datagram received into one of the receiver's pre-registered buffers
+// The data stays valid until the next call to poll()
+struct ReceivedPacket {
+    const uint8_t* data;
+    size_t length;
+    Timestamp receive_ns;     // Nanoseconds since epoch
+    bool hardware_timestamp;  // True if receive_ns came from the NIC
+};
+
+// Receiver statistics
+struct MulticastStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t batches = 0;
+    uint64_t truncated = 0;
+    uint64_t errors = 0;
+};
+
+// UDP multicast receiver with batched reads into pre-registered buffers
+// Datagrams are read with recvmmsg (Linux) straight into a fixed arena and
+// handed out in place, so the market data handler parses them without a copy.
+// Only the socket layer is kernel-specific; poll() and the packet contract are
+// what a kernel-bypass backend would implement as well.
+class MulticastReceiver {
+public:
+    // Callback type for received datagrams
+    using PacketCallback = std::function<void(const ReceivedPacket&)>;
+    
+    // Constructor
+    explicit MulticastReceiver(MulticastConfig config);
+    
+    // Destructor
+    ~MulticastReceiver();
+    
+    // Open the socket, join the group and register the receive buffers
+    // Returns false on failure (or on platforms without recvmmsg)
+    bool open();
+    
+    // Close the socket
+    void close();
+    
+    // Check if the socket is open
+    bool is_open() const { return fd_ >= 0; }
+    
+    // Receive one batch of datagrams and pass each to the handler in place
+    // Datagrams truncated by the receive buffer are dropped and counted.
+    // Returns the number of datagrams passed to the handler
+    template<typename Handler>
+    size_t poll(Handler&& handler) {
+        size_t count = receive_batch();
+        for (size_t i = 0; i < count; ++i) {
+            handler(packets_[i]);
+        }
+        return count;
+    }
+    
+    // Start a pinned receive thread calling the callback for every datagram
+    bool start(PacketCallback callback);
+    
+    // Start a pinned receive thread feeding a market data handler
+    bool start(MarketDataHandler& market_data);
+    
+    // Stop the receive thread
+    void stop();
+    
+    // Get receiver statistics
+    MulticastStats stats() const;
+    
+    // Get the configuration
+    const MulticastConfig& config() const { return config_; }
+    
+private:
+    // Platform-specific receive state (mmsghdr/iovec/control arrays)
+    struct BatchState;
+    
+    // Configuration
+    MulticastConfig config_;
+    
+    // Socket descriptor
+    int fd_;
+    
+    // Arena of datagram buffers (batch_size * datagram_size bytes)
+    std::unique_ptr<uint8_t[]> arena_;
+    
+    // Received packets of the current batch
+    std::vector<ReceivedPacket> packets_;
+    
+    // Platform-specific receive state
+    std::unique_ptr<BatchState> batch_;
+    
+    // Receive thread
+    std::thread thread_;
+    
+    // Running flag
+    std::atomic<bool> running_;
+    
+    // Statistics (written by the receiving thread)
+    std::atomic<uint64_t> packet_count_;
+    std::atomic<uint64_t> byte_count_;
+    std::atomic<uint64_t> batch_count_;
+    std::atomic<uint64_t> truncated_count_;
+    std::atomic<uint64_t> error_count_;
+    
+    // Receive one batch into the arena and fill packets_ with the complete
+    // datagrams; returns their number
+    size_t receive_batch();
+    
+    // Enable hardware timestamping on the interface
+    bool enable_hardware_timestamps();
+};
+
+} // namespace trading
\ No newline at end of file
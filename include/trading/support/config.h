@@ -1,8 +1,12 @@
 #pragma once
 
+#include "trading/utils/rcu_cell.h"
 #include <any>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -55,6 +59,11 @@ private:
 using ConfigListener = std::function<void(std::string_view, const ConfigValue&)>;
 
 // Config manager class
+// All members may be called from any thread. Lookups hash the key in place
+// (no string is built for it), but still copy and reparse the value, so hot
+// paths should not call get(): they read typed snapshots instead (see
+// snapshot()). Listeners and snapshot rebuilds run on the thread that
+// changed the value, after the change and outside the manager's lock.
 class ConfigManager {
 public:
     // Get the singleton instance
@@ -84,15 +93,54 @@ public:
     // Get all configuration keys
     std::vector<std::string> get_keys() const;
     
+    // Get the number of changes made so far
+    uint64_t version() const;
+    
+    // Publish a typed snapshot of part of the key space
+    // compile builds a T from the configuration; it runs now and again after
+    // every change to a key starting with prefix, and each result is swapped
+    // into the returned cell. Readers get the current settings with one
+    // pointer load (cell->load()), so thresholds and limits can be changed
+    // live without stalling or racing the threads that use them. The cell
+    // stops being updated once the last reference to it is dropped.
+    template<typename T>
+    std::shared_ptr<const RcuCell<T>> snapshot(std::string prefix, std::function<T(const ConfigManager&)> compile);
+    
 private:
     // Constructor (private for singleton)
     ConfigManager();
     
+    // Transparent string hash (lookups by string_view without a copy)
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>()(key); }
+    };
+    
+    // Snapshot rebuilt on changes under a key prefix
+    struct SnapshotBinding {
+        std::string prefix;
+        
+        // Rebuilds and publishes the snapshot; false once it is no longer used
+        std::function<bool(const ConfigManager&)> refresh;
+    };
+    
+    // Guards the maps and the bindings
+    mutable std::shared_mutex mutex_;
+    
+    // Serializes snapshot rebuilds
+    std::mutex refresh_mutex_;
+    
     // Map of configuration values
-    std::unordered_map<std::string, ConfigValue> config_;
+    std::unordered_map<std::string, ConfigValue, KeyHash, std::equal_to<>> config_;
     
     // Map of listeners for specific keys
-    std::unordered_map<std::string, std::vector<ConfigListener>> listeners_;
+    std::unordered_map<std::string, std::vector<ConfigListener>, KeyHash, std::equal_to<>> listeners_;
+    
+    // Typed snapshots kept up to date
+    std::vector<std::shared_ptr<SnapshotBinding>> snapshots_;
+    
+    // Changes made so far
+    uint64_t version_ = 0;
     
     // Trim a string
     static std::string trim(std::string_view str);
@@ -102,6 +150,35 @@ private:
     
     // Notify listeners of a configuration change
     void notify_listeners(std::string_view key, const ConfigValue& value);
+    
+    // Refresh the snapshots covering a key
+    void refresh_snapshots(std::string_view key);
 };
 
+//
+// ConfigManager template implementation
+//
+
+template<typename T>
+std::shared_ptr<const RcuCell<T>> ConfigManager::snapshot(std::string prefix,
+                                                          std::function<T(const ConfigManager&)> compile) {
+    auto cell = std::make_shared<RcuCell<T>>(compile(*this));
+    
+    auto binding = std::make_shared<SnapshotBinding>();
+    binding->prefix = std::move(prefix);
+    binding->refresh = [weak = std::weak_ptr<RcuCell<T>>(cell), compile = std::move(compile)](
+                           const ConfigManager& config) {
+        auto target = weak.lock();
+        if (!target) {
+            return false;
+        }
+        target->publish(compile(config));
+        return true;
+    };
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    snapshots_.push_back(std::move(binding));
+    return cell;
+}
+
 } // namespace trading
\ No newline at end of file
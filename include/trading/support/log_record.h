@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace trading {
+
+// Type tag of an argument in a binary log record
+enum class LogArgType : uint8_t {
+    INT = 1,     // int64_t
+    UINT = 2,    // uint64_t
+    DOUBLE = 3,  // double
+    BOOL = 4,    // uint8_t
+    CHAR = 5,    // char
+    STRING = 6   // uint16_t length, then the bytes
+};
+
+// Header of a binary log record
+// The encoded arguments follow (a type tag and the raw value each) and the
+// record is padded to a multiple of 8 bytes
+struct LogRecordHeader {
+    uint32_t size;        // Record size in bytes, including header and padding
+    uint16_t format_id;   // Call site (or one of the special IDs below)
+    uint8_t level;        // LogLevel
+    uint8_t arg_count;    // Encoded arguments
+    uint64_t timestamp;   // CycleCounter ticks
+};
+
+static_assert(sizeof(LogRecordHeader) == 16, "Records are laid out in 8-byte units");
+
+// Format IDs with a special meaning
+constexpr uint16_t LOG_FORMAT_DYNAMIC = 0xFFFC;       // The first argument is the format string
+constexpr uint16_t LOG_FORMAT_UNREGISTERED = 0xFFFD;  // Call site table was full
+constexpr uint16_t LOG_FORMAT_DEFINITION = 0xFFFE;    // Binary file: defines a call site
+constexpr uint16_t LOG_FORMAT_PADDING = 0xFFFF;       // Ring: skip to the start of the buffer
+
+// Longest string argument kept (longer strings are truncated)
+constexpr size_t LOG_MAX_STRING_ARG = 1024;
+
+// Mapping between CycleCounter ticks and nanoseconds since the epoch
+struct LogClock {
+    uint64_t base_ticks = 0;
+    uint64_t base_ns = 0;
+    double ticks_per_ns = 1.0;
+    
+    // Ticks to nanoseconds since the epoch
+    uint64_t to_ns(uint64_t ticks) const {
+        double delta = static_cast<double>(static_cast<int64_t>(ticks - base_ticks)) / ticks_per_ns;
+        return base_ns + static_cast<int64_t>(delta);
+    }
+    
+    // Nanoseconds since the epoch to ticks
+    uint64_t to_ticks(uint64_t ns) const {
+        double delta = static_cast<double>(static_cast<int64_t>(ns - base_ns)) * ticks_per_ns;
+        return base_ticks + static_cast<int64_t>(delta);
+    }
+};
+
+// Header of a binary log file (records follow)
+struct LogFileHeader {
+    char magic[8];        // LOG_FILE_MAGIC
+    LogClock clock;       // Converts record timestamps
+};
+
+// Magic bytes of a binary log file
+constexpr char LOG_FILE_MAGIC[8] = {'T', 'R', 'D', 'L', 'O', 'G', '1', '\0'};
+
+namespace detail {
+
+// View of a string-like argument
+template<typename T>
+std::string_view log_string(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return value ? std::string_view(value) : std::string_view("(null)");
+    } else {
+        return std::string_view(value);
+    }
+}
+
+// Encoded size of one argument
+template<typename T>
+size_t log_arg_size(const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return 2;
+    } else if constexpr (std::is_arithmetic_v<U> || std::is_enum_v<U>) {
+        return 1 + 8;
+    } else {
+        return 1 + 2 + std::min(log_string(value).size(), LOG_MAX_STRING_ARG);
+    }
+}
+
+// Append one argument at out
+template<typename T>
+void encode_log_arg(uint8_t*& out, const T& value) {
+    using U = std::decay_t<T>;
+    auto put = [&out](LogArgType type, const void* data, size_t size) {
+        *out++ = static_cast<uint8_t>(type);
+        std::memcpy(out, data, size);
+        out += size;
+    };
+    
+    if constexpr (std::is_same_v<U, bool>) {
+        uint8_t flag = value ? 1 : 0;
+        put(LogArgType::BOOL, &flag, 1);
+    } else if constexpr (std::is_same_v<U, char>) {
+        put(LogArgType::CHAR, &value, 1);
+    } else if constexpr (std::is_enum_v<U>) {
+        encode_log_arg(out, static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_floating_point_v<U>) {
+        double number = static_cast<double>(value);
+        put(LogArgType::DOUBLE, &number, 8);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        int64_t number = value;
+        put(LogArgType::INT, &number, 8);
+    } else if constexpr (std::is_integral_v<U>) {
+        uint64_t number = value;
+        put(LogArgType::UINT, &number, 8);
+    } else {
+        std::string_view text = log_string(value);
+        uint16_t length = static_cast<uint16_t>(std::min(text.size(), LOG_MAX_STRING_ARG));
+        *out++ = static_cast<uint8_t>(LogArgType::STRING);
+        std::memcpy(out, &length, 2);
+        std::memcpy(out + 2, text.data(), length);
+        out += 2 + length;
+    }
+}
+
+} // namespace detail
+
+// Single-producer, single-consumer ring of binary log records
+// Each logging thread owns one ring; the logger thread drains it. A record
+// never wraps: if it does not fit before the end of the buffer, the producer
+// writes a padding marker and starts the record at the beginning. Records
+// that do not fit are dropped (and counted) rather than blocking the caller.
+class LogRing {
+public:
+    // Buffer size in bytes
+    static constexpr size_t CAPACITY = 256 * 1024;
+    
+    // Largest record accepted
+    static constexpr size_t MAX_RECORD_SIZE = CAPACITY / 4;
+    
+    // Reserve space for a record of size bytes (a multiple of 8)
+    // Returns nullptr if the ring is full
+    uint8_t* reserve(size_t size) {
+        size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+        size_t offset = write_pos & (CAPACITY - 1);
+        size_t padding = offset + size > CAPACITY ? CAPACITY - offset : 0;
+        
+        if (!has_room(write_pos, padding + size)) {
+            return nullptr;
+        }
+        
+        if (padding > 0) {
+            uint32_t padding_size = static_cast<uint32_t>(padding);
+            std::memcpy(buffer_ + offset, &padding_size, sizeof(padding_size));
+            std::memcpy(buffer_ + offset + offsetof(LogRecordHeader, format_id), &LOG_FORMAT_PADDING,
+                        sizeof(LOG_FORMAT_PADDING));
+            offset = 0;
+        }
+        
+        pending_ = padding + size;
+        return buffer_ + offset;
+    }
+    
+    // Publish the reserved record
+    void commit() {
+        write_pos_.store(write_pos_.load(std::memory_order_relaxed) + pending_, std::memory_order_release);
+    }
+    
+    // Count a record that did not fit
+    void drop() {
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    // Records dropped so far
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    
+    // Hand every published record to handler(const LogRecordHeader&, const uint8_t* record)
+    // and release their space (consumer only)
+    // Returns the number of records handled
+    template<typename Handler>
+    size_t drain(Handler&& handler) {
+        size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+        size_t write_pos = write_pos_.load(std::memory_order_acquire);
+        size_t records = 0;
+        
+        while (read_pos != write_pos) {
+            const uint8_t* record = buffer_ + (read_pos & (CAPACITY - 1));
+            LogRecordHeader header;
+            std::memcpy(&header, record, offsetof(LogRecordHeader, level));
+            if (header.format_id != LOG_FORMAT_PADDING) {
+                std::memcpy(&header, record, sizeof(header));
+                handler(header, record);
+                records++;
+            }
+            read_pos += header.size;
+        }
+        
+        read_pos_.store(read_pos, std::memory_order_release);
+        return records;
+    }
+    
+    // Mark the ring as abandoned by its thread
+    void retire() { retired_.store(true, std::memory_order_release); }
+    
+    // Check if the owning thread has exited
+    bool retired() const { return retired_.load(std::memory_order_acquire); }
+    
+    // Check if every published record has been drained (consumer only)
+    bool empty() const {
+        return read_pos_.load(std::memory_order_relaxed) == write_pos_.load(std::memory_order_acquire);
+    }
+    
+private:
+    // Record buffer
+    alignas(64) uint8_t buffer_[CAPACITY];
+    
+    // Consumer position
+    alignas(64) std::atomic<size_t> read_pos_{0};
+    
+    // Producer position, its copy of the consumer position and the reserved size
+    alignas(64) std::atomic<size_t> write_pos_{0};
+    size_t cached_read_pos_ = 0;
+    size_t pending_ = 0;
+    
+    // Records dropped because the ring was full
+    std::atomic<uint64_t> dropped_{0};
+    
+    // Set when the owning thread exits
+    std::atomic<bool> retired_{false};
+    
+    // Check if bytes more can be written (reloads the consumer position only if needed)
+    bool has_room(size_t write_pos, size_t bytes) {
+        if (CAPACITY - (write_pos - cached_read_pos_) >= bytes) {
+            return true;
+        }
+        cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+        return CAPACITY - (write_pos - cached_read_pos_) >= bytes;
+    }
+};
+
+} // namespace trading
\ No newline at end of file
@@ -1,11 +1,17 @@
 #pragma once
 
+#include "trading/support/log_record.h"
 #include "trading/utils/lockfree_queue.h"
+#include "trading/utils/timekeeper.h"
+#include "trading/utils/tsc_clock.h"
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <functional>
+#include <iosfwd>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -24,6 +30,20 @@ enum class LogLevel : uint8_t {
     FATAL = 5
 };
 
+// Output format of the log file
+enum class LogOutput : uint8_t {
+    TEXT = 0,    // Formatted lines
+    BINARY = 1   // Raw records, formatted later by Logger::decode
+};
+
+// Static call site of a LOG_FMT statement
+struct LogSite {
+    LogLevel level;
+    const char* format;   // "{}" placeholders, "{{" and "}}" for literal braces
+    const char* file;
+    uint32_t line;
+};
+
 // Logger class
 class Logger {
 public:
@@ -31,7 +51,8 @@ public:
     static Logger& instance();
     
     // Initialize the logger
-    void initialize(std::string_view log_file, LogLevel min_level = LogLevel::INFO);
+    void initialize(std::string_view log_file, LogLevel min_level = LogLevel::INFO,
+                    LogOutput output = LogOutput::TEXT);
     
     // Set minimum log level
     void set_min_level(LogLevel level);
@@ -49,8 +70,49 @@ public:
     void flush();
     
     // Log a message with formatted arguments
+    // The format and arguments are copied raw into the calling thread's ring
+    // and formatted by the logger thread; format must use "{}" placeholders.
+    // LOG_FMT is cheaper, as it records a static format ID instead of the
+    // format string.
     template<typename... Args>
-    void log_fmt(LogLevel level, std::string_view format, Args&&... args);
+    void log_fmt(LogLevel level, std::string_view format, const Args&... args) {
+        if (is_enabled(level)) {
+            log_binary(LOG_FORMAT_DYNAMIC, level, format, args...);
+        }
+    }
+    
+    // Record a binary log record in the calling thread's ring (see LOG_FMT)
+    // Never blocks or allocates after the thread's first record; records that
+    // do not fit are dropped and counted
+    template<typename... Args>
+    void log_binary(uint16_t format_id, LogLevel level, const Args&... args) {
+        static_assert(sizeof...(Args) < 256, "Too many log arguments");
+        size_t size = (sizeof(LogRecordHeader) + (detail::log_arg_size(args) + ... + size_t(0)) + 7) & ~size_t(7);
+        
+        LogRing& ring = thread_ring();
+        uint8_t* record = size <= LogRing::MAX_RECORD_SIZE ? ring.reserve(size) : nullptr;
+        if (!record) {
+            ring.drop();
+            return;
+        }
+        
+        LogRecordHeader header{static_cast<uint32_t>(size), format_id, static_cast<uint8_t>(level),
+                               static_cast<uint8_t>(sizeof...(Args)), CycleCounter::start()};
+        std::memcpy(record, &header, sizeof(header));
+        uint8_t* out = record + sizeof(header);
+        (detail::encode_log_arg(out, args), ...);
+        ring.commit();
+    }
+    
+    // Assign a format ID to a call site (once per LOG_FMT statement)
+    uint16_t register_site(const LogSite& site);
+    
+    // Binary records dropped because a thread's ring was full
+    uint64_t dropped() const;
+    
+    // Format a binary log file as text
+    // Returns false if the input is not a binary log
+    static bool decode(std::istream& in, std::ostream& out);
     
     // Utility functions for different log levels
     void trace(std::string_view message);
@@ -86,8 +148,48 @@ private:
         LogEntry() : level(LogLevel::INFO) {}
     };
     
-    // Queue of log entries
-    LockFreeQueue<LogEntry, 1024> log_queue_;
+    // Call sites that can be registered
+    static constexpr size_t MAX_LOG_SITES = 4096;
+    
+    // Owns the calling thread's ring and retires it when the thread exits
+    struct RingHandle {
+        std::shared_ptr<LogRing> ring;
+        
+        RingHandle();
+        ~RingHandle();
+    };
+    
+    // Queue of log entries (any thread logs, the logger thread drains)
+    MpscQueue<LogEntry, 1024> log_queue_;
+    
+    // Registered call sites by format ID
+    std::array<std::atomic<const LogSite*>, MAX_LOG_SITES> sites_{};
+    std::atomic<uint32_t> site_count_;
+    
+    // Rings of threads that have logged (retired rings are removed once drained)
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    mutable std::mutex rings_mutex_;
+    
+    // Records dropped by rings that have been removed
+    uint64_t retired_drops_;
+    
+    // Drop count last reported in the log
+    uint64_t reported_drops_;
+    
+    // Clock of the binary file (text output converts with TscClock)
+    LogClock clock_;
+    
+    // Output format
+    LogOutput output_;
+    
+    // Call sites whose definition has been written to the binary file
+    std::vector<bool> defined_sites_;
+    
+    // Text or records waiting to be written (one write per drain)
+    std::string write_buffer_;
+    
+    // Serializes draining (logger thread and flush)
+    std::mutex drain_mutex_;
     
     // Minimum log level
     std::atomic<LogLevel> min_level_;
@@ -107,11 +209,24 @@ private:
     // Logger thread function
     void logger_thread_func();
     
-    // Format a log entry
-    std::string format_entry(const LogEntry& entry);
+    // Calling thread's ring (created and registered on first use)
+    LogRing& thread_ring() {
+        thread_local RingHandle handle;
+        return *handle.ring;
+    }
+    
+    // Format or encode everything queued and write it out
+    // Returns the number of entries and records drained
+    size_t drain();
+    
+    // Append a queued text entry to the write buffer
+    void append_entry(const LogEntry& entry);
+    
+    // Append a binary record to the write buffer
+    void append_record(const LogRecordHeader& header, const uint8_t* record);
     
     // Convert a log level to a string
-    std::string_view level_to_string(LogLevel level) const;
+    static std::string_view level_to_string(LogLevel level);
 };
 
 // Macro for conditional logging
@@ -122,6 +237,18 @@ private:
         } \
     } while (0)
 
+// Log a formatted message with a static format ID and deferred formatting
+// The arguments (integers, floating point, bool, char, enums and strings) are
+// copied raw into a per-thread ring; the logger thread formats them
+#define LOG_FMT(level, format, ...) \
+    do { \
+        if (Logger::instance().is_enabled(level)) { \
+            static const LogSite log_site_{level, format, __FILE__, __LINE__}; \
+            static const uint16_t log_format_id_ = Logger::instance().register_site(log_site_); \
+            Logger::instance().log_binary(log_format_id_, level __VA_OPT__(,) __VA_ARGS__); \
+        } \
+    } while (0)
+
 // Macros for different log levels
 #define LOG_TRACE(message) Logger::instance().trace(message)
 #define LOG_DEBUG(message) Logger::instance().debug(message)
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace trading {
+
+// Idle policy of a polling consumer
+// The consumer spins first, then yields its core, then (optionally) sleeps.
+// A spin-only policy keeps the wake-up latency at a few nanoseconds at the
+// cost of burning the core.
+struct BackoffPolicy {
+    // Empty polls spent spinning with a CPU relax hint
+    uint32_t spin_iterations = 4096;
+    
+    // Empty polls spent yielding after spinning
+    uint32_t yield_iterations = 64;
+    
+    // Sleep per empty poll after yielding (zero keeps yielding)
+    std::chrono::microseconds sleep{0};
+    
+    // Policy that never gives up the core
+    static BackoffPolicy spin() {
+        return BackoffPolicy{UINT32_MAX, 0, std::chrono::microseconds(0)};
+    }
+};
+
+// Backoff state of one polling loop
+class Backoff {
+public:
+    // Constructor
+    explicit Backoff(BackoffPolicy policy = BackoffPolicy()) : policy_(policy), idle_polls_(0) {}
+    
+    // Wait after a poll that found no work
+    void idle() {
+        if (idle_polls_ < policy_.spin_iterations) {
+            cpu_relax();
+        } else if (idle_polls_ - policy_.spin_iterations < policy_.yield_iterations ||
+                   policy_.sleep.count() == 0) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(policy_.sleep);
+        }
+        
+        if (idle_polls_ != UINT32_MAX) {
+            idle_polls_++;
+        }
+    }
+    
+    // Start over after a poll that found work
+    void reset() { idle_polls_ = 0; }
+    
+    // Hint the CPU that we are spinning (frees pipeline resources for the
+    // sibling hyperthread and avoids a memory-order flush on exit)
+    static inline void cpu_relax() {
+        #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+            _mm_pause();
+        #elif defined(__aarch64__)
+            asm volatile("yield" ::: "memory");
+        #endif
+    }
+    
+private:
+    // Idle policy
+    BackoffPolicy policy_;
+    
+    // Consecutive polls without work
+    uint32_t idle_polls_;
+};
+
+} // namespace trading
\ No newline at end of file
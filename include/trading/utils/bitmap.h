@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace trading {
+
+// Two-level bitmap with constant-time set/clear and find-first-set searches
+// The summary level keeps one bit per non-empty 64-bit word, so a search only
+// touches a couple of words even when the bitmap holds thousands of bits
+class Bitmap {
+public:
+    // Sentinel returned when no set bit is found
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    
+    // Constructor
+    explicit Bitmap(size_t bits = 0) {
+        resize(bits);
+    }
+    
+    // Resize the bitmap (clears all bits)
+    void resize(size_t bits) {
+        bits_ = bits;
+        words_.assign((bits + 63) / 64, 0);
+        summary_.assign((words_.size() + 63) / 64, 0);
+    }
+    
+    // Clear all bits
+    void reset() {
+        std::fill(words_.begin(), words_.end(), 0);
+        std::fill(summary_.begin(), summary_.end(), 0);
+    }
+    
+    // Number of bits in the bitmap
+    size_t size() const { return bits_; }
+    
+    // Set a bit
+    void set(size_t bit) {
+        size_t word = bit >> 6;
+        words_[word] |= uint64_t{1} << (bit & 63);
+        summary_[word >> 6] |= uint64_t{1} << (word & 63);
+    }
+    
+    // Clear a bit
+    void clear(size_t bit) {
+        size_t word = bit >> 6;
+        words_[word] &= ~(uint64_t{1} << (bit & 63));
+        if (words_[word] == 0) {
+            summary_[word >> 6] &= ~(uint64_t{1} << (word & 63));
+        }
+    }
+    
+    // Test a bit
+    bool test(size_t bit) const {
+        return (words_[bit >> 6] >> (bit & 63)) & 1;
+    }
+    
+    // Check if any bit is set
+    bool any() const {
+        for (uint64_t s : summary_) {
+            if (s != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Count the set bits
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : words_) {
+            total += static_cast<size_t>(std::popcount(w));
+        }
+        return total;
+    }
+    
+    // Lowest set bit
+    size_t find_first() const {
+        return bits_ == 0 ? npos : find_next(0);
+    }
+    
+    // Highest set bit
+    size_t find_last() const {
+        return bits_ == 0 ? npos : find_prev(bits_ - 1);
+    }
+    
+    // Lowest set bit at or above 'from'
+    size_t find_next(size_t from) const {
+        if (from >= bits_) {
+            return npos;
+        }
+        
+        size_t word = from >> 6;
+        uint64_t bits = words_[word] & (~uint64_t{0} << (from & 63));
+        if (bits != 0) {
+            return (word << 6) + static_cast<size_t>(std::countr_zero(bits));
+        }
+        
+        // Search the summary for the next non-empty word
+        size_t next_word = word + 1;
+        for (size_t s = next_word >> 6; s < summary_.size(); ++s) {
+            uint64_t mask = summary_[s];
+            if (s == (next_word >> 6)) {
+                mask &= (next_word & 63) == 0 ? ~uint64_t{0} : (~uint64_t{0} << (next_word & 63));
+            }
+            if (mask != 0) {
+                size_t w = (s << 6) + static_cast<size_t>(std::countr_zero(mask));
+                return (w << 6) + static_cast<size_t>(std::countr_zero(words_[w]));
+            }
+        }
+        
+        return npos;
+    }
+    
+    // Highest set bit at or below 'from'
+    size_t find_prev(size_t from) const {
+        if (bits_ == 0) {
+            return npos;
+        }
+        if (from >= bits_) {
+            from = bits_ - 1;
+        }
+        
+        size_t word = from >> 6;
+        uint64_t bits = words_[word] & (~uint64_t{0} >> (63 - (from & 63)));
+        if (bits != 0) {
+            return (word << 6) + 63 - static_cast<size_t>(std::countl_zero(bits));
+        }
+        
+        if (word == 0) {
+            return npos;
+        }
+        
+        // Search the summary for the previous non-empty word
+        size_t prev_word = word - 1;
+        for (size_t s = (prev_word >> 6) + 1; s-- > 0;) {
+            uint64_t mask = summary_[s];
+            if (s == (prev_word >> 6)) {
+                mask &= ~uint64_t{0} >> (63 - (prev_word & 63));
+            }
+            if (mask != 0) {
+                size_t w = (s << 6) + 63 - static_cast<size_t>(std::countl_zero(mask));
+                return (w << 6) + 63 - static_cast<size_t>(std::countl_zero(words_[w]));
+            }
+        }
+        
+        return npos;
+    }
+    
+private:
+    // Bit storage
+    std::vector<uint64_t> words_;
+    
+    // One bit per non-empty word
+    std::vector<uint64_t> summary_;
+    
+    // Number of bits
+    size_t bits_ = 0;
+};
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,487 @@
+#pragma once
+
+#include "trading/utils/page_allocator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace trading {
+
+// Memory layout of a ConcurrentMemoryPool
+struct PoolConfig {
+    // Bytes per block (rounded down to a power-of-two number of slots)
+    size_t block_bytes = 2 * 1024 * 1024;
+    
+    // Back blocks with huge pages (explicit, falling back to transparent)
+    bool huge_pages = false;
+    
+    // Touch every page of a block when it is mapped
+    bool prefault = false;
+    
+    // Objects to reserve at construction
+    size_t initial_objects = 0;
+};
+
+// Usage counters of a ConcurrentMemoryPool (a racy but consistent-enough snapshot)
+struct PoolStats {
+    size_t blocks = 0;            // Mapped blocks
+    size_t huge_page_blocks = 0;  // Blocks backed by explicit huge pages
+    size_t capacity = 0;          // Slots in all blocks
+    size_t in_use = 0;            // Slots handed out and not yet returned
+    size_t cached = 0;            // Free slots held in thread caches
+    uint64_t allocations = 0;     // Successful allocations
+    uint64_t deallocations = 0;   // Deallocations
+    uint64_t refills = 0;         // Batches taken from the shared stack
+    uint64_t spills = 0;          // Batches returned to the shared stack
+};
+
+namespace detail {
+
+// Process-wide index of the calling thread into per-pool cache arrays
+// Indices are handed out from a bitmap on a thread's first use and given
+// back when it exits, so a pool needs a fixed number of caches no matter how
+// many threads come and go. A thread that finds the bitmap full gets
+// NO_THREAD_CACHE and uses the shared stack directly.
+class ThreadCacheRegistry {
+public:
+    // Maximum number of threads with a cache
+    static constexpr size_t MAX_THREADS = 128;
+    
+    // Index of a thread without a cache
+    static constexpr size_t NO_THREAD_CACHE = MAX_THREADS;
+    
+    // Cache index of the calling thread
+    static size_t current() {
+        thread_local const Holder holder;
+        return holder.index;
+    }
+    
+private:
+    // Bits per bitmap word
+    static constexpr size_t WORD_BITS = 64;
+    
+    // Claimed indices
+    inline static std::array<std::atomic<uint64_t>, MAX_THREADS / WORD_BITS> used_{};
+    
+    // Claims an index for the lifetime of a thread
+    struct Holder {
+        size_t index;
+        
+        Holder() : index(acquire()) {}
+        ~Holder() { release(index); }
+    };
+    
+    // Claim the lowest free index
+    static size_t acquire() {
+        for (size_t word = 0; word < used_.size(); ++word) {
+            uint64_t bits = used_[word].load(std::memory_order_relaxed);
+            while (bits != UINT64_MAX) {
+                uint64_t lowest = ~bits & (bits + 1);
+                if (used_[word].compare_exchange_weak(bits, bits | lowest, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    return word * WORD_BITS + static_cast<size_t>(__builtin_ctzll(lowest));
+                }
+            }
+        }
+        return NO_THREAD_CACHE;
+    }
+    
+    // Give an index back (its caches pass to the next thread that claims it)
+    static void release(size_t index) {
+        if (index == NO_THREAD_CACHE) {
+            return;
+        }
+        used_[index / WORD_BITS].fetch_and(~(uint64_t(1) << (index % WORD_BITS)), std::memory_order_release);
+    }
+};
+
+} // namespace detail
+
+// A fixed-size memory pool that any number of threads can allocate from and
+// free to concurrently
+// Each thread keeps a small cache of free slots and only touches shared state
+// to take or return a whole batch of BatchSize slots, so the steady-state
+// cost of an allocation is a few loads and stores on a thread-private cache
+// line. Batches live on a Treiber stack whose head packs a version tag with
+// the slot index; the tag is bumped on every update, so a head that was
+// popped and pushed back in between cannot be mistaken for the one a CAS
+// read (ABA). Free-list links live in a slot header outside the object, so
+// they are never overwritten by user data, and blocks are never unmapped
+// while the pool is alive, so a stale link read by a losing CAS is harmless.
+// Blocks come from the page allocator and can be backed by huge pages and
+// pre-faulted to keep page faults off the hot path.
+// Objects may be freed by a different thread than the one that allocated
+// them; the slot simply joins the freeing thread's cache.
+template<typename T, size_t BatchSize = 32>
+class ConcurrentMemoryPool {
+    static_assert(BatchSize > 0, "Batches must hold at least one slot");
+    static_assert(alignof(T) <= 4096, "Slots are aligned within page-aligned blocks");
+    
+public:
+    // Constructor
+    explicit ConcurrentMemoryPool(PoolConfig config = PoolConfig()) : config_(config),
+                                                                      slot_shift_(0),
+                                                                      block_count_(0),
+                                                                      huge_page_blocks_(0),
+                                                                      shared_allocations_(0),
+                                                                      shared_deallocations_(0),
+                                                                      stack_head_(0) {
+        size_t slots = std::max<size_t>(config_.block_bytes / slot_stride(), 1);
+        while ((size_t(2) << slot_shift_) <= slots) {
+            slot_shift_++;
+        }
+        
+        // Map the first block up front, like MemoryPool
+        reserve(std::max<size_t>(config_.initial_objects, 1));
+    }
+    
+    ConcurrentMemoryPool(const ConcurrentMemoryPool&) = delete;
+    ConcurrentMemoryPool& operator=(const ConcurrentMemoryPool&) = delete;
+    
+    // Destructor (objects still allocated are not destroyed)
+    ~ConcurrentMemoryPool() {
+        size_t blocks = block_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < blocks; ++i) {
+            free_pages(blocks_[i]);
+        }
+    }
+    
+    // Allocate memory for an object (nullptr if no block could be mapped)
+    void* allocate() {
+        size_t thread = detail::ThreadCacheRegistry::current();
+        if (thread == detail::ThreadCacheRegistry::NO_THREAD_CACHE) {
+            return allocate_shared();
+        }
+        
+        ThreadCache& cache = caches_[thread];
+        uint32_t count = cache.count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            count = refill(cache);
+            if (count == 0) {
+                return nullptr;
+            }
+        }
+        
+        count--;
+        cache.count.store(count, std::memory_order_relaxed);
+        bump(cache.allocations);
+        return storage(slot_at(cache.items[count]));
+    }
+    
+    // Deallocate memory for an object
+    void deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        
+        uint32_t index = header(ptr)->index;
+        size_t thread = detail::ThreadCacheRegistry::current();
+        if (thread == detail::ThreadCacheRegistry::NO_THREAD_CACHE) {
+            header_at(index)->next.store(0, std::memory_order_relaxed);
+            push_batch(index);
+            shared_deallocations_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        
+        ThreadCache& cache = caches_[thread];
+        uint32_t count = cache.count.load(std::memory_order_relaxed);
+        if (count == CACHE_CAPACITY) {
+            count = spill(cache);
+        }
+        
+        cache.items[count] = index;
+        cache.count.store(count + 1, std::memory_order_relaxed);
+        bump(cache.deallocations);
+    }
+    
+    // Pre-allocate blocks for at least a number of additional objects
+    // Returns false if a block could not be mapped
+    bool reserve(size_t count) {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        for (size_t slots = 0; slots < count; slots += slots_per_block()) {
+            if (!grow()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Create a default-constructed object (nullptr if the pool is exhausted)
+    T* get() {
+        void* ptr = allocate();
+        return ptr ? new(ptr) T() : nullptr;
+    }
+    
+    // Destroy an object from get()
+    void release(T* ptr) {
+        if (!ptr) {
+            return;
+        }
+        
+        ptr->~T();
+        deallocate(ptr);
+    }
+    
+    // Create an object with arguments (nullptr if the pool is exhausted)
+    template<typename... Args>
+    T* create(Args&&... args) {
+        void* ptr = allocate();
+        return ptr ? new(ptr) T(std::forward<Args>(args)...) : nullptr;
+    }
+    
+    // Destroy an object from create()
+    void destroy(T* ptr) {
+        release(ptr);
+    }
+    
+    // Usage counters
+    PoolStats stats() const {
+        PoolStats stats;
+        stats.blocks = block_count_.load(std::memory_order_acquire);
+        stats.huge_page_blocks = huge_page_blocks_.load(std::memory_order_relaxed);
+        stats.capacity = stats.blocks * slots_per_block();
+        stats.allocations = shared_allocations_.load(std::memory_order_relaxed);
+        stats.deallocations = shared_deallocations_.load(std::memory_order_relaxed);
+        
+        for (const ThreadCache& cache : caches_) {
+            stats.cached += cache.count.load(std::memory_order_relaxed);
+            stats.allocations += cache.allocations.load(std::memory_order_relaxed);
+            stats.deallocations += cache.deallocations.load(std::memory_order_relaxed);
+            stats.refills += cache.refills.load(std::memory_order_relaxed);
+            stats.spills += cache.spills.load(std::memory_order_relaxed);
+        }
+        
+        stats.in_use = stats.allocations >= stats.deallocations
+                     ? static_cast<size_t>(stats.allocations - stats.deallocations) : 0;
+        return stats;
+    }
+    
+    // Number of slots in a block
+    size_t slots_per_block() const { return size_t(1) << slot_shift_; }
+    
+    // Bytes per slot (header plus object, suitably aligned)
+    static constexpr size_t slot_stride() {
+        return round_up(STORAGE_OFFSET + sizeof(T), SLOT_ALIGNMENT);
+    }
+    
+private:
+    // Free-list links of a slot (kept apart from the object)
+    struct SlotHeader {
+        uint32_t index;                    // Slot index, fixed when the block is carved
+        std::atomic<uint32_t> next;        // Next slot in the batch (index + 1, 0 ends it)
+        std::atomic<uint32_t> batch_next;  // First slot of the next batch on the stack
+    };
+    
+    // Free slots held by one thread
+    struct alignas(64) ThreadCache {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> deallocations{0};
+        std::atomic<uint64_t> refills{0};
+        std::atomic<uint64_t> spills{0};
+        uint32_t items[2 * BatchSize];
+    };
+    
+    // Slots a thread cache can hold before it spills a batch
+    static constexpr uint32_t CACHE_CAPACITY = 2 * BatchSize;
+    
+    // Maximum number of blocks
+    static constexpr size_t MAX_BLOCKS = 1024;
+    
+    // Alignment of a slot
+    static constexpr size_t SLOT_ALIGNMENT = alignof(T) > alignof(SlotHeader) ? alignof(T) : alignof(SlotHeader);
+    
+    // Offset of the object within a slot
+    static constexpr size_t STORAGE_OFFSET = (sizeof(SlotHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+    
+    // Configuration
+    PoolConfig config_;
+    
+    // log2 of slots_per_block()
+    size_t slot_shift_;
+    
+    // Mapped blocks (only the first block_count_ are valid)
+    std::array<PageAllocation, MAX_BLOCKS> blocks_;
+    std::atomic<size_t> block_count_;
+    std::atomic<size_t> huge_page_blocks_;
+    
+    // Serializes block growth
+    std::mutex grow_mutex_;
+    
+    // Counters of threads without a cache
+    std::atomic<uint64_t> shared_allocations_;
+    std::atomic<uint64_t> shared_deallocations_;
+    
+    // Head of the batch stack: version tag (high 32 bits), first slot index + 1 (low 32 bits)
+    alignas(64) std::atomic<uint64_t> stack_head_;
+    
+    // Per-thread caches, indexed by ThreadCacheRegistry::current()
+    std::array<ThreadCache, detail::ThreadCacheRegistry::MAX_THREADS> caches_;
+    
+    // Round up to a multiple of a power-of-two alignment
+    static constexpr size_t round_up(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    
+    // Increment a counter only its owning thread writes
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    // Address of a slot (valid once the slot has been published)
+    unsigned char* slot_at(uint32_t index) const {
+        const PageAllocation& block = blocks_[index >> slot_shift_];
+        size_t offset = (index & (slots_per_block() - 1)) * slot_stride();
+        return static_cast<unsigned char*>(block.memory) + offset;
+    }
+    
+    // Header of a slot by index
+    SlotHeader* header_at(uint32_t index) const {
+        return std::launder(reinterpret_cast<SlotHeader*>(slot_at(index)));
+    }
+    
+    // Header of a slot by object address
+    static SlotHeader* header(void* ptr) {
+        return std::launder(reinterpret_cast<SlotHeader*>(static_cast<unsigned char*>(ptr) - STORAGE_OFFSET));
+    }
+    
+    // Object storage of a slot
+    static void* storage(unsigned char* slot) {
+        return slot + STORAGE_OFFSET;
+    }
+    
+    // Push a linked batch whose first slot is index
+    void push_batch(uint32_t index) {
+        SlotHeader* first = header_at(index);
+        uint64_t head = stack_head_.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            first->batch_next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            desired = ((head >> 32) + 1) << 32 | (uint64_t(index) + 1);
+        } while (!stack_head_.compare_exchange_weak(head, desired, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+    }
+    
+    // Pop a batch, returning the index of its first slot + 1 (0 if the stack is empty)
+    uint32_t pop_batch() {
+        uint64_t head = stack_head_.load(std::memory_order_acquire);
+        while (static_cast<uint32_t>(head) != 0) {
+            uint32_t first = static_cast<uint32_t>(head) - 1;
+            uint32_t next = header_at(first)->batch_next.load(std::memory_order_relaxed);
+            uint64_t desired = ((head >> 32) + 1) << 32 | next;
+            if (stack_head_.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                                  std::memory_order_acquire)) {
+                return first + 1;
+            }
+        }
+        return 0;
+    }
+    
+    // Pop a batch, growing the pool if the stack is empty (0 if growth failed)
+    uint32_t pop_or_grow() {
+        uint32_t batch = pop_batch();
+        while (batch == 0) {
+            std::lock_guard<std::mutex> lock(grow_mutex_);
+            
+            // Another thread may have grown the pool while we waited
+            batch = pop_batch();
+            if (batch == 0) {
+                if (!grow()) {
+                    return 0;
+                }
+                batch = pop_batch();
+            }
+        }
+        return batch;
+    }
+    
+    // Move a batch from the stack into an empty thread cache
+    uint32_t refill(ThreadCache& cache) {
+        uint32_t link = pop_or_grow();
+        if (link == 0) {
+            return 0;
+        }
+        
+        uint32_t count = 0;
+        while (link != 0) {
+            cache.items[count++] = link - 1;
+            link = header_at(link - 1)->next.load(std::memory_order_relaxed);
+        }
+        
+        bump(cache.refills);
+        return count;
+    }
+    
+    // Move BatchSize slots from a full thread cache to the stack
+    uint32_t spill(ThreadCache& cache) {
+        uint32_t count = CACHE_CAPACITY;
+        uint32_t link = 0;
+        for (size_t i = 0; i < BatchSize; ++i) {
+            uint32_t index = cache.items[--count];
+            header_at(index)->next.store(link, std::memory_order_relaxed);
+            link = index + 1;
+        }
+        push_batch(link - 1);
+        
+        bump(cache.spills);
+        return count;
+    }
+    
+    // Allocate without a thread cache: take one slot of a batch, return the rest
+    void* allocate_shared() {
+        uint32_t link = pop_or_grow();
+        if (link == 0) {
+            return nullptr;
+        }
+        
+        SlotHeader* first = header_at(link - 1);
+        uint32_t rest = first->next.load(std::memory_order_relaxed);
+        if (rest != 0) {
+            push_batch(rest - 1);
+        }
+        
+        shared_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return storage(slot_at(link - 1));
+    }
+    
+    // Map a block and push its slots in batches (caller holds grow_mutex_)
+    bool grow() {
+        size_t block = block_count_.load(std::memory_order_relaxed);
+        if (block == MAX_BLOCKS || ((block + 1) << slot_shift_) > UINT32_MAX) {
+            return false;
+        }
+        
+        PageAllocation allocation = allocate_pages(slots_per_block() * slot_stride(), config_.huge_pages,
+                                                   config_.prefault);
+        if (!allocation.memory) {
+            return false;
+        }
+        
+        blocks_[block] = allocation;
+        block_count_.store(block + 1, std::memory_order_release);
+        if (allocation.huge_pages) {
+            huge_page_blocks_.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        // Carve the block into linked batches
+        uint32_t base = static_cast<uint32_t>(block << slot_shift_);
+        for (size_t start = 0; start < slots_per_block(); start += BatchSize) {
+            size_t end = std::min(start + BatchSize, slots_per_block());
+            for (size_t i = start; i < end; ++i) {
+                uint32_t index = base + static_cast<uint32_t>(i);
+                uint32_t next = i + 1 < end ? index + 2 : 0;
+                ::new(slot_at(index)) SlotHeader{index, {next}, {0}};
+            }
+            push_batch(base + static_cast<uint32_t>(start));
+        }
+        return true;
+    }
+};
+
+} // namespace trading
\ No newline at end of file
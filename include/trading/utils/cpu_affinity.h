@@ -0,0 +1,18 @@
+#pragma once
+
+#include <thread>
+
+namespace trading {
+
+// Pin the calling thread to a CPU core
+// Returns false if the platform does not support pinning or the call fails
+bool pin_current_thread(int cpu);
+
+// Pin a thread to a CPU core
+// Returns false if the platform does not support pinning or the call fails
+bool pin_thread(std::thread& thread, int cpu);
+
+// Get the number of online CPU cores
+unsigned int cpu_count();
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+
+namespace trading {
+
+// Power of ten as a 64-bit integer
+constexpr int64_t pow10_i64(int exponent) {
+    int64_t value = 1;
+    for (int i = 0; i < exponent; ++i) {
+        value *= 10;
+    }
+    return value;
+}
+
+// Rounding of a value that falls between two representable ones
+enum class Rounding : uint8_t {
+    DOWN,     // Towards negative infinity
+    UP,       // Towards positive infinity
+    NEAREST   // To the nearer one, halves away from zero
+};
+
+// Signed decimal fixed-point number with a compile-time scale
+// The value is raw() / 10^Decimals held in an int64_t, so a FixedPoint<2>
+// counts cents. Arithmetic between values of one scale stays in integer ALU
+// ops; mixing scales needs an explicit rescale(), so a price in cents can
+// never be added to one in hundredths of a cent by accident. The operators
+// assume the operands are in range (prices and spreads are nowhere near
+// 2^63); the checked_* functions detect overflow and return nullopt instead.
+template<int Decimals>
+class FixedPoint {
+    static_assert(Decimals >= 0 && Decimals <= 17, "FixedPoint supports 0 to 17 decimals");
+    
+public:
+    // Digits after the decimal point
+    static constexpr int decimals = Decimals;
+    
+    // Raw units per whole number
+    static constexpr int64_t scale = pow10_i64(Decimals);
+    
+    // Zero
+    constexpr FixedPoint() = default;
+    
+    // Make a value from raw units
+    static constexpr FixedPoint from_raw(int64_t raw) { return FixedPoint(raw); }
+    
+    // Make a value from a whole number (nullopt if out of range)
+    static constexpr std::optional<FixedPoint> from_integer(int64_t value) {
+        int64_t raw;
+        if (__builtin_mul_overflow(value, scale, &raw)) {
+            return std::nullopt;
+        }
+        return FixedPoint(raw);
+    }
+    
+    // Make a value from a double, rounded to the nearest raw unit
+    // (configuration and display only; nullopt if not finite or out of range)
+    static std::optional<FixedPoint> from_double(double value) {
+        double raw = std::round(value * static_cast<double>(scale));
+        if (!std::isfinite(raw) || raw < -9.2e18 || raw > 9.2e18) {
+            return std::nullopt;
+        }
+        return FixedPoint(static_cast<int64_t>(raw));
+    }
+    
+    // Get the raw units
+    constexpr int64_t raw() const { return raw_; }
+    
+    // Convert to double (for statistics that need it, e.g. logarithms)
+    constexpr double to_double() const { return static_cast<double>(raw_) / static_cast<double>(scale); }
+    
+    // Arithmetic within one scale
+    constexpr FixedPoint operator+(FixedPoint other) const { return FixedPoint(raw_ + other.raw_); }
+    constexpr FixedPoint operator-(FixedPoint other) const { return FixedPoint(raw_ - other.raw_); }
+    constexpr FixedPoint operator-() const { return FixedPoint(-raw_); }
+    constexpr FixedPoint operator*(int64_t factor) const { return FixedPoint(raw_ * factor); }
+    constexpr FixedPoint& operator+=(FixedPoint other) { raw_ += other.raw_; return *this; }
+    constexpr FixedPoint& operator-=(FixedPoint other) { raw_ -= other.raw_; return *this; }
+    
+    // Comparisons
+    constexpr auto operator<=>(const FixedPoint&) const = default;
+    
+    // Overflow-checked arithmetic (nullopt on overflow)
+    constexpr std::optional<FixedPoint> checked_add(FixedPoint other) const {
+        int64_t raw;
+        if (__builtin_add_overflow(raw_, other.raw_, &raw)) {
+            return std::nullopt;
+        }
+        return FixedPoint(raw);
+    }
+    
+    constexpr std::optional<FixedPoint> checked_sub(FixedPoint other) const {
+        int64_t raw;
+        if (__builtin_sub_overflow(raw_, other.raw_, &raw)) {
+            return std::nullopt;
+        }
+        return FixedPoint(raw);
+    }
+    
+    constexpr std::optional<FixedPoint> checked_mul(int64_t factor) const {
+        int64_t raw;
+        if (__builtin_mul_overflow(raw_, factor, &raw)) {
+            return std::nullopt;
+        }
+        return FixedPoint(raw);
+    }
+    
+    // Convert to another scale, rounding when digits are dropped
+    // (nullopt if the value does not fit the new scale)
+    template<int ToDecimals>
+    constexpr std::optional<FixedPoint<ToDecimals>> rescale(Rounding rounding = Rounding::NEAREST) const {
+        if constexpr (ToDecimals >= Decimals) {
+            int64_t raw;
+            if (__builtin_mul_overflow(raw_, pow10_i64(ToDecimals - Decimals), &raw)) {
+                return std::nullopt;
+            }
+            return FixedPoint<ToDecimals>::from_raw(raw);
+        } else {
+            return FixedPoint<ToDecimals>::from_raw(divide(raw_, pow10_i64(Decimals - ToDecimals), rounding));
+        }
+    }
+    
+    // Round to a multiple of a tick (tick must be positive)
+    constexpr FixedPoint round_to_tick(FixedPoint tick, Rounding rounding = Rounding::NEAREST) const {
+        return FixedPoint(divide(raw_, tick.raw_, rounding) * tick.raw_);
+    }
+    
+    // Check if the value is a multiple of a tick (tick must be positive)
+    constexpr bool on_tick(FixedPoint tick) const { return raw_ % tick.raw_ == 0; }
+    
+    // Exact midpoint of two values, one digit finer so half units survive
+    // (the truncating (a + b) / 2 loses them)
+    static constexpr FixedPoint<Decimals + 1> midpoint(FixedPoint a, FixedPoint b) {
+        __extension__ using int128 = __int128;
+        return FixedPoint<Decimals + 1>::from_raw(static_cast<int64_t>((static_cast<int128>(a.raw_) + b.raw_) * 5));
+    }
+    
+    // Ratio a / b at a chosen scale, rounded (b must not be zero)
+    // One 128-bit multiply and divide, no floating point
+    template<int RatioDecimals>
+    static constexpr FixedPoint<RatioDecimals> ratio(FixedPoint a, FixedPoint b, Rounding rounding = Rounding::NEAREST) {
+        __extension__ using int128 = __int128;
+        const int128 numerator = static_cast<int128>(a.raw_) * pow10_i64(RatioDecimals);
+        return FixedPoint<RatioDecimals>::from_raw(static_cast<int64_t>(divide(numerator, static_cast<int128>(b.raw_), rounding)));
+    }
+    
+    // Mean of a run of values, rounded (zero if empty)
+    // Sums in 128 bits, so no run of int64 values can overflow it
+    static constexpr FixedPoint mean(std::span<const FixedPoint> values, Rounding rounding = Rounding::NEAREST) {
+        __extension__ using int128 = __int128;
+        if (values.empty()) {
+            return FixedPoint();
+        }
+        int128 sum = 0;
+        for (FixedPoint value : values) {
+            sum += value.raw_;
+        }
+        return FixedPoint(static_cast<int64_t>(divide(sum, static_cast<int128>(values.size()), rounding)));
+    }
+    
+private:
+    // Raw units
+    int64_t raw_ = 0;
+    
+    constexpr explicit FixedPoint(int64_t raw) : raw_(raw) {}
+    
+    // Integer division with the given rounding (divisor non-zero)
+    template<typename Int>
+    static constexpr Int divide(Int numerator, Int divisor, Rounding rounding) {
+        if (divisor < 0) {
+            numerator = -numerator;
+            divisor = -divisor;
+        }
+        Int quotient = numerator / divisor;
+        Int remainder = numerator % divisor;
+        if (remainder == 0) {
+            return quotient;
+        }
+        switch (rounding) {
+            case Rounding::DOWN:
+                return remainder < 0 ? quotient - 1 : quotient;
+            case Rounding::UP:
+                return remainder > 0 ? quotient + 1 : quotient;
+            case Rounding::NEAREST:
+                if (remainder > 0) {
+                    return 2 * remainder >= divisor ? quotient + 1 : quotient;
+                }
+                return -2 * remainder >= divisor ? quotient - 1 : quotient;
+        }
+        return quotient;
+    }
+    
+    template<int>
+    friend class FixedPoint;
+};
+
+// Decimal scale and tick size of an instrument class
+// Book prices (Price) are raw units of the instrument's class, so a book
+// price converts with Price::from_raw() and back with raw().
+template<int Decimals, int64_t TickUnits = 1>
+struct InstrumentClass {
+    static_assert(TickUnits > 0, "The tick must be positive");
+    
+    // Price type of the class
+    using Value = FixedPoint<Decimals>;
+    
+    // Minimum price increment
+    static constexpr Value tick = Value::from_raw(TickUnits);
+    
+    // Round a price to the tick
+    static constexpr Value round(Value price, Rounding rounding = Rounding::NEAREST) {
+        return price.round_to_tick(tick, rounding);
+    }
+};
+
+// Instrument classes
+using EquityClass = InstrumentClass<2>;      // Cents with a one-cent tick (the native feed)
+using FxClass = InstrumentClass<5>;          // Fifth decimal (pipettes)
+using FuturesClass = InstrumentClass<2, 25>; // Quarter-point tick
+
+} // namespace trading
\ No newline at end of file
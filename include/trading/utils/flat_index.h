@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace trading {
+
+// Flat open-addressing hash index from 64-bit keys to small values
+// Uses linear probing with backward-shift deletion, so there are no tombstones
+// and lookups stay short under heavy insert/erase churn. Key 0 is reserved
+// as the empty marker.
+template<typename Value>
+class FlatIndex {
+public:
+    // Constructor
+    explicit FlatIndex(size_t initial_capacity = 1024) {
+        size_t capacity = 16;
+        while (capacity < initial_capacity) {
+            capacity *= 2;
+        }
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+    
+    // Find the value for a key (nullptr if not present)
+    Value* find(uint64_t key) {
+        for (size_t i = hash(key) & mask_;; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) {
+                return &slots_[i].value;
+            }
+            if (slots_[i].key == 0) {
+                return nullptr;
+            }
+        }
+    }
+    
+    // Find the value for a key (nullptr if not present)
+    const Value* find(uint64_t key) const {
+        return const_cast<FlatIndex*>(this)->find(key);
+    }
+    
+    // Insert a key/value pair
+    // Returns false if the key is reserved or already present
+    bool insert(uint64_t key, Value value) {
+        if (key == 0) {
+            return false;
+        }
+        
+        // Keep the load factor at or below one half
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+        
+        size_t i = hash(key) & mask_;
+        for (; slots_[i].key != 0; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) {
+                return false;
+            }
+        }
+        
+        slots_[i].key = key;
+        slots_[i].value = std::move(value);
+        ++size_;
+        return true;
+    }
+    
+    // Erase a key
+    // Returns false if the key is not present
+    bool erase(uint64_t key) {
+        if (key == 0) {
+            return false;
+        }
+        
+        size_t i = hash(key) & mask_;
+        for (; slots_[i].key != key; i = (i + 1) & mask_) {
+            if (slots_[i].key == 0) {
+                return false;
+            }
+        }
+        
+        // Shift following entries of the probe run back into the hole
+        for (size_t j = (i + 1) & mask_; slots_[j].key != 0; j = (j + 1) & mask_) {
+            size_t home = hash(slots_[j].key) & mask_;
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                slots_[i] = std::move(slots_[j]);
+                i = j;
+            }
+        }
+        
+        slots_[i].key = 0;
+        slots_[i].value = Value();
+        --size_;
+        return true;
+    }
+    
+    // Make room for a number of keys without rehashing
+    void reserve(size_t count) {
+        size_t capacity = slots_.size();
+        while (count * 2 > capacity) {
+            capacity *= 2;
+        }
+        if (capacity != slots_.size()) {
+            rehash(capacity);
+        }
+    }
+    
+    // Remove all keys (keeps capacity)
+    void clear() {
+        for (auto& slot : slots_) {
+            slot = Slot();
+        }
+        size_ = 0;
+    }
+    
+    // Number of keys
+    size_t size() const { return size_; }
+    
+    // Check if the index is empty
+    bool empty() const { return size_ == 0; }
+    
+    // Number of slots
+    size_t capacity() const { return slots_.size(); }
+    
+private:
+    // Slot in the table
+    struct Slot {
+        uint64_t key = 0;
+        Value value{};
+    };
+    
+    // Table of slots (power-of-two sized)
+    std::vector<Slot> slots_;
+    
+    // Capacity mask
+    size_t mask_ = 0;
+    
+    // Number of keys
+    size_t size_ = 0;
+    
+    // Mix the key bits (exchange IDs are often sequential or strided)
+    // Runs of four consecutive keys stay adjacent so sequential IDs share
+    // cache lines, while the runs themselves are scattered over the table
+    static size_t hash(uint64_t key) {
+        uint64_t run = key >> 2;
+        run ^= run >> 33;
+        run *= 0xff51afd7ed558ccdULL;
+        run ^= run >> 33;
+        return static_cast<size_t>((run << 2) | (key & 3));
+    }
+    
+    // Rebuild the table with a new capacity
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        mask_ = capacity - 1;
+        size_ = 0;
+        
+        for (auto& slot : old) {
+            if (slot.key != 0) {
+                size_t i = hash(slot.key) & mask_;
+                while (slots_[i].key != 0) {
+                    i = (i + 1) & mask_;
+                }
+                slots_[i] = std::move(slot);
+                ++size_;
+            }
+        }
+    }
+};
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trading {
+
+// Log-bucketed latency histogram (HdrHistogram layout)
+// Values below SUB_BUCKETS get a bucket each; above that, every power of two
+// is split into SUB_BUCKETS / 2 equal buckets, so a recorded value is known
+// to within 1/128 (under 0.8%) of itself. Memory is fixed at construction and
+// record() is a handful of loads and stores with no locked instructions.
+// Values above MAX_VALUE are counted in the top bucket (max() stays exact).
+//
+// A histogram has a single writer: record() uses plain relaxed loads and
+// stores, so give every recording thread its own instance and merge them for
+// reporting. Any thread may take a snapshot() while the owner records; the
+// copy may miss the samples recorded during the copy but is never corrupt.
+// interval() turns successive snapshots into per-interval histograms without
+// writing to the recording instance.
+class LatencyHistogram {
+public:
+    // Bits of precision per power of two
+    static constexpr unsigned SUB_BUCKET_BITS = 8;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+    
+    // Largest value kept apart from its neighbours (about 18 minutes in ns)
+    static constexpr unsigned MAX_VALUE_BITS = 40;
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+    
+    // Number of buckets
+    static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2) + SUB_BUCKETS;
+    
+    // Get the bucket of a value
+    static constexpr size_t bucket_of(uint64_t value) {
+        value = std::min(value, MAX_VALUE);
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = 63 - static_cast<unsigned>(__builtin_clzll(value)) - (SUB_BUCKET_BITS - 1);
+        return static_cast<size_t>(shift * (SUB_BUCKETS / 2) + (value >> shift));
+    }
+    
+    // Smallest value of a bucket
+    static constexpr uint64_t bucket_lowest(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        unsigned shift = static_cast<unsigned>(bucket / (SUB_BUCKETS / 2)) - 1;
+        return static_cast<uint64_t>(bucket - shift * (SUB_BUCKETS / 2)) << shift;
+    }
+    
+    // Largest value of a bucket
+    static constexpr uint64_t bucket_highest(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        unsigned shift = static_cast<unsigned>(bucket / (SUB_BUCKETS / 2)) - 1;
+        return bucket_lowest(bucket) + (uint64_t(1) << shift) - 1;
+    }
+    
+    // Constructor
+    LatencyHistogram() = default;
+    
+    // Copy (a snapshot of other)
+    LatencyHistogram(const LatencyHistogram& other) { copy_from(other); }
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            copy_from(other);
+        }
+        return *this;
+    }
+    
+    // Record a value (owner thread only)
+    void record(uint64_t value) {
+        add(buckets_[bucket_of(value)], 1);
+        add(count_, 1);
+        add(sum_, value);
+        if (value < min_.load(std::memory_order_relaxed)) [[unlikely]] {
+            min_.store(value, std::memory_order_relaxed);
+        }
+        if (value > max_.load(std::memory_order_relaxed)) [[unlikely]] {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+    
+    // Record a value n times (owner thread only)
+    void record(uint64_t value, uint64_t n);
+    
+    // Add the samples of another histogram (owner thread only; other may
+    // still be recording on its own thread)
+    void merge(const LatencyHistogram& other);
+    
+    // Remove the samples of an earlier snapshot of this histogram, leaving
+    // the samples recorded since (min and max become bucket bounds)
+    void subtract(const LatencyHistogram& earlier);
+    
+    // Copy the current samples (any thread)
+    LatencyHistogram snapshot() const { return LatencyHistogram(*this); }
+    
+    // Samples recorded since last was taken; last becomes the current snapshot
+    // (any thread, last is owned by the caller)
+    LatencyHistogram interval(LatencyHistogram& last) const;
+    
+    // Clear all samples (owner thread only)
+    void reset();
+    
+    // Get the number of samples
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    
+    // Get the smallest and largest sample (0 if empty)
+    uint64_t min() const { return count() > 0 ? min_.load(std::memory_order_relaxed) : 0; }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    
+    // Get the mean sample
+    double mean() const;
+    
+    // Get the value at quantile p (0 to 1): the largest value of the bucket
+    // holding the ceil(p * count)-th sample, clamped to [min, max]
+    uint64_t percentile(double p) const;
+    
+    // Get the number of samples in a bucket
+    uint64_t bucket_count(size_t bucket) const { return buckets_[bucket].load(std::memory_order_relaxed); }
+    
+    // Call visit(lowest, highest, count) for every non-empty bucket, in order
+    template<typename Visitor>
+    void for_each_bucket(Visitor&& visit) const {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+            if (n > 0) {
+                visit(bucket_lowest(i), bucket_highest(i), n);
+            }
+        }
+    }
+    
+    // Get summary statistics as string
+    std::string summary() const;
+    
+private:
+    // Samples per bucket
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    
+    // Totals
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+    
+    // Single-writer increment (no locked instruction)
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    
+    // Copy every counter of other
+    void copy_from(const LatencyHistogram& other);
+};
+
+} // namespace trading
\ No newline at end of file
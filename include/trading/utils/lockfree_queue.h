@@ -1,36 +1,73 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <optional>
 #include <type_traits>
+#include <utility>
 
 namespace trading {
 
 // A lock-free single-producer, single-consumer queue
+// Each side keeps a cached copy of the other side's position and only reloads
+// it when the cached value says the queue is full (producer) or empty
+// (consumer), so in steady state a push or pop touches no cache line written
+// by the other thread except the slot itself. The batch calls publish a whole
+// run of elements with one index store.
+// Capacity must be a power of two.
 template<typename T, size_t Capacity = 1024>
 class LockFreeQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "LockFreeQueue capacity must be a power of two");
+                  
 private:
     // Queue data structure
     struct alignas(64) {  // Cache line alignment
         // Buffer to hold elements
         std::aligned_storage_t<sizeof(T), alignof(T)> buffer[Capacity];
         
-        // Read and write positions
+        // Read position and the consumer's copy of the write position
         alignas(64) std::atomic<size_t> read_pos{0};  // Cache line alignment
+        size_t cached_write_pos = 0;
+        
+        // Write position and the producer's copy of the read position
         alignas(64) std::atomic<size_t> write_pos{0};  // Cache line alignment
+        size_t cached_read_pos = 0;
     } queue_;
     
     // Helper to get a reference to an element in the buffer
     T& at(size_t pos) {
-        return *reinterpret_cast<T*>(&queue_.buffer[pos % Capacity]);
+        return *reinterpret_cast<T*>(&queue_.buffer[pos & (Capacity - 1)]);
     }
     
     // Helper to get a const reference to an element in the buffer
     const T& at(size_t pos) const {
-        return *reinterpret_cast<const T*>(&queue_.buffer[pos % Capacity]);
+        return *reinterpret_cast<const T*>(&queue_.buffer[pos & (Capacity - 1)]);
+    }
+    
+    // Free slots for the producer (reloads the read position only if needed)
+    size_t writable(size_t write_pos, size_t wanted) {
+        size_t free_slots = Capacity - (write_pos - queue_.cached_read_pos);
+        if (free_slots < wanted) {
+            queue_.cached_read_pos = queue_.read_pos.load(std::memory_order_acquire);
+            free_slots = Capacity - (write_pos - queue_.cached_read_pos);
+        }
+        return free_slots;
+    }
+    
+    // Elements ready for the consumer (reloads the write position only if needed)
+    size_t readable(size_t read_pos, size_t wanted) {
+        size_t ready = queue_.cached_write_pos - read_pos;
+        if (ready < wanted) {
+            queue_.cached_write_pos = queue_.write_pos.load(std::memory_order_acquire);
+            ready = queue_.cached_write_pos - read_pos;
+        }
+        return ready;
     }
     
 public:
@@ -47,19 +84,19 @@ public:
         }
     }
     
-    // Try to push an element to the queue
+    // Try to construct an element at the back of the queue
     // Returns true if successful, false if the queue is full
-    bool try_push(const T& value) {
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
         size_t write_pos = queue_.write_pos.load(std::memory_order_relaxed);
-        size_t read_pos = queue_.read_pos.load(std::memory_order_acquire);
         
         // Check if the queue is full
-        if (write_pos - read_pos >= Capacity) {
+        if (writable(write_pos, 1) == 0) {
             return false;
         }
         
         // Construct the element in place
-        new (&queue_.buffer[write_pos % Capacity]) T(value);
+        new (&at(write_pos)) T(std::forward<Args>(args)...);
         
         // Update the write position
         queue_.write_pos.store(write_pos + 1, std::memory_order_release);
@@ -67,22 +104,50 @@ public:
         return true;
     }
     
+    // Try to push an element to the queue
+    // Returns true if successful, false if the queue is full
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+    
     // Try to push an element to the queue (move semantics)
     // Returns true if successful, false if the queue is full
     bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+    
+    // Try to push up to count elements with a single publication
+    // Returns the number of elements pushed (fewer if the queue fills up)
+    size_t try_push_n(const T* values, size_t count) {
         size_t write_pos = queue_.write_pos.load(std::memory_order_relaxed);
-        size_t read_pos = queue_.read_pos.load(std::memory_order_acquire);
+        size_t pushed = std::min(count, writable(write_pos, count));
         
-        // Check if the queue is full
-        if (write_pos - read_pos >= Capacity) {
+        for (size_t i = 0; i < pushed; ++i) {
+            new (&at(write_pos + i)) T(values[i]);
+        }
+        
+        if (pushed > 0) {
+            queue_.write_pos.store(write_pos + pushed, std::memory_order_release);
+        }
+        return pushed;
+    }
+    
+    // Try to pop an element from the queue
+    // Returns false if the queue is empty
+    bool try_pop(T& value) {
+        size_t read_pos = queue_.read_pos.load(std::memory_order_relaxed);
+        
+        // Check if the queue is empty
+        if (readable(read_pos, 1) == 0) {
             return false;
         }
         
-        // Construct the element in place
-        new (&queue_.buffer[write_pos % Capacity]) T(std::move(value));
+        // Move the element out and destroy it
+        value = std::move(at(read_pos));
+        at(read_pos).~T();
         
-        // Update the write position
-        queue_.write_pos.store(write_pos + 1, std::memory_order_release);
+        // Update the read position
+        queue_.read_pos.store(read_pos + 1, std::memory_order_release);
         
         return true;
     }
@@ -92,10 +157,9 @@ public:
     // Edit: I don't know yet if std::optional is the best choice regarding performance
     std::optional<T> try_pop() {
         size_t read_pos = queue_.read_pos.load(std::memory_order_relaxed);
-        size_t write_pos = queue_.write_pos.load(std::memory_order_acquire);
         
         // Check if the queue is empty
-        if (read_pos >= write_pos) {
+        if (readable(read_pos, 1) == 0) {
             return std::nullopt;
         }
         
@@ -111,6 +175,23 @@ public:
         return value;
     }
     
+    // Try to pop up to max_count elements, releasing their slots with a single store
+    // Returns the number of elements written to values
+    size_t try_pop_n(T* values, size_t max_count) {
+        size_t read_pos = queue_.read_pos.load(std::memory_order_relaxed);
+        size_t popped = std::min(max_count, readable(read_pos, max_count));
+        
+        for (size_t i = 0; i < popped; ++i) {
+            values[i] = std::move(at(read_pos + i));
+            at(read_pos + i).~T();
+        }
+        
+        if (popped > 0) {
+            queue_.read_pos.store(read_pos + popped, std::memory_order_release);
+        }
+        return popped;
+    }
+    
     // Get the number of elements in the queue
     size_t size() const {
         size_t write_pos = queue_.write_pos.load(std::memory_order_acquire);
@@ -128,9 +209,8 @@ public:
         return size() >= Capacity;
     }
     
-    // Clear the queue
+    // Clear the queue (consumer thread only)
     void clear() {
-        T value;
         while (try_pop()) {
             // Just pop and discard
         }
@@ -142,4 +222,350 @@ public:
     }
 };
 
+// A bounded lock-free multi-producer, multi-consumer queue
+// Vyukov's bounded queue with sequence numbers per cell: producers and
+// consumers each claim positions with a CAS on their own index and hand a
+// cell over by advancing its sequence, so neither side ever takes a lock.
+// The batch calls claim a run of ready cells with one CAS.
+// Capacity must be a power of two.
+template<typename T, size_t Capacity = 1024>
+class MpmcQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpmcQueue capacity must be a power of two");
+                  
+private:
+    // Queue cell
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+    };
+    
+    // Cells
+    Cell cells_[Capacity];
+    
+    // Next position to claim by producers
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    
+    // Next position to claim by consumers
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    
+    // Helper to get the element stored in a cell
+    static T* element(Cell& cell) {
+        return reinterpret_cast<T*>(&cell.storage);
+    }
+    
+    // Helper to get the cell of a position
+    Cell& cell_at(size_t pos) {
+        return cells_[pos & (Capacity - 1)];
+    }
+    
+    // Claim up to max_count consecutive cells whose sequence is pos + lag
+    // (lag 0: free for producers, lag 1: published for consumers)
+    // Returns the number claimed and their first position
+    size_t claim(std::atomic<size_t>& index, size_t lag, size_t max_count, size_t& first) {
+        size_t pos = index.load(std::memory_order_relaxed);
+        
+        for (;;) {
+            size_t count = 0;
+            while (count < max_count) {
+                size_t sequence = cell_at(pos + count).sequence.load(std::memory_order_acquire);
+                if (sequence != pos + count + lag) {
+                    break;
+                }
+                count++;
+            }
+            
+            if (count == 0) {
+                size_t sequence = cell_at(pos).sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + lag);
+                if (diff < 0) {
+                    return 0;  // Full (producers) or empty (consumers)
+                }
+                pos = index.load(std::memory_order_relaxed);  // Another thread won
+                continue;
+            }
+            
+            if (index.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                first = pos;
+                return count;
+            }
+        }
+    }
+    
+public:
+    // Constructor
+    MpmcQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    // Destructor - destroy any remaining elements
+    ~MpmcQueue() {
+        T value;
+        while (try_pop(value)) {
+            // Just pop and discard
+        }
+    }
+    
+    // Try to construct an element at the back of the queue
+    // Returns true if successful, false if the queue is full
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos;
+        if (claim(enqueue_pos_, 0, 1, pos) == 0) {
+            return false;
+        }
+        
+        // Construct the element and publish the cell to consumers
+        Cell& cell = cell_at(pos);
+        new (&cell.storage) T(std::forward<Args>(args)...);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Try to push an element to the queue
+    // Returns true if successful, false if the queue is full
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+    
+    // Try to push an element to the queue (move semantics)
+    // Returns true if successful, false if the queue is full
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+    
+    // Try to push up to count elements claimed with a single CAS
+    // Returns the number of elements pushed
+    size_t try_push_n(const T* values, size_t count) {
+        size_t pos;
+        size_t pushed = count > 0 ? claim(enqueue_pos_, 0, count, pos) : 0;
+        
+        for (size_t i = 0; i < pushed; ++i) {
+            Cell& cell = cell_at(pos + i);
+            new (&cell.storage) T(values[i]);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return pushed;
+    }
+    
+    // Try to pop an element from the queue
+    // Returns false if the queue is empty
+    bool try_pop(T& value) {
+        size_t pos;
+        if (claim(dequeue_pos_, 1, 1, pos) == 0) {
+            return false;
+        }
+        
+        // Move the element out and hand the cell back to producers
+        Cell& cell = cell_at(pos);
+        value = std::move(*element(cell));
+        element(cell)->~T();
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        return true;
+    }
+    
+    // Try to pop an element from the queue
+    // Returns the element if successful, nullopt if the queue is empty
+    std::optional<T> try_pop() {
+        T value;
+        if (!try_pop(value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+    
+    // Try to pop up to max_count elements claimed with a single CAS
+    // Returns the number of elements written to values
+    size_t try_pop_n(T* values, size_t max_count) {
+        size_t pos;
+        size_t popped = max_count > 0 ? claim(dequeue_pos_, 1, max_count, pos) : 0;
+        
+        for (size_t i = 0; i < popped; ++i) {
+            Cell& cell = cell_at(pos + i);
+            values[i] = std::move(*element(cell));
+            element(cell)->~T();
+            cell.sequence.store(pos + i + Capacity, std::memory_order_release);
+        }
+        return popped;
+    }
+    
+    // Get the (approximate) number of elements in the queue
+    size_t size() const {
+        size_t enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+        size_t dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+    
+    // Check if the queue is empty
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    // Get the capacity of the queue
+    size_t capacity() const {
+        return Capacity;
+    }
+};
+
+// A bounded lock-free multi-producer, single-consumer queue
+// Each cell carries a sequence number (Vyukov's bounded queue): a producer
+// claims a position with one CAS and publishes the cell by advancing its
+// sequence, so producers never wait for each other and never take a lock.
+// Capacity must be a power of two.
+template<typename T, size_t Capacity = 1024>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscQueue capacity must be a power of two");
+                  
+private:
+    // Queue cell
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+    };
+    
+    // Cells
+    Cell cells_[Capacity];
+    
+    // Next position to claim (shared by producers)
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    
+    // Next position to consume (written by the consumer only)
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    
+    // Helper to get the element stored in a cell
+    static T* element(Cell& cell) {
+        return reinterpret_cast<T*>(&cell.storage);
+    }
+    
+public:
+    // Constructor
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    // Destructor - destroy any remaining elements
+    ~MpscQueue() {
+        T value;
+        while (try_pop(value)) {
+            // Just pop and discard
+        }
+    }
+    
+    // Try to construct an element at the back of the queue (any thread)
+    // Returns true if successful, false if the queue is full
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        
+        for (;;) {
+            cell = &cells_[pos & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            
+            if (diff == 0) {
+                // Cell is free at our position, try to claim it
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Queue is full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);  // Another producer won
+            }
+        }
+        
+        // Construct the element and publish the cell to the consumer
+        new (&cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Try to push an element to the queue (any thread)
+    // Returns true if successful, false if the queue is full
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+    
+    // Try to push an element to the queue (move semantics, any thread)
+    // Returns true if successful, false if the queue is full
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+    
+    // Try to pop an element from the queue (consumer thread only)
+    // Returns false if the queue is empty
+    bool try_pop(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[pos & (Capacity - 1)];
+        
+        // The cell is ready once its producer has published it
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        
+        value = std::move(*element(cell));
+        element(cell)->~T();
+        
+        // Hand the cell back to producers for the next lap
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // Try to pop an element from the queue (consumer thread only)
+    // Returns the element if successful, nullopt if the queue is empty
+    std::optional<T> try_pop() {
+        T value;
+        if (!try_pop(value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+    
+    // Try to pop up to max_count elements (consumer thread only)
+    // Returns the number of elements written to values
+    size_t try_pop_n(T* values, size_t max_count) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t popped = 0;
+        
+        while (popped < max_count) {
+            Cell& cell = cells_[(pos + popped) & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + popped + 1) {
+                break;
+            }
+            
+            values[popped] = std::move(*element(cell));
+            element(cell)->~T();
+            cell.sequence.store(pos + popped + Capacity, std::memory_order_release);
+            popped++;
+        }
+        
+        dequeue_pos_.store(pos + popped, std::memory_order_relaxed);
+        return popped;
+    }
+    
+    // Get the (approximate) number of elements in the queue
+    size_t size() const {
+        size_t enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+        size_t dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+    
+    // Check if the queue is empty
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    // Get the capacity of the queue
+    size_t capacity() const {
+        return Capacity;
+    }
+};
+
 } // namespace trading
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
 #include <new>
@@ -10,7 +11,9 @@
 
 namespace trading {
 
-// A fixed-size, thread-safe memory pool
+// A fixed-size memory pool for a single thread (or external locking)
+// Blocks are grown without synchronization and the free list is not ABA
+// safe, so pools shared between threads should use ConcurrentMemoryPool.
 template<typename T, size_t BlockSize = 4096>
 class MemoryPool {
 public:
@@ -32,25 +35,15 @@ public:
     
     // Allocate memory for an object
     void* allocate() {
-        // Try to get a free slot
-        void* result = free_list_.exchange(nullptr, std::memory_order_acquire);
+        // Try to pop a free slot
+        void* result = pop_free_slot();
         
-        if (result) {
-            // We got a free slot
-            Slot* slot = static_cast<Slot*>(result);
-            result = free_list_.exchange(slot->next, std::memory_order_release);
-        } else {
-            // No free slots, allocate a new block
+        if (!result) {
+            // No free slots, allocate a new block and try again
             allocate_block();
+            result = pop_free_slot();
             
-            // Try again
-            result = free_list_.exchange(nullptr, std::memory_order_acquire);
-            
-            if (result) {
-                // We got a free slot
-                Slot* slot = static_cast<Slot*>(result);
-                result = free_list_.exchange(slot->next, std::memory_order_release);
-            } else {
+            if (!result) {
                 // Still no free slots, fallback to standard allocation
                 result = std::malloc(sizeof(T));
             }
@@ -59,6 +52,13 @@ public:
         return result;
     }
     
+    // Pre-allocate blocks for at least a number of additional objects
+    void reserve(size_t count) {
+        for (size_t slots = 0; slots < count; slots += slots_per_block()) {
+            allocate_block();
+        }
+    }
+    
     // Deallocate memory for an object
     void deallocate(void* ptr) {
         if (!ptr) {
@@ -120,6 +120,28 @@ private:
     // Pointer to the next block
     Block* next_block_;
     
+    // Size of a slot (large enough for a free-list link, suitably aligned for T)
+    static constexpr size_t slot_size() {
+        size_t size = sizeof(T) < sizeof(Slot) ? sizeof(Slot) : sizeof(T);
+        size_t align = alignof(T) < alignof(Slot) ? alignof(Slot) : alignof(T);
+        return (size + align - 1) / align * align;
+    }
+    
+    // Number of slots in a block
+    static constexpr size_t slots_per_block() {
+        return (BlockSize - sizeof(Block*)) / slot_size();
+    }
+    
+    // Pop the head of the free list (nullptr if empty)
+    void* pop_free_slot() {
+        Slot* head = free_list_.load(std::memory_order_acquire);
+        while (head && !free_list_.compare_exchange_weak(head, head->next,
+                                                         std::memory_order_acquire,
+                                                         std::memory_order_acquire)) {
+        }
+        return head;
+    }
+    
     // Allocate a new block of memory
     void allocate_block() {
         // Allocate memory for the block
@@ -131,11 +153,8 @@ private:
         next_block_ = block;
         
         // Initialize the free list
-        size_t slot_size = sizeof(T) < sizeof(Slot) ? sizeof(Slot) : sizeof(T);
-        size_t num_slots = (BlockSize - sizeof(Block*)) / slot_size;
-        
-        for (size_t i = 0; i < num_slots; ++i) {
-            char* ptr = block->data + i * slot_size;
+        for (size_t i = 0; i < slots_per_block(); ++i) {
+            char* ptr = block->data + i * slot_size();
             Slot* slot = reinterpret_cast<Slot*>(ptr);
             slot->next = free_list_.load(std::memory_order_relaxed);
             free_list_.store(slot, std::memory_order_relaxed);
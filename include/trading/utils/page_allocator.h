@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+namespace trading {
+
+// Page-granular memory for pools and arenas
+struct PageAllocation {
+    void* memory = nullptr;
+    size_t bytes = 0;        // Mapped size (rounded up to the page size)
+    bool huge_pages = false; // Backed by explicit huge pages
+};
+
+// Size of a huge page on this platform (2 MiB where supported)
+size_t huge_page_size();
+
+// Map zeroed, page-aligned memory
+// With huge_pages the mapping first tries explicit huge pages, then falls
+// back to regular pages with a transparent huge page hint. With prefault
+// every page is touched (and populated) before returning, so the first
+// access on the hot path does not take a page fault.
+// Returns an allocation with a null memory pointer on failure
+PageAllocation allocate_pages(size_t bytes, bool huge_pages = false, bool prefault = false);
+
+// Unmap memory from allocate_pages
+void free_pages(const PageAllocation& allocation);
+
+// Touch every page of a range so it is backed by physical memory
+void prefault_pages(void* memory, size_t bytes);
+
+// Lock every current and future page of the process into memory
+// Pages mapped later are populated when mapped, so nothing on the hot path
+// takes a page fault or is paged out. Needs CAP_IPC_LOCK or a large enough
+// RLIMIT_MEMLOCK.
+// Returns false if the platform does not support locking or the call fails
+bool lock_memory();
+
+} // namespace trading
\ No newline at end of file
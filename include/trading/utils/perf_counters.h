@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Build with -DTRADING_PERF_COUNTERS=1 (CMake option TRADING_PERF_COUNTERS)
+// to compile the TRADING_PERF_SCOPE regions into the hot paths
+#ifndef TRADING_PERF_COUNTERS
+#define TRADING_PERF_COUNTERS 0
+#endif
+
+namespace trading {
+
+// Hot-path stages measured by the performance counters
+enum class PerfStage : uint8_t {
+    PROCESS_BUFFER,   // MarketDataHandler::process_buffer (decode, book, callbacks)
+    BOOK_UPDATE,      // Order book mutation for one feed event
+    STRATEGY_UPDATE,  // Strategy::process_update pass over one book
+    SUBMIT_ORDER,     // ExecutionEngine::submit_order
+    COUNT
+};
+
+// Number of measured stages
+constexpr size_t PERF_STAGE_COUNT = static_cast<size_t>(PerfStage::COUNT);
+
+// Number of hardware events in a counter group
+constexpr size_t PERF_EVENT_COUNT = 5;
+
+// Get the name of a stage
+const char* perf_stage_name(PerfStage stage);
+
+// Hardware event counts of a stage
+struct PerfCounts {
+    uint64_t samples = 0;        // Scopes measured
+    uint64_t instructions = 0;   // Retired instructions
+    uint64_t cycles = 0;         // Core cycles
+    uint64_t l1d_misses = 0;     // L1 data cache read misses
+    uint64_t llc_misses = 0;     // Last-level cache misses
+    uint64_t branch_misses = 0;  // Mispredicted branches
+    
+    // Instructions per cycle
+    double ipc() const {
+        return cycles > 0 ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0;
+    }
+    
+    // Average of a count per sample
+    double per_sample(uint64_t count) const {
+        return samples > 0 ? static_cast<double>(count) / static_cast<double>(samples) : 0.0;
+    }
+    
+    // Counts accumulated since an earlier reading
+    PerfCounts operator-(const PerfCounts& earlier) const;
+};
+
+// Counts of every stage, summed over all threads
+struct PerfReport {
+    std::array<PerfCounts, PERF_STAGE_COUNT> stages{};
+    
+    // Get the counts of a stage
+    const PerfCounts& operator[](PerfStage stage) const { return stages[static_cast<size_t>(stage)]; }
+    
+    // Counts accumulated since an earlier report
+    PerfReport operator-(const PerfReport& earlier) const;
+    
+    // Get one line per measured stage as string
+    std::string summary() const;
+};
+
+// Per-thread hardware performance counters (perf_event_open on Linux)
+// Every thread that enters a TRADING_PERF_SCOPE opens its own counter group
+// (cycles leading instructions, L1D read misses, LLC misses and branch
+// misses, user space only) on first use. A scope reads the group on entry and
+// exit, with rdpmc from user space when the kernel allows it and a single
+// read() of the group otherwise, and adds the difference to the thread's
+// stage totals. Scopes nest and their counts are inclusive, so
+// PROCESS_BUFFER contains the BOOK_UPDATE and STRATEGY_UPDATE work it drives.
+//
+// Where the counters cannot be opened (no PMU, as in most containers and
+// VMs, perf_event_paranoid too strict, or not Linux) available() is false
+// and scopes cost a thread-local check. Without TRADING_PERF_COUNTERS the
+// scopes compile to nothing; the query functions still work and report no
+// samples.
+class PerfCounters {
+public:
+    // Check if the scopes were compiled in
+    static constexpr bool compiled_in() { return TRADING_PERF_COUNTERS != 0; }
+    
+    // Check if the counters can be opened on this machine (probes once)
+    static bool available();
+    
+    // Open the calling thread's counters ahead of its first scope
+    // Returns false if they are unavailable
+    static bool attach_thread();
+    
+    // Get the totals of every thread so far (any thread)
+    static PerfReport snapshot();
+};
+
+// Measures a region of code as one sample of a stage
+class PerfScope {
+public:
+    // Read the counters
+    explicit PerfScope(PerfStage stage);
+    
+    // Read the counters again and add the difference to the stage
+    ~PerfScope();
+    
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+    
+private:
+    // Stage measured (COUNT if the counters are unavailable)
+    PerfStage stage_;
+    
+    // Counter values on entry
+    std::array<uint64_t, PERF_EVENT_COUNT> start_;
+};
+
+#define TRADING_PERF_CONCAT_IMPL(a, b) a##b
+#define TRADING_PERF_CONCAT(a, b) TRADING_PERF_CONCAT_IMPL(a, b)
+
+// Measure the rest of the enclosing block as a sample of a stage
+#if TRADING_PERF_COUNTERS
+#define TRADING_PERF_SCOPE(stage) \
+    ::trading::PerfScope TRADING_PERF_CONCAT(perf_scope_, __LINE__)(::trading::PerfStage::stage)
+#else
+#define TRADING_PERF_SCOPE(stage) ((void)0)
+#endif
+
+} // namespace trading
\ No newline at end of file
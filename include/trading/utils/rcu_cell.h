@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace trading {
+
+// Read-copy-update cell holding an immutable value
+// Readers get the current value with a single acquire load of a pointer:
+// they never wait, never write shared memory and never see a value change
+// under them. A writer builds a complete new value and swaps the pointer.
+// Readers leave no trace a writer could wait on, so replaced values are
+// retired rather than freed and live as long as the cell; a pointer from
+// load() therefore stays valid for the cell's lifetime. That suits values
+// changed at operator pace (configuration, limits), not once per tick.
+template<typename T>
+class RcuCell {
+public:
+    // Constructor with the initial value
+    explicit RcuCell(T value = T()) {
+        values_.push_back(std::make_unique<const T>(std::move(value)));
+        current_.store(values_.back().get(), std::memory_order_release);
+    }
+    
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+    
+    // Get the current value (any thread)
+    const T* load() const { return current_.load(std::memory_order_acquire); }
+    
+    // Get the number of values published after the initial one
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+    
+    // Publish a new value (any thread; writers are serialized)
+    void publish(T value) {
+        auto next = std::make_unique<const T>(std::move(value));
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_.store(next.get(), std::memory_order_release);
+        values_.push_back(std::move(next));
+        version_.fetch_add(1, std::memory_order_release);
+    }
+    
+    // Publish a modified copy of the current value (any thread)
+    template<typename Modify>
+    void update(Modify&& modify) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+        modify(*next);
+        current_.store(next.get(), std::memory_order_release);
+        values_.push_back(std::move(next));
+        version_.fetch_add(1, std::memory_order_release);
+    }
+    
+private:
+    // Current value (read by the hot path, on its own cache line)
+    alignas(64) std::atomic<const T*> current_{nullptr};
+    
+    // Values published after the initial one
+    std::atomic<uint64_t> version_{0};
+    
+    // Serializes writers
+    alignas(64) std::mutex mutex_;
+    
+    // Every value published, current and retired
+    std::vector<std::unique_ptr<const T>> values_;
+};
+
+} // namespace trading
\ No newline at end of file
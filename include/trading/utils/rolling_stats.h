@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Fixed-capacity sliding window with O(1) mean and variance
+// Samples are kept in a ring; once the window is full each push replaces the
+// oldest sample and updates the running mean and sum of squared deviations
+// with the sliding form of Welford's algorithm. The sums are recomputed from
+// the ring every few thousand replacements so rounding error cannot build up.
+// Never allocates after construction (or reset).
+class RollingWindow {
+public:
+    // Constructor
+    explicit RollingWindow(size_t capacity = 0) {
+        reset(capacity);
+    }
+    
+    // Clear the window and change its capacity
+    void reset(size_t capacity) {
+        values_.assign(capacity > 0 ? capacity : 1, 0.0);
+        clear();
+    }
+    
+    // Clear the window, keeping its capacity
+    void clear() {
+        head_ = 0;
+        count_ = 0;
+        mean_ = 0.0;
+        m2_ = 0.0;
+        replacements_ = 0;
+    }
+    
+    // Add a sample, evicting the oldest one if the window is full
+    void push(double value) {
+        const size_t capacity = values_.size();
+        
+        if (count_ < capacity) {
+            // Growing window: plain Welford update
+            values_[(head_ + count_) % capacity] = value;
+            count_++;
+            double delta = value - mean_;
+            mean_ += delta / static_cast<double>(count_);
+            m2_ += delta * (value - mean_);
+            return;
+        }
+        
+        // Full window: replace the oldest sample
+        double oldest = values_[head_];
+        values_[head_] = value;
+        head_ = (head_ + 1 == capacity) ? 0 : head_ + 1;
+        
+        double old_mean = mean_;
+        mean_ += (value - oldest) / static_cast<double>(count_);
+        m2_ += (value - oldest) * (value - mean_ + oldest - old_mean);
+        
+        if (++replacements_ == RECOMPUTE_INTERVAL) {
+            recompute();
+        } else if (m2_ < 0.0) {
+            m2_ = 0.0;
+        }
+    }
+    
+    // Number of samples in the window
+    size_t size() const { return count_; }
+    
+    // Maximum number of samples
+    size_t capacity() const { return values_.size(); }
+    
+    // Check if the window holds capacity samples
+    bool full() const { return count_ == values_.size(); }
+    
+    // Check if the window is empty
+    bool empty() const { return count_ == 0; }
+    
+    // Most recent sample (undefined if empty)
+    double back() const {
+        return values_[(head_ + count_ - 1) % values_.size()];
+    }
+    
+    // Mean of the samples
+    double mean() const { return mean_; }
+    
+    // Population variance of the samples
+    double variance() const {
+        return count_ > 0 ? m2_ / static_cast<double>(count_) : 0.0;
+    }
+    
+    // Population standard deviation of the samples
+    double stddev() const { return std::sqrt(variance()); }
+    
+    // Z-score of a value against the window (0 if the window has no spread)
+    double z_score(double value) const {
+        double sd = stddev();
+        return sd > 0.0 ? (value - mean_) / sd : 0.0;
+    }
+    
+private:
+    // Replacements between exact recomputations of the running sums
+    static constexpr uint32_t RECOMPUTE_INTERVAL = 4096;
+    
+    // Sample ring (oldest sample at head_)
+    std::vector<double> values_;
+    
+    // Index of the oldest sample
+    size_t head_;
+    
+    // Number of samples
+    size_t count_;
+    
+    // Running mean
+    double mean_;
+    
+    // Running sum of squared deviations from the mean
+    double m2_;
+    
+    // Replacements since the last recomputation
+    uint32_t replacements_;
+    
+    // Recompute the mean and sum of squared deviations from the ring
+    void recompute() {
+        double sum = 0.0;
+        for (size_t i = 0; i < count_; ++i) {
+            sum += values_[i];
+        }
+        mean_ = sum / static_cast<double>(count_);
+        
+        double m2 = 0.0;
+        for (size_t i = 0; i < count_; ++i) {
+            double delta = values_[i] - mean_;
+            m2 += delta * delta;
+        }
+        m2_ = m2;
+        replacements_ = 0;
+    }
+};
+
+} // namespace trading
\ No newline at end of file
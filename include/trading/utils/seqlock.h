@@ -0,0 +1,97 @@
+#pragma once
+
+#include "trading/utils/backoff.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace trading {
+
+// Single-writer sequence lock around a trivially copyable value
+// The writer makes the sequence odd, stores the value and makes it even
+// again; a reader copies the value and retries if the sequence was odd or
+// changed during the copy. Writes never wait, reads never block the writer
+// and never see a torn value, and nothing is shared but the cache lines of
+// the value itself (no reference counts, no locked instructions). The value
+// is kept in relaxed atomic words, so the racing copies are well defined.
+template<typename T>
+class alignas(64) SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+    
+public:
+    // Constructor
+    SeqLock() : SeqLock(T{}) {}
+    
+    // Constructor with an initial value
+    explicit SeqLock(const T& value) {
+        std::array<uint64_t, WORDS> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+    
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    
+    // Publish a new value (writer thread only)
+    void store(const T& value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + i * sizeof(uint64_t), std::min(sizeof(uint64_t), sizeof(T) - i * sizeof(uint64_t)));
+            words_[i].store(word, std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+    
+    // Read a consistent copy of the value (any thread)
+    T load() const {
+        T value;
+        while (!try_load(value)) {
+            Backoff::cpu_relax();
+        }
+        return value;
+    }
+    
+    // Read the value once; returns false if a write got in the way
+    bool try_load(T& value) const {
+        std::array<uint64_t, WORDS> buffer;
+        uint64_t sequence = sequence_.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            return false;
+        }
+        for (size_t i = 0; i < WORDS; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != sequence) {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+        return true;
+    }
+    
+    // Get the number of values published so far
+    uint64_t version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+    
+private:
+    // Words of the value
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    // Sequence (odd while a store is in progress)
+    std::atomic<uint64_t> sequence_{0};
+    
+    // Value
+    std::array<std::atomic<uint64_t>, WORDS> words_{};
+};
+
+} // namespace trading
\ No newline at end of file
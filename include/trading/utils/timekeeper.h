@@ -1,5 +1,6 @@
 #pragma once
 
+#include "trading/utils/latency_histogram.h"
 #include <array>
 #include <chrono>
 #include <cstdint>
@@ -8,18 +9,30 @@
 
 namespace trading {
 
+// How a Timekeeper keeps its samples
+enum class TimekeeperMode {
+    SAMPLES,    // Every sample, up to max_samples (exact percentiles, for benchmarks)
+    HISTOGRAM   // LatencyHistogram (constant memory and O(1) record, for always-on metrics)
+};
+
 // High precision timekeeper for latency measurements
 class Timekeeper {
 public:
     // Constructor
     Timekeeper(size_t max_samples = 1000000);
     
+    // Constructor with a sample mode (HISTOGRAM ignores max_samples)
+    explicit Timekeeper(TimekeeperMode mode, size_t max_samples = 1000000);
+    
     // Start timing
     void start();
     
     // End timing and record sample
     uint64_t end();
     
+    // Record a sample measured elsewhere (nanoseconds)
+    void record(uint64_t ns);
+    
     // Get average latency
     double average() const;
     
@@ -38,12 +51,21 @@ public:
     // Clear samples
     void clear();
     
-    // Get number of samples
+    // Get number of samples (including those beyond max_samples)
     size_t count() const;
     
-    // Get all samples
+    // Get number of samples not kept because max_samples was reached (SAMPLES mode)
+    uint64_t dropped() const { return dropped_; }
+    
+    // Get all samples (empty in HISTOGRAM mode)
     const std::vector<uint64_t>& samples() const;
     
+    // Get the mode
+    TimekeeperMode mode() const { return mode_; }
+    
+    // Get the histogram (HISTOGRAM mode; snapshot or merge it for reporting)
+    const LatencyHistogram& latency_histogram() const { return histogram_; }
+    
     // Get histogram data
     std::vector<std::pair<uint64_t, uint64_t>> histogram(size_t bins = 20) const;
     
@@ -51,9 +73,18 @@ public:
     std::string summary() const;
     
 private:
+    // Sample mode
+    TimekeeperMode mode_;
+    
     // Vector of latency samples in nanoseconds
     std::vector<uint64_t> samples_;
     
+    // Histogram of latency samples (HISTOGRAM mode)
+    LatencyHistogram histogram_;
+    
+    // Samples beyond max_samples
+    uint64_t dropped_ = 0;
+    
     // Start time
     std::chrono::high_resolution_clock::time_point start_time_;
     
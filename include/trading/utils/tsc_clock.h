@@ -0,0 +1,108 @@
+#pragma once
+
+#include "trading/utils/timekeeper.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace trading {
+
+// Snapshot of the mapping from CycleCounter ticks to wall-clock time
+struct TscCalibration {
+    uint64_t base_ticks = 0;    // Tick count at base_ns
+    uint64_t base_ns = 0;       // Nanoseconds since the epoch at base_ticks
+    double ticks_per_ns = 1.0;  // Measured tick rate
+};
+
+// Wall clock built on the CPU time-stamp counter
+// now_ns() reads the TSC and scales it with fixed-point parameters published
+// under a sequence lock, so a timestamp costs a few cycles instead of a vDSO
+// call and every core maps ticks the same way (the TSC is synchronized across
+// cores on CPUs with an invariant TSC). The parameters are calibrated against
+// the realtime clock at startup; a background thread can recalibrate them
+// periodically, slewing the rate to absorb drift so the clock stays
+// continuous and never steps backwards. Without an invariant TSC the clock
+// falls back to the realtime clock.
+class TscClock {
+public:
+    // Nanoseconds since the epoch
+    static uint64_t now_ns() {
+        return to_ns(CycleCounter::start());
+    }
+    
+    // Convert a CycleCounter tick count to nanoseconds since the epoch
+    static uint64_t to_ns(uint64_t ticks) {
+        for (;;) {
+            uint32_t sequence = state_.sequence.load(std::memory_order_acquire);
+            uint64_t base_ticks = state_.base_ticks.load(std::memory_order_relaxed);
+            uint64_t base_ns = state_.base_ns.load(std::memory_order_relaxed);
+            uint64_t mult = state_.mult.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            
+            if ((sequence & 1) == 0 && state_.sequence.load(std::memory_order_relaxed) == sequence) [[likely]] {
+                if (mult == 0) [[unlikely]] {
+                    return realtime_ns();  // Not calibrated or no invariant TSC
+                }
+                // Ticks read before the last recalibration map backwards
+                return ticks >= base_ticks ? base_ns + scale(ticks - base_ticks, mult)
+                                           : base_ns - scale(base_ticks - ticks, mult);
+            }
+        }
+    }
+    
+    // Calibrate against the realtime clock (blocks for about 10 ms)
+    // Called once at startup; calling it again restarts the calibration
+    static void calibrate();
+    
+    // Correct the rate against the realtime clock (a no-op before calibrate)
+    static void recalibrate();
+    
+    // Recalibrate every interval from a background thread
+    static void start_recalibration(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    
+    // Stop the background thread
+    static void stop_recalibration();
+    
+    // Current calibration
+    static TscCalibration calibration();
+    
+    // Measured TSC ticks per nanosecond (the TSC frequency in GHz)
+    static double ticks_per_ns();
+    
+    // Check if the CPU has an invariant TSC (constant rate in every P/C-state)
+    static bool invariant_tsc();
+    
+    // Realtime clock in nanoseconds since the epoch
+    static uint64_t realtime_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    
+private:
+    // Fractional bits of the nanoseconds-per-tick multiplier
+    static constexpr unsigned SHIFT = 32;
+    
+    // Published parameters (sequence is odd while they are being written)
+    struct alignas(64) State {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint64_t> base_ticks{0};
+        std::atomic<uint64_t> base_ns{0};
+        std::atomic<uint64_t> mult{0};
+    };
+    
+    static State state_;
+    
+    // Scale a tick delta by a fixed-point multiplier (128-bit product)
+    static uint64_t scale(uint64_t ticks, uint64_t mult) {
+        __extension__ using uint128 = unsigned __int128;
+        return static_cast<uint64_t>((static_cast<uint128>(ticks) * mult) >> SHIFT);
+    }
+    
+    // Publish new parameters (single writer)
+    static void publish(uint64_t base_ticks, uint64_t base_ns, double ns_per_tick);
+};
+
+// Published parameters (constant-initialized, so usable during static initialization)
+inline TscClock::State TscClock::state_;
+
+} // namespace trading
\ No newline at end of file
@@ -1,14 +1,36 @@
 #include "trading/core/execution_engine.h"
 #include "trading/core/market_data.h"
+#include "trading/utils/cpu_affinity.h"
+#include "trading/utils/perf_counters.h"
+#include "trading/utils/tsc_clock.h"
 #include <algorithm>
 #include <chrono>
-#include <random>
 #include <thread>
 
 namespace trading {
 
-ExecutionEngine::ExecutionEngine(std::shared_ptr<MarketDataHandler> market_data)
-    : market_data_(std::move(market_data)), next_order_id_(1), running_(false) {
+namespace {
+
+// Longest wait of the BLOCKING processing thread while orders are resting
+constexpr std::chrono::microseconds RESTING_POLL_INTERVAL{100};
+} // anonymous namespace
+
+ExecutionEngine::ExecutionEngine(std::shared_ptr<MarketDataHandler> market_data, ExecutionConfig config)
+    : market_data_(std::move(market_data)), config_(config), next_order_id_(1),
+      statuses_(config.order_slots), simulator_(config_.simulator), market_time_(0), running_(false) {
+    config_.order_slots = statuses_.capacity();
+    
+    // Matching reads the depth the books publish, not the books themselves
+    size_t depth = std::min(config_.simulator.max_depth, BOOK_DEPTH_LEVELS);
+    if (market_data_ && market_data_->published_depth() < depth) {
+        market_data_->set_published_depth(depth);
+    }
+    
+    if (config_.mode == ExecutionMode::BUSY_POLL) {
+        new_orders_ = std::make_unique<MpscQueue<ExecutionOrder, ORDER_QUEUE_CAPACITY>>();
+        slots_ = std::make_unique<WorkingOrder[]>(config_.order_slots);
+        working_.reserve(config_.order_slots);
+    }
 }
 
 ExecutionEngine::~ExecutionEngine() {
@@ -23,7 +45,11 @@ void ExecutionEngine::start() {
     running_ = true;
     
     // Start order processing thread
-    processing_thread_ = std::thread(&ExecutionEngine::process_orders, this);
+    if (config_.mode == ExecutionMode::BUSY_POLL) {
+        processing_thread_ = std::thread(&ExecutionEngine::poll_orders, this);
+    } else {
+        processing_thread_ = std::thread(&ExecutionEngine::process_orders, this);
+    }
 }
 
 void ExecutionEngine::stop() {
@@ -31,7 +57,11 @@ void ExecutionEngine::stop() {
         return;  // Already stopped
     }
     
-    running_ = false;
+    {
+        // Clear the flag under the lock so a waiting thread cannot miss it
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
     
     // Signal processing thread to exit
     condition_.notify_all();
@@ -43,47 +73,48 @@ void ExecutionEngine::stop() {
 }
 
 OrderId ExecutionEngine::submit_order(const Signal& signal) {
+    TRADING_PERF_SCOPE(SUBMIT_ORDER);
+    
     // Generate a new order ID
     OrderId order_id = next_order_id_++;
     
+    // Claim the order's state slot; it is still in use if the order that
+    // last mapped to it has not finished
+    if (!statuses_.claim(order_id)) {
+        return 0;
+    }
+    
     // Convert signal to execution order
     ExecutionOrder order(
         order_id,
         signal.price,
         signal.quantity,
         signal.type == SignalType::BUY ? Side::BUY : Side::SELL,
-        signal.symbol,
-        signal.timestamp
+        signal.symbol_id,
+        now()
     );
     
-    // Create execution report
-    ExecutionReport* report = report_pool_.get();
-    *report = ExecutionReport(
-        order_id,
-        OrderStatus::NEW,
-        signal.price,
-        0,
-        signal.quantity,
-        signal.symbol,
-        static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-    );
+    if (config_.mode == ExecutionMode::BUSY_POLL) {
+        // Hand the order to the processing thread, which sends the NEW report
+        if (!new_orders_->try_push(order)) {
+            statuses_.transition(order_id, OrderStatus::REJECTED);
+            statuses_.retire(order_id);
+            return 0;
+        }
+        return order_id;
+    }
     
     {
         // Add order to pending orders
         std::lock_guard<std::mutex> lock(mutex_);
-        pending_orders_[order_id] = order;
+        pending_orders_[order_id].order = order;
         
         // Add order to processing queue
         order_queue_.push_back(order_id);
     }
     
     // Send execution report
-    if (execution_callback_) {
-        execution_callback_(*report);
-    }
-    
-    // Return report to pool
-    report_pool_.release(report);
+    send_report(order, OrderStatus::NEW, signal.price, 0, signal.quantity, order.timestamp);
     
     // Signal processing thread
     condition_.notify_one();
@@ -92,42 +123,32 @@ OrderId ExecutionEngine::submit_order(const Signal& signal) {
 }
 
 bool ExecutionEngine::cancel_order(OrderId order_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Find order
-    auto it = pending_orders_.find(order_id);
-    if (it == pending_orders_.end()) {
-        return false;  // Order not found
+    // Winning this transition is what cancels the order; the processing
+    // thread's own transitions fail from here on
+    if (!statuses_.transition(order_id, OrderStatus::CANCELED)) {
+        return false;  // Unknown or finished
     }
     
-    // Cannot cancel filled orders
-    OrderStatus status = get_order_status(order_id);
-    if (status == OrderStatus::FILLED) {
-        return false;
+    if (config_.mode == ExecutionMode::BUSY_POLL) {
+        return true;  // Reported and retired by the processing thread
     }
     
-    // Create execution report
-    ExecutionReport* report = report_pool_.get();
-    *report = ExecutionReport(
-        order_id,
-        OrderStatus::CANCELED,
-        it->second.price,
-        0,
-        it->second.quantity,
-        it->second.symbol,
-        static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-    );
-    
-    // Remove order from pending orders
-    pending_orders_.erase(it);
-    
-    // Send execution report
-    if (execution_callback_) {
-        execution_callback_(*report);
+    // Whoever takes the order out of the map retires and reports it
+    WorkingOrder working;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_orders_.find(order_id);
+        if (it == pending_orders_.end()) {
+            return true;  // Taken by the processing thread, which reports it
+        }
+        working = it->second;
+        pending_orders_.erase(it);
     }
+    statuses_.retire(order_id);
     
-    // Return report to pool
-    report_pool_.release(report);
+    // Send execution report
+    const ExecutionOrder& order = working.order;
+    send_report(order, OrderStatus::CANCELED, order.price, 0, order.quantity, now());
     
     return true;
 }
@@ -137,188 +158,248 @@ void ExecutionEngine::set_execution_callback(std::function<void(const ExecutionR
 }
 
 OrderStatus ExecutionEngine::get_order_status(OrderId order_id) const {
-    // Note: we're using a const_cast here because the implementation needs to lock the mutex
-    // but doesn't actually modify the logical state of the object
-    auto& non_const_this = const_cast<ExecutionEngine&>(*this);
-    std::lock_guard<std::mutex> lock(non_const_this.mutex_);
-    
-    // Find order
-    auto it = pending_orders_.find(order_id);
-    if (it == pending_orders_.end()) {
-        return OrderStatus::REJECTED;  // Order not found
-    }
-    
-    // Determine status based on order queue position
-    auto queue_it = std::find(order_queue_.begin(), order_queue_.end(), order_id);
-    if (queue_it == order_queue_.end()) {
-        return OrderStatus::FILLED;  // Not in queue, must be filled
+    return statuses_.status(order_id);
+}
+
+void ExecutionEngine::advance_time(Timestamp now) {
+    Timestamp current = market_time_.load(std::memory_order_relaxed);
+    while (current < now &&
+           !market_time_.compare_exchange_weak(current, now, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
     }
     
-    if (queue_it == order_queue_.begin()) {
-        return OrderStatus::PENDING;  // At front of queue, processing
+    // Wake a BLOCKING processing thread waiting for resting orders
+    condition_.notify_one();
+}
+
+Timestamp ExecutionEngine::now() const {
+    if (config_.event_time) {
+        return market_time_.load(std::memory_order_acquire);
     }
-    
-    return OrderStatus::NEW;  // In queue, waiting
+    return static_cast<Timestamp>(TscClock::now_ns());
 }
 
 void ExecutionEngine::process_orders() {
+    if (config_.cpu >= 0) {
+        pin_current_thread(config_.cpu);
+    }
+    
+    Timestamp evaluated_at = 0;
+    
     while (running_) {
-        OrderId order_id = 0;
-        
         {
-            // Wait for an order to process
+            // Wait for new orders; while orders are resting also wake up when
+            // the clock moves so they are matched against the updated books
             std::unique_lock<std::mutex> lock(mutex_);
-            condition_.wait(lock, [this] {
-                return !running_ || !order_queue_.empty();
-            });
+            auto ready = [this, evaluated_at] {
+                return !running_ || !order_queue_.empty() ||
+                       (!working_.empty() && config_.event_time && now() != evaluated_at);
+            };
+            if (working_.empty()) {
+                condition_.wait(lock, ready);
+            } else {
+                condition_.wait_for(lock, RESTING_POLL_INTERVAL, ready);
+            }
             
             if (!running_) {
                 break;  // Exit the thread
             }
             
-            if (order_queue_.empty()) {
-                continue;  // Spurious wakeup
-            }
-            
-            // Get the next order to process
-            order_id = order_queue_.front();
-            order_queue_.pop_front();
+            // Take the new orders
+            working_.insert(working_.end(), order_queue_.begin(), order_queue_.end());
+            order_queue_.clear();
         }
         
-        // Get the order
-        ExecutionOrder order;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto it = pending_orders_.find(order_id);
-            if (it == pending_orders_.end()) {
-                continue;  // Order not found
+        Timestamp current = now();
+        evaluated_at = current;
+        
+        for (size_t i = 0; i < working_.size();) {
+            WorkingOrder working;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = pending_orders_.find(working_[i]);
+                if (it == pending_orders_.end()) {
+                    // Order canceled
+                    working_[i] = working_.back();
+                    working_.pop_back();
+                    continue;
+                }
+                working = it->second;
             }
-            order = it->second;
+            
+            // Simulate order execution
+            OrderStatus status = simulate_execution(working, current);
+            
+            bool live = !is_terminal(status);
+            bool taken = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = pending_orders_.find(working.order.order_id);
+                if (it != pending_orders_.end()) {
+                    if (live) {
+                        it->second = working;
+                    } else {
+                        pending_orders_.erase(it);
+                        taken = true;
+                    }
+                }
+            }
+            
+            if (live) {
+                ++i;
+                continue;
+            }
+            
+            // Done; if cancel_order() took the order first it retires and
+            // reports it, otherwise this thread does (also for a cancel that
+            // won the status while the order was being matched)
+            if (taken) {
+                statuses_.retire(working.order.order_id);
+                if (status == OrderStatus::CANCELED) {
+                    const ExecutionOrder& order = working.order;
+                    send_report(order, OrderStatus::CANCELED, order.price, 0, order.quantity, current);
+                }
+            }
+            working_[i] = working_.back();
+            working_.pop_back();
         }
-        
-        // Simulate order execution
-        simulate_execution(order);
     }
 }
 
-void ExecutionEngine::simulate_execution(const ExecutionOrder& order) {
-    // Get the order book for this symbol
-    auto order_book = market_data_->get_order_book(order.symbol);
-    if (!order_book) {
-        // Order book not found, reject the order
-        ExecutionReport* report = report_pool_.get();
-        *report = ExecutionReport(
-            order.order_id,
-            OrderStatus::REJECTED,
-            order.price,
-            0,
-            order.quantity,
-            order.symbol,
-            static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-        );
+void ExecutionEngine::poll_orders() {
+    if (config_.cpu >= 0) {
+        pin_current_thread(config_.cpu);
+    }
+    
+    Backoff backoff(config_.backoff);
+    ExecutionOrder order;
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        bool worked = false;
         
-        // Send execution report
-        if (execution_callback_) {
-            execution_callback_(*report);
+        // Take new orders
+        while (new_orders_->try_pop(order)) {
+            WorkingOrder& working = slot_of(order.order_id);
+            working = WorkingOrder();
+            working.order = order;
+            working_.push_back(order.order_id);
+            send_report(order, OrderStatus::NEW, order.price, 0, order.quantity, order.timestamp);
+            worked = true;
         }
         
-        // Return report to pool
-        report_pool_.release(report);
-        
-        // Remove order from pending orders
-        std::lock_guard<std::mutex> lock(mutex_);
-        pending_orders_.erase(order.order_id);
+        // Match every working order against its book
+        Timestamp current = now();
+        for (size_t i = 0; i < working_.size();) {
+            WorkingOrder& working = slot_of(working_[i]);
+            
+            OrderStatus status;
+            if (statuses_.status(working.order.order_id) == OrderStatus::CANCELED) {
+                status = OrderStatus::CANCELED;
+                send_report(working.order, status, working.order.price, 0, working.order.quantity, current);
+                worked = true;
+            } else {
+                OrderStatus previous = working.status;
+                Quantity leaves = working.order.quantity;
+                status = simulate_execution(working, current);
+                worked |= status != previous || working.order.quantity != leaves;
+                if (status == OrderStatus::CANCELED) {
+                    continue;  // Lost to a cancel, reported on the retry
+                }
+            }
+            
+            if (!is_terminal(status)) {
+                ++i;
+            } else {
+                // Done (filled, canceled or rejected): the slot may be reused
+                // by a submitter from here on
+                statuses_.retire(working.order.order_id);
+                working_[i] = working_.back();
+                working_.pop_back();
+            }
+        }
         
-        return;
+        if (worked) {
+            backoff.reset();
+        } else {
+            backoff.idle();
+        }
     }
+}
+
+OrderStatus ExecutionEngine::simulate_execution(WorkingOrder& working, Timestamp now) {
+    ExecutionOrder& order = working.order;
     
-    // Get best bid/ask
-    auto best_bid = order_book->best_bid();
-    auto best_ask = order_book->best_ask();
-    
-    // Check if the order can be filled
-    bool can_fill = false;
-    Price fill_price = order.price;
-    
-    if (order.side == Side::BUY && best_ask && order.price >= *best_ask) {
-        can_fill = true;
-        fill_price = *best_ask;
-    } else if (order.side == Side::SELL && best_bid && order.price <= *best_bid) {
-        can_fill = true;
-        fill_price = *best_bid;
+    // Draw the order's latency the first time the processing thread sees it
+    if (!working.sent) {
+        simulator_.send(working.sim, order.timestamp);
+        working.sent = true;
+    }
+    if (now < working.sim.arrival_ns) {
+        return working.status;  // Still in flight
     }
     
-    // Simulate latency
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
-    
-    if (can_fill) {
-        // Simulate full fill
-        ExecutionReport* report = report_pool_.get();
-        *report = ExecutionReport(
-            order.order_id,
-            OrderStatus::FILLED,
-            fill_price,
-            order.quantity,
-            0,
-            order.symbol,
-            static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-        );
-        
-        // Send execution report
-        if (execution_callback_) {
-            execution_callback_(*report);
-        }
-        
-        // Return report to pool
-        report_pool_.release(report);
-        
-        // Remove order from pending orders
-        std::lock_guard<std::mutex> lock(mutex_);
-        pending_orders_.erase(order.order_id);
-    } else {
-        // Simulate partial fill with random quantity
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<Quantity> dist(1, order.quantity);
-        Quantity exec_quantity = dist(gen);
-        
-        ExecutionReport* report = report_pool_.get();
-        *report = ExecutionReport(
-            order.order_id,
-            OrderStatus::PARTIALLY_FILLED,
-            order.price,
-            exec_quantity,
-            order.quantity - exec_quantity,
-            order.symbol,
-            static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-        );
-        
-        // Send execution report
-        if (execution_callback_) {
-            execution_callback_(*report);
+    // Move to a status, or find that a cancel won
+    auto advance = [this, &working](OrderStatus status) {
+        if (!statuses_.transition(working.order.order_id, status)) {
+            working.status = OrderStatus::CANCELED;
+            return false;
         }
-        
-        // Return report to pool
-        report_pool_.release(report);
-        
-        // Update order in pending orders
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto it = pending_orders_.find(order.order_id);
-            if (it != pending_orders_.end()) {
-                it->second.quantity -= exec_quantity;
-            }
+        working.status = status;
+        return true;
+    };
+    
+    // Get the published depth of this symbol's book (no lock, no reference count)
+    const BookPublication* publication = market_data_->book_publication(order.symbol_id);
+    if (!publication) {
+        // Order book not found, reject the order
+        if (advance(OrderStatus::REJECTED)) {
+            send_report(order, OrderStatus::REJECTED, order.price, 0, order.quantity, now);
         }
-        
-        // Put order back in queue for further processing
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            order_queue_.push_back(order.order_id);
+        return working.status;
+    }
+    
+    // Report each fill at its own price
+    const BookDepth book = publication->depth.load();
+    for (const SimulatedFill& fill : simulator_.match(book, order.side, order.price, order.quantity,
+                                                      working.sim, now)) {
+        Quantity leaves = order.quantity - fill.quantity;
+        if (!advance(leaves == 0 ? OrderStatus::FILLED : OrderStatus::PARTIALLY_FILLED)) {
+            return working.status;
         }
-        
-        // Signal processing thread
-        condition_.notify_one();
+        order.quantity = leaves;
+        send_report(order, working.status, fill.price, fill.quantity, order.quantity, now);
     }
+    
+    // Resting at the exchange until something fills
+    if (working.status == OrderStatus::NEW) {
+        advance(OrderStatus::PENDING);
+    }
+    return working.status;
+}
+
+void ExecutionEngine::send_report(const ExecutionOrder& order, OrderStatus status, Price price,
+                                  Quantity exec_quantity, Quantity leaves_quantity, Timestamp timestamp) {
+    if (!execution_callback_) {
+        return;
+    }
+    
+    ExecutionReport* report = report_pool_.get();
+    *report = ExecutionReport(
+        order.order_id,
+        status,
+        price,
+        exec_quantity,
+        leaves_quantity,
+        order.symbol_id,
+        timestamp,
+        order.side
+    );
+    
+    // Send execution report
+    execution_callback_(*report);
+    
+    // Return report to pool
+    report_pool_.release(report);
 }
 
 } // namespace trading
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "trading/core/market_data.h"
+#include "trading/core/strategy_engine.h"
+#include "trading/utils/perf_counters.h"
 #include <algorithm>
 #include <cstring>
 #include <stdexcept>
@@ -97,94 +99,230 @@ MarketDataHandler::MarketDataHandler(size_t buffer_size)
 MarketDataHandler::~MarketDataHandler() = default;
 
 size_t MarketDataHandler::process_buffer(const uint8_t* data, size_t length) {
-    size_t offset = 0;
-    size_t processed = 0;
+    TRADING_PERF_SCOPE(PROCESS_BUFFER);
+    return process<NativeProtocol>(data, length);
+}
+
+void MarketDataHandler::apply_batch(const FeedEventBatch& batch) {
+    for (const FeedEvent& event : batch) {
+        apply_event(event);
+    }
+}
+
+void MarketDataHandler::apply_event(const FeedEvent& event) {
+    // Protocols carrying symbol IDs may name symbols never subscribed
+    if (event.symbol_id >= callbacks_.size()) {
+        return;
+    }
     
-    while (offset < length) {
-        // Parse a single message
-        auto [msg, symbol] = parse_message(data, offset, length);
-        
-        if (!msg) {
-            // Not enough data for a complete message
-            break;
-        }
-        
-        // Process callbacks for this symbol
-        auto it = callbacks_.find(std::string(symbol));
-        if (it != callbacks_.end()) {
-            for (const auto& callback : it->second) {
-                callback(*msg, symbol);
-            }
-        }
-        
-        // Update order books
-        update_order_books(*msg, symbol);
-        
-        processed += offset;
+    // Update order books
+    update_order_books(event);
+    
+    // Process callbacks for this symbol
+    for (const auto& callback : callbacks_[event.symbol_id]) {
+        callback(event);
     }
     
-    return processed;
+    // Per-event strategies see every state, conflated ones the last of the batch
+    if (strategy_engine_ && order_books_[event.symbol_id]) {
+        strategy_engine_->process_event(*order_books_[event.symbol_id]);
+        dirty_books_.set(event.symbol_id);
+    }
 }
 
-void MarketDataHandler::subscribe(std::string_view symbol, MarketDataCallback callback) {
-    // Convert symbol to string for map
-    std::string sym_str(symbol);
+void MarketDataHandler::set_strategy_engine(StrategyEngine* engine) {
+    strategy_engine_ = engine;
+    dirty_books_.resize(order_books_.size());
+}
+
+void MarketDataHandler::dispatch_updates() {
+    if (!strategy_engine_) {
+        return;
+    }
+    
+    for (size_t i = dirty_books_.find_first(); i != Bitmap::npos; i = dirty_books_.find_next(i + 1)) {
+        dirty_books_.clear(i);
+        strategy_engine_->process_conflated(*order_books_[i]);
+    }
+}
+
+SymbolId MarketDataHandler::subscribe(std::string_view symbol, MarketDataCallback callback) {
+    // Intern the symbol
+    SymbolId symbol_id = symbols_.intern(symbol);
+    if (symbol_id >= order_books_.size()) {
+        callbacks_.resize(symbol_id + 1);
+        order_books_.resize(symbol_id + 1);
+        spare_books_.resize(symbol_id + 1);
+        pending_snapshots_.resize(symbol_id + 1);
+        snapshot_open_.resize(symbol_id + 1, 0);
+        recovery_events_.resize(symbol_id + 1);
+        recovery_floors_.resize(symbol_id + 1, 0);
+        publications_.resize(symbol_id + 1, nullptr);
+        dirty_books_.resize(symbol_id + 1);
+    }
     
     // Add callback to the list for this symbol
-    callbacks_[sym_str].push_back(std::move(callback));
+    if (callback) {
+        callbacks_[symbol_id].push_back(std::move(callback));
+    }
     
     // Create order book for this symbol if it doesn't exist
-    if (order_books_.find(sym_str) == order_books_.end()) {
-        order_books_[sym_str] = std::make_shared<OrderBook>(symbol);
+    if (!order_books_[symbol_id]) {
+        order_books_[symbol_id] = std::make_shared<OrderBook>(symbol, 256, 1, symbol_id);
+        order_books_[symbol_id]->set_published_depth(published_depth_);
+        publications_[symbol_id] = &order_books_[symbol_id]->publication();
     }
+    
+    return symbol_id;
 }
 
 void MarketDataHandler::unsubscribe(std::string_view symbol) {
-    // Convert symbol to string for map
-    std::string sym_str(symbol);
+    SymbolId symbol_id = symbols_.find(symbol);
+    if (symbol_id == INVALID_SYMBOL_ID) {
+        return;
+    }
+    
+    // Remove all callbacks for this symbol (the ID and order book are kept)
+    callbacks_[symbol_id].clear();
+}
+
+void MarketDataHandler::preload(std::span<const std::string> symbols, size_t orders_per_book) {
+    for (const auto& symbol : symbols) {
+        SymbolId symbol_id = subscribe(symbol, MarketDataCallback());
+        auto& live = order_books_[symbol_id];
+        auto& spare = spare_books_[symbol_id];
+        if (!spare) {
+            spare = std::make_shared<OrderBook>(live->symbol(), 256, live->tick_size(), symbol_id);
+            spare->share_publication(*live);
+        }
+        live->reserve(orders_per_book);
+        spare->reserve(orders_per_book);
+        pending_snapshots_[symbol_id].reserve(orders_per_book);
+    }
+}
+
+void MarketDataHandler::place_books(SymbolId symbol_id, size_t orders) {
+    if (symbol_id >= order_books_.size() || !order_books_[symbol_id]) {
+        return;
+    }
     
-    // Remove all callbacks for this symbol
-    callbacks_.erase(sym_str);
+    // Fresh books allocated and touched by this thread, publishing into the
+    // same views as before
+    auto& live = order_books_[symbol_id];
+    for (auto* book : {&live, &spare_books_[symbol_id]}) {
+        auto placed = std::make_shared<OrderBook>(live->symbol(), 256, live->tick_size(), symbol_id);
+        placed->share_publication(*live);
+        placed->reserve(orders);
+        std::atomic_store(book, std::move(placed));
+    }
+    
+    std::vector<Order> pending;
+    pending.reserve(orders);
+    pending_snapshots_[symbol_id].swap(pending);
 }
 
-void MarketDataHandler::update_order_books(const MarketDataMessage& msg, std::string_view symbol) {
-    // Convert symbol to string for map
-    std::string sym_str(symbol);
+void MarketDataHandler::warm_up(SymbolId symbol_id, Price price, size_t rounds) {
+    if (symbol_id >= order_books_.size() || !order_books_[symbol_id]) {
+        return;
+    }
     
+    // Levels per side and orders per level of a round
+    constexpr Price LEVELS = 8;
+    constexpr int ORDERS_PER_LEVEL = 4;
+    
+    const Price tick = order_books_[symbol_id]->tick_size();
+    FeedEvent event{};
+    event.symbol_id = symbol_id;
+    
+    for (size_t round = 0; round < rounds; ++round) {
+        // Build both sides: bids below the price, asks from it up
+        OrderId order_id = 1;
+        event.type = MessageType::ADD_ORDER;
+        event.quantity = 100;
+        for (Price level = 0; level < LEVELS; ++level) {
+            for (int i = 0; i < ORDERS_PER_LEVEL; ++i) {
+                for (Side side : {Side::BUY, Side::SELL}) {
+                    event.side = side;
+                    event.order_id = order_id++;
+                    event.price = side == Side::BUY ? price - (level + 1) * tick : price + level * tick;
+                    update_order_books(event);
+                }
+            }
+        }
+        
+        // Then shrink, partially fill and cancel every order, best levels first
+        for (OrderId id = 1; id < order_id; ++id) {
+            event.order_id = id;
+            event.type = MessageType::MODIFY_ORDER;
+            event.quantity = 50;
+            update_order_books(event);
+            event.type = MessageType::EXECUTE_ORDER;
+            event.quantity = 10;
+            update_order_books(event);
+            event.type = MessageType::CANCEL_ORDER;
+            update_order_books(event);
+        }
+    }
+    
+    order_books_[symbol_id]->clear();
+}
+
+void MarketDataHandler::update_order_books(const FeedEvent& event) {
     // Get order book for this symbol
-    auto it = order_books_.find(sym_str);
-    if (it == order_books_.end()) {
+    if (event.symbol_id >= order_books_.size() || !order_books_[event.symbol_id]) {
         // No order book for this symbol
         return;
     }
     
-    auto& order_book = it->second;
+    auto& order_book = order_books_[event.symbol_id];
+    TRADING_PERF_SCOPE(BOOK_UPDATE);
+    
+    if (event.type == MessageType::SNAPSHOT) {
+        apply_snapshot(event);
+        return;
+    }
     
-    // Process message based on type
-    switch (msg.type) {
+    // Splice sequenced updates around snapshots: drop what a snapshot already
+    // holds, keep what a pending one will not
+    if (event.sequence != 0 && event.type != MessageType::TRADE) {
+        if (event.sequence <= order_book->sequence()) {
+            return;
+        }
+        if (order_book->is_stale() || snapshot_open_[event.symbol_id]) {
+            keep_recovery_event(event);
+        }
+        order_book->set_sequence(event.sequence);
+    }
+    
+    apply_to_book(*order_book, event);
+}
+
+void MarketDataHandler::apply_to_book(OrderBook& order_book, const FeedEvent& event) {
+    // Process event based on type
+    switch (event.type) {
         case MessageType::ADD_ORDER: {
             Order order(
-                msg.add_order.order_id,
-                msg.add_order.price,
-                msg.add_order.quantity,
-                msg.add_order.side == 0 ? Side::BUY : Side::SELL,
-                msg.timestamp,
-                symbol
+                event.order_id,
+                event.price,
+                event.quantity,
+                event.side,
+                event.timestamp,
+                event.symbol_id
             );
-            order_book->add_order(order);
+            order_book.add_order(order);
             break;
         }
         
         case MessageType::MODIFY_ORDER:
-            order_book->modify_order(msg.modify_order.order_id, msg.modify_order.quantity);
+            order_book.modify_order(event.order_id, event.quantity);
             break;
         
         case MessageType::CANCEL_ORDER:
-            order_book->cancel_order(msg.cancel_order.order_id);
+            order_book.cancel_order(event.order_id);
             break;
         
         case MessageType::EXECUTE_ORDER:
-            order_book->execute_order(msg.execute_order.order_id, msg.execute_order.exec_quantity);
+            order_book.execute_order(event.order_id, event.quantity);
             break;
         
         // Other message types are not directly relevant for order book updates
@@ -193,42 +331,146 @@ void MarketDataHandler::update_order_books(const MarketDataMessage& msg, std::st
     }
 }
 
-std::shared_ptr<OrderBook> MarketDataHandler::get_order_book(std::string_view symbol) {
-    // Convert symbol to string for map
-    std::string sym_str(symbol);
-    
-    // Get order book for this symbol
-    auto it = order_books_.find(sym_str);
-    if (it == order_books_.end()) {
-        // No order book for this symbol
-        return nullptr;
+void MarketDataHandler::keep_recovery_event(const FeedEvent& event) {
+    auto& events = recovery_events_[event.symbol_id];
+    if (events.size() == MAX_RECOVERY_EVENTS) {
+        // Recovering for too long: give up the kept updates, the snapshot
+        // now has to cover them
+        events.clear();
+        auto& floor = recovery_floors_[event.symbol_id];
+        if (floor == RECOVERY_PENDING || floor < event.sequence) {
+            floor = event.sequence;
+        }
     }
     
-    return it->second;
+    // The wire symbol does not outlive the buffer it was decoded from
+    FeedEvent& kept = events.emplace_back(event);
+    kept.symbol = {};
 }
 
-std::pair<const MarketDataMessage*, std::string_view> MarketDataHandler::parse_message(const uint8_t* data, size_t& offset, size_t max_length) {
-    // Check if we have enough data for the fixed part of the header
-    if (offset + sizeof(MarketDataMessage) > max_length) {
-        return {nullptr, ""};
+void MarketDataHandler::apply_snapshot(const FeedEvent& event) {
+    auto& orders = pending_snapshots_[event.symbol_id];
+    auto& live = order_books_[event.symbol_id];
+    if (event.snapshot_flags & SNAPSHOT_FIRST) {
+        orders.clear();
+        
+        // Updates from here on are kept; a healthy book already holds the
+        // earlier ones only
+        snapshot_open_[event.symbol_id] = 1;
+        if (!live->is_stale()) {
+            recovery_events_[event.symbol_id].clear();
+            recovery_floors_[event.symbol_id] = live->sequence() + 1;
+        }
+    }
+    
+    // Collect the chunk's orders (the rebuild happens once the last chunk is in)
+    for (size_t i = 0; i < event.entry_count; ++i) {
+        const uint8_t* entry = event.entries + i * sizeof(SnapshotEntry);
+        orders.emplace_back(
+            NativeProtocol::load<OrderId>(entry + offsetof(SnapshotEntry, order_id)),
+            NativeProtocol::load<Price>(entry + offsetof(SnapshotEntry, price)),
+            NativeProtocol::load<Quantity>(entry + offsetof(SnapshotEntry, quantity)),
+            entry[offsetof(SnapshotEntry, side)] == 0 ? Side::BUY : Side::SELL,
+            event.timestamp,
+            event.symbol_id
+        );
+    }
+    
+    if (!(event.snapshot_flags & SNAPSHOT_LAST)) {
+        return;
+    }
+    
+    snapshot_open_[event.symbol_id] = 0;
+    auto& kept = recovery_events_[event.symbol_id];
+    auto& floor = recovery_floors_[event.symbol_id];
+    
+    // A snapshot older than updates kept nowhere else would lose them: keep
+    // the book (stale ones wait for a newer snapshot)
+    const uint64_t sequence = event.sequence;
+    if (sequence != 0 && floor != 0 && (floor == RECOVERY_PENDING || sequence + 1 < floor)) {
+        orders.clear();
+        if (!live->is_stale()) {
+            kept.clear();
+            floor = 0;
+        }
+        return;
     }
     
-    // Parse the fixed part of the header
-    const MarketDataMessage* msg = reinterpret_cast<const MarketDataMessage*>(data + offset);
+    // Rebuild into the spare book so readers of the live book are not disturbed.
+    // A spare still referenced by a reader is replaced by a fresh one.
+    auto& spare = spare_books_[event.symbol_id];
+    if (!spare || spare.use_count() > 1) {
+        spare = std::make_shared<OrderBook>(live->symbol(), 256, live->tick_size(), event.symbol_id);
+    }
+    spare->share_publication(*live);
+    spare->load_snapshot(orders);
+    spare->set_sequence(sequence);
+    orders.clear();
     
-    // Check if we have enough data for the symbol
-    size_t total_size = sizeof(MarketDataMessage) + msg->symbol_length;
-    if (offset + total_size > max_length) {
-        return {nullptr, ""};
+    // Replay the updates the snapshot does not hold yet
+    for (const FeedEvent& update : kept) {
+        if (sequence != 0 && update.sequence > sequence) {
+            apply_to_book(*spare, update);
+            spare->set_sequence(update.sequence);
+        }
     }
+    kept.clear();
+    floor = 0;
     
-    // Get the symbol
-    std::string_view symbol(reinterpret_cast<const char*>(data + offset + sizeof(MarketDataMessage)), msg->symbol_length);
+    // Publish the rebuilt book; the retired one becomes the next spare
+    std::shared_ptr<OrderBook> retired = live;
+    std::atomic_store(&live, std::move(spare));
+    spare = std::move(retired);
+}
+
+void MarketDataHandler::set_published_depth(size_t levels) {
+    published_depth_ = std::min(levels, BOOK_DEPTH_LEVELS);
+    for (auto& order_book : order_books_) {
+        if (order_book) {
+            order_book->set_published_depth(published_depth_);
+        }
+    }
+}
+
+void MarketDataHandler::set_sequence(uint64_t next_sequence) {
+    next_sequence_ = next_sequence;
     
-    // Advance offset
-    offset += total_size;
+    // The first message after a gap bounds the snapshots that can recover
+    if (resume_pending_ && next_sequence != 0) {
+        resume_pending_ = false;
+        for (auto& floor : recovery_floors_) {
+            if (floor == RECOVERY_PENDING) {
+                floor = next_sequence;
+            }
+        }
+    }
+}
+
+void MarketDataHandler::mark_stale() {
+    // A sequence gap may have hit any symbol on the channel
+    for (size_t i = 0; i < order_books_.size(); ++i) {
+        if (order_books_[i]) {
+            order_books_[i]->set_stale(true);
+            if (next_sequence_ != 0) {
+                recovery_floors_[i] = RECOVERY_PENDING;
+            }
+        }
+    }
+    resume_pending_ = next_sequence_ != 0;
+}
+
+std::shared_ptr<OrderBook> MarketDataHandler::get_order_book(std::string_view symbol) {
+    return get_order_book(symbols_.find(symbol));
+}
+
+std::shared_ptr<OrderBook> MarketDataHandler::get_order_book(SymbolId symbol_id) {
+    if (symbol_id >= order_books_.size()) {
+        // No order book for this symbol
+        return nullptr;
+    }
     
-    return {msg, symbol};
+    // The slot may be swapped by a snapshot rebuild on the feed thread
+    return std::atomic_load(&order_books_[symbol_id]);
 }
 
 } // namespace trading
\ No newline at end of file
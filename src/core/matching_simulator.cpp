@@ -0,0 +1,127 @@
+#include "trading/core/matching_simulator.h"
+#include <algorithm>
+#include <limits>
+
+namespace trading {
+
+namespace {
+
+// Check if a price on the opposite side crosses a limit price
+bool crosses(Side side, Price limit, Price opposite) {
+    return side == Side::BUY ? opposite <= limit : opposite >= limit;
+}
+
+} // anonymous namespace
+
+MatchingSimulator::MatchingSimulator(SimulatorConfig config)
+    : config_(config), rng_(config.seed) {
+    fills_.reserve(config_.max_depth + 1);
+}
+
+void MatchingSimulator::send(SimulatedOrder& state, Timestamp sent_ns) {
+    state.arrival_ns = sent_ns + draw_latency();
+    state.queue_ahead = 0;
+    state.touch_taken = 0;
+    state.through_taken = 0;
+    state.resting = false;
+}
+
+Timestamp MatchingSimulator::draw_latency() {
+    const LatencyModel& model = config_.latency;
+    
+    switch (model.distribution) {
+        case LatencyModel::Distribution::UNIFORM: {
+            std::uniform_int_distribution<Timestamp> dist(0, model.jitter_ns);
+            return model.base_ns + dist(rng_);
+        }
+        
+        case LatencyModel::Distribution::EXPONENTIAL: {
+            if (model.jitter_ns == 0) {
+                return model.base_ns;
+            }
+            std::exponential_distribution<double> dist(1.0 / static_cast<double>(model.jitter_ns));
+            return model.base_ns + static_cast<Timestamp>(dist(rng_));
+        }
+        
+        default:
+            return model.base_ns;
+    }
+}
+
+std::span<const SimulatedFill> MatchingSimulator::match(const BookDepth& book, Side side, Price limit,
+                                                        Quantity quantity, SimulatedOrder& state,
+                                                        Timestamp now) {
+    fills_.clear();
+    if (now < state.arrival_ns || quantity == 0) {
+        return {};  // Still in flight
+    }
+    
+    Side opposite = side == Side::BUY ? Side::SELL : Side::BUY;
+    
+    if (!state.resting) {
+        // Arrival: take the crossing liquidity level by level
+        auto levels = book.levels(opposite);
+        for (const auto& level : levels.first(std::min(levels.size(), config_.max_depth))) {
+            if (quantity == 0 || !crosses(side, limit, level.price)) {
+                break;
+            }
+            Quantity exec_quantity = std::min(quantity, level.quantity);
+            fills_.push_back({level.price, exec_quantity});
+            quantity -= exec_quantity;
+            
+            // The book still shows what was taken until real trades remove it
+            (level.price == limit ? state.touch_taken : state.through_taken) += exec_quantity;
+        }
+        
+        // Join the back of the queue at the limit price
+        if (quantity > 0) {
+            state.resting = true;
+            state.queue_ahead = book.quantity_at(side, limit).value_or(std::numeric_limits<Quantity>::max());
+        }
+        return fills_;
+    }
+    
+    // Resting: quantity that left the level can only have been ahead of us
+    if (auto displayed = book.quantity_at(side, limit)) {
+        state.queue_ahead = std::min(state.queue_ahead, *displayed);
+    }
+    
+    // Opposite quantity crossing the limit price, through it and at it
+    Quantity through = 0;
+    Quantity touch = 0;
+    auto levels = book.levels(opposite);
+    for (const auto& level : levels.first(std::min(levels.size(), config_.max_depth))) {
+        if (!crosses(side, limit, level.price)) {
+            break;
+        }
+        (level.price == limit ? touch : through) += level.quantity;
+    }
+    
+    // Quantity that left the book was taken by real trades; what shows beyond
+    // the quantity already matched arrived after the order did
+    state.through_taken = std::min(state.through_taken, through);
+    state.touch_taken = std::min(state.touch_taken, touch);
+    Quantity exec_quantity = 0;
+    
+    if (through > state.through_taken) {
+        // The opposite side crossed our price: it would have traded with
+        // every order at our price, so the queue ahead is gone
+        state.queue_ahead = 0;
+        exec_quantity = std::min(quantity, through - state.through_taken);
+        state.through_taken += exec_quantity;
+    }
+    
+    if (state.queue_ahead == 0 && exec_quantity < quantity && touch > state.touch_taken) {
+        // Touching at the front of the queue: match what was not matched yet
+        Quantity touch_quantity = std::min(quantity - exec_quantity, touch - state.touch_taken);
+        state.touch_taken += touch_quantity;
+        exec_quantity += touch_quantity;
+    }
+    
+    if (exec_quantity > 0) {
+        fills_.push_back({limit, exec_quantity});
+    }
+    return fills_;
+}
+
+} // namespace trading
\ No newline at end of file
@@ -6,114 +6,130 @@
 
 namespace trading {
 
-OrderBook::OrderBook(std::string_view symbol, uint32_t price_levels)
-    : symbol_(symbol), best_bid_(std::nullopt), best_ask_(std::nullopt) {
+OrderBook::OrderBook(std::string_view symbol, uint32_t price_levels, Price tick_size, SymbolId symbol_id)
+    : bid_level_count_(0), ask_level_count_(0), tick_size_(tick_size > 0 ? tick_size : 1), base_price_(0),
+      symbol_(symbol), symbol_id_(symbol_id), best_bid_(std::nullopt), best_ask_(std::nullopt),
+      stale_(false), publication_(std::make_shared<BookPublication>()), published_levels_(0) {
     // Pre-allocate space for price levels
+    if (price_levels == 0) {
+        price_levels = 1;
+    }
     bid_levels_.resize(price_levels);
     ask_levels_.resize(price_levels);
+    bid_bitmap_.resize(price_levels);
+    ask_bitmap_.resize(price_levels);
 }
 
-void OrderBook::add_order(const Order& order) {
-    // Store the order
-    orders_[order.id] = order;
+bool OrderBook::add_order(const Order& order) {
+    // Reject prices that are not on the tick grid
+    if (order.price % tick_size_ != 0) {
+        return false;
+    }
     
-    // Update the price level
-    auto index = price_to_index(order.price, order.side);
-    if (order.side == Side::BUY) {
-        bid_levels_[index].price = order.price;
-        bid_levels_[index].quantity += order.quantity;
-    } else {
-        ask_levels_[index].price = order.price;
-        ask_levels_[index].quantity += order.quantity;
+    // Reject empty orders (they would mark an empty level as occupied)
+    if (order.quantity == 0) {
+        return false;
+    }
+    
+    // Reject duplicate (and reserved) order IDs
+    if (order.id == 0 || order_index_.find(order.id)) {
+        return false;
+    }
+    
+    // Reject prices the ladder cannot cover (re-centers it for those it can)
+    if (!in_ladder(order.price) && !recenter(order.price)) {
+        out_of_range_orders_++;
+        return false;
     }
     
-    // Update best prices
-    update_best_prices();
+    // Take a node from the pool
+    OrderNode* node = static_cast<OrderNode*>(node_pool_.allocate());
+    *node = OrderNode{order.id, order.price, order.quantity, order.original_quantity,
+                      order.side, order.timestamp, nullptr, nullptr};
+    order_index_.insert(order.id, node);
+    
+    // Update the price level (may re-center the ladder) and join its queue
+    add_to_level(order.side, order.price, order.quantity);
+    link_back(node);
+    publish(order.side, order.price);
+    return true;
 }
 
 bool OrderBook::modify_order(OrderId order_id, Quantity new_quantity) {
     // Find the order
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) {
+    OrderNode** entry = order_index_.find(order_id);
+    if (!entry) {
         return false;
     }
     
-    Order& order = it->second;
-    auto index = price_to_index(order.price, order.side);
+    OrderNode* node = *entry;
+    const Side side = node->side;
+    const Price price = node->price;
+    
+    // A modify down to zero is a cancel
+    if (new_quantity == 0) {
+        remove_order(node);
+        publish(side, price);
+        return true;
+    }
     
     // Update the price level
-    if (order.side == Side::BUY) {
-        bid_levels_[index].quantity -= order.quantity;
-        bid_levels_[index].quantity += new_quantity;
-    } else {
-        ask_levels_[index].quantity -= order.quantity;
-        ask_levels_[index].quantity += new_quantity;
+    if (new_quantity > node->quantity) {
+        add_to_level(node->side, node->price, new_quantity - node->quantity);
+        
+        // Increasing the size loses time priority
+        unlink(node);
+        link_back(node);
+    } else if (new_quantity < node->quantity) {
+        remove_from_level(node->side, node->price, node->quantity - new_quantity);
     }
     
     // Update the order
-    order.quantity = new_quantity;
-    
-    // Update best prices if needed
-    update_best_prices();
+    node->quantity = new_quantity;
+    publish(side, price);
     return true;
 }
 
 bool OrderBook::cancel_order(OrderId order_id) {
     // Find the order
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) {
+    OrderNode** entry = order_index_.find(order_id);
+    if (!entry) {
         return false;
     }
     
-    Order& order = it->second;
-    auto index = price_to_index(order.price, order.side);
-    
-    // Update the price level
-    if (order.side == Side::BUY) {
-        bid_levels_[index].quantity -= order.quantity;
-    } else {
-        ask_levels_[index].quantity -= order.quantity;
-    }
-    
-    // Remove the order
-    orders_.erase(it);
-    
-    // Update best prices if needed
-    update_best_prices();
+    OrderNode* node = *entry;
+    const Side side = node->side;
+    const Price price = node->price;
+    remove_order(node);
+    publish(side, price);
     return true;
 }
 
 bool OrderBook::execute_order(OrderId order_id, Quantity exec_quantity) {
     // Find the order
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) {
+    OrderNode** entry = order_index_.find(order_id);
+    if (!entry) {
         return false;
     }
     
-    Order& order = it->second;
-    if (order.quantity < exec_quantity) {
+    OrderNode* node = *entry;
+    if (node->quantity < exec_quantity) {
         return false;
     }
-    
-    auto index = price_to_index(order.price, order.side);
-    
-    // Update the price level
-    if (order.side == Side::BUY) {
-        bid_levels_[index].quantity -= exec_quantity;
-    } else {
-        ask_levels_[index].quantity -= exec_quantity;
-    }
-    
-    // Update the order
-    order.quantity -= exec_quantity;
+    const Side side = node->side;
+    const Price price = node->price;
     
     // If fully executed, remove the order
-    if (order.quantity == 0) {
-        orders_.erase(it);
+    if (node->quantity == exec_quantity) {
+        remove_order(node);
+        publish(side, price);
+        return true;
     }
     
-    // Update best prices if needed
-    update_best_prices();
+    // Update the price level and the order
+    remove_from_level(side, price, exec_quantity);
+    node->quantity -= exec_quantity;
+    publish(side, price);
     return true;
 }
 
@@ -125,25 +141,6 @@ std::optional<Price> OrderBook::best_ask() const {
     return best_ask_;
 }
 
-std::pair<size_t, size_t> OrderBook::depth() const {
-    size_t bid_depth = 0;
-    size_t ask_depth = 0;
-    
-    for (const auto& level : bid_levels_) {
-        if (level.quantity > 0) {
-            bid_depth++;
-        }
-    }
-    
-    for (const auto& level : ask_levels_) {
-        if (level.quantity > 0) {
-            ask_depth++;
-        }
-    }
-    
-    return {bid_depth, ask_depth};
-}
-
 std::optional<Price> OrderBook::spread() const {
     if (best_bid_ && best_ask_) {
         return *best_ask_ - *best_bid_;
@@ -158,73 +155,493 @@ std::optional<Price> OrderBook::mid_price() const {
     return std::nullopt;
 }
 
+std::optional<Price> OrderBook::mid_price_x2() const {
+    if (best_bid_ && best_ask_) {
+        return *best_bid_ + *best_ask_;
+    }
+    return std::nullopt;
+}
+
 std::vector<OrderBookLevel> OrderBook::get_levels(Side side, size_t depth) const {
-    std::vector<OrderBookLevel> result;
-    result.reserve(depth);
+    std::vector<OrderBookLevel> result(std::min(depth, level_count(side)));
+    result.resize(copy_levels(side, result));
+    return result;
+}
+
+size_t OrderBook::copy_levels(Side side, std::span<OrderBookLevel> out) const {
+    // The ladder is kept in price order, so the walk is already sorted
+    size_t copied = 0;
+    for (const OrderBookLevel& level : levels(side)) {
+        if (copied == out.size()) {
+            break;
+        }
+        out[copied++] = level;
+    }
+    return copied;
+}
+
+const OrderNode* OrderBook::find_order(OrderId order_id) const {
+    OrderNode* const* entry = order_index_.find(order_id);
+    return entry ? *entry : nullptr;
+}
+
+std::optional<QueuePosition> OrderBook::queue_position(OrderId order_id) const {
+    const OrderNode* node = find_order(order_id);
+    if (!node) {
+        return std::nullopt;
+    }
+    
+    // Walk towards the front of the queue
+    QueuePosition position{0, 0};
+    for (const OrderNode* ahead = node->prev; ahead; ahead = ahead->prev) {
+        position.orders_ahead++;
+        position.quantity_ahead += ahead->quantity;
+    }
+    
+    return position;
+}
+
+const OrderNode* OrderBook::level_front(Side side, Price price) const {
+    if (price % tick_size_ != 0 || !in_ladder(price)) {
+        return nullptr;
+    }
     
     const auto& levels = (side == Side::BUY) ? bid_levels_ : ask_levels_;
+    return levels[price_to_index(price)].head;
+}
+
+void OrderBook::reserve(size_t orders) {
+    order_index_.reserve(orders);
+    node_pool_.reserve(orders);
+}
+
+void OrderBook::clear() {
+    release_orders();
+    publish_all();
+}
+
+void OrderBook::release_orders() {
+    for (Side side : {Side::BUY, Side::SELL}) {
+        auto& levels = (side == Side::BUY) ? bid_levels_ : ask_levels_;
+        auto& bitmap = (side == Side::BUY) ? bid_bitmap_ : ask_bitmap_;
+        
+        // Return the queued nodes of every non-empty level to the pool
+        for (size_t i = bitmap.find_first(); i != Bitmap::npos; i = bitmap.find_next(i + 1)) {
+            for (OrderNode* node = levels[i].head; node;) {
+                OrderNode* next = node->next;
+                node_pool_.deallocate(node);
+                node = next;
+            }
+            levels[i] = OrderBookLevel();
+        }
+        bitmap.reset();
+    }
     
-    // For bids, we want to start from the highest price (best bid)
-    // For asks, we want to start from the lowest price (best ask)
-    if (side == Side::BUY) {
-        // Find non-empty levels and sort by price descending
-        for (const auto& level : levels) {
-            if (level.quantity > 0) {
-                result.push_back(level);
+    order_index_.clear();
+    bid_level_count_ = 0;
+    ask_level_count_ = 0;
+    best_bid_ = std::nullopt;
+    best_ask_ = std::nullopt;
+}
+
+size_t OrderBook::load_snapshot(std::span<const Order> orders) {
+    // Readers keep seeing the previous contents until the rebuilt book is published
+    release_orders();
+    
+    auto loadable = [this](const Order& order) {
+        return order.id != 0 && order.quantity > 0 && order.price % tick_size_ == 0;
+    };
+    
+    // Find the price range of the snapshot
+    Price low = std::numeric_limits<Price>::max();
+    Price high = std::numeric_limits<Price>::min();
+    for (const Order& order : orders) {
+        if (loadable(order)) {
+            low = std::min(low, order.price);
+            high = std::max(high, order.price);
+        }
+    }
+    
+    if (low > high) {
+        publish_all();
+        set_stale(false);
+        return 0;  // Empty snapshot
+    }
+    
+    // Size and center the ladder once, with the same slack rule as recenter().
+    // A range too wide for any ladder (stray prices) is cut to the widest
+    // ladder around the median price, which a few outliers cannot move.
+    size_t size = ladder_size(low, high);
+    Price window_low = low;
+    Price window_high = high;
+    if (size == 0) {
+        std::vector<Price> prices;
+        for (const Order& order : orders) {
+            if (loadable(order)) {
+                prices.push_back(order.price);
             }
         }
-        std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-            return a.price > b.price;
-        });
-    } else {
-        // Find non-empty levels and sort by price ascending
-        for (const auto& level : levels) {
-            if (level.quantity > 0) {
-                result.push_back(level);
+        auto middle = prices.begin() + static_cast<std::ptrdiff_t>(prices.size() / 2);
+        std::nth_element(prices.begin(), middle, prices.end());
+        const Price half = static_cast<Price>(MAX_PRICE_LEVELS * 3 / 8 - 1) * tick_size_;
+        window_low = *middle - half;
+        window_high = *middle + half;
+        low = std::numeric_limits<Price>::max();
+        high = std::numeric_limits<Price>::min();
+        for (const Order& order : orders) {
+            if (loadable(order) && order.price >= window_low && order.price <= window_high) {
+                low = std::min(low, order.price);
+                high = std::max(high, order.price);
             }
         }
-        std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
-            return a.price < b.price;
-        });
+        size = ladder_size(low, high);
     }
+    size_t span = static_cast<size_t>((high - low) / tick_size_) + 1;
     
-    // Limit to requested depth
-    if (result.size() > depth) {
-        result.resize(depth);
+    if (size != bid_levels_.size()) {
+        bid_levels_.assign(size, OrderBookLevel());
+        ask_levels_.assign(size, OrderBookLevel());
+        bid_bitmap_.resize(size);
+        ask_bitmap_.resize(size);
     }
+    base_price_ = low - static_cast<Price>((size - span) / 2) * tick_size_;
+    order_index_.reserve(orders.size());
     
-    return result;
+    // Link every order straight into its level
+    size_t loaded = 0;
+    for (const Order& order : orders) {
+        if (!loadable(order)) {
+            continue;
+        }
+        if (order.price < window_low || order.price > window_high) {
+            out_of_range_orders_++;
+            continue;
+        }
+        
+        OrderNode* node = static_cast<OrderNode*>(node_pool_.allocate());
+        *node = OrderNode{order.id, order.price, order.quantity, order.original_quantity,
+                          order.side, order.timestamp, nullptr, nullptr};
+        if (!order_index_.insert(order.id, node)) {
+            node_pool_.deallocate(node);
+            continue;
+        }
+        
+        auto index = price_to_index(order.price);
+        auto& level = (order.side == Side::BUY) ? bid_levels_[index] : ask_levels_[index];
+        if (level.quantity == 0) {
+            (order.side == Side::BUY ? bid_level_count_ : ask_level_count_)++;
+        }
+        level.price = order.price;
+        level.quantity += order.quantity;
+        link_back(node);
+        ((order.side == Side::BUY) ? bid_bitmap_ : ask_bitmap_).set(index);
+        loaded++;
+    }
+    
+    // Compute the best prices once for the rebuilt ladder
+    size_t best = bid_bitmap_.find_last();
+    best_bid_ = (best != Bitmap::npos) ? std::optional<Price>(bid_levels_[best].price) : std::nullopt;
+    best = ask_bitmap_.find_first();
+    best_ask_ = (best != Bitmap::npos) ? std::optional<Price>(ask_levels_[best].price) : std::nullopt;
+    
+    publish_all();
+    set_stale(false);
+    return loaded;
 }
 
-// Fix for the unused parameter warning in price_to_index
-size_t OrderBook::price_to_index(Price price, Side /*side*/) const {
-    // Simple hashing function for price to index mapping
-    // This is a very basic implementation for demonstration
-    // A more sophisticated approach would be needed for production
-    return static_cast<size_t>(price) % bid_levels_.size();
+void OrderBook::set_published_depth(size_t levels) {
+    published_levels_ = std::min(levels, BOOK_DEPTH_LEVELS);
+    publish_all();
 }
 
-void OrderBook::update_best_prices() {
-    best_bid_ = std::nullopt;
-    best_ask_ = std::nullopt;
+void OrderBook::share_publication(const OrderBook& other) {
+    publication_ = other.publication_;
+    published_levels_ = other.published_levels_;
+}
+
+void OrderBook::publish(Side side, Price price) {
+    const bool bid = side == Side::BUY;
+    const OrderBookLevel& level = (bid ? bid_levels_ : ask_levels_)[price_to_index(price)];
     
-    // Find best bid (highest price)
-    for (const auto& level : bid_levels_) {
-        if (level.quantity > 0) {
-            if (!best_bid_ || level.price > *best_bid_) {
-                best_bid_ = level.price;
+    // Top: only when the best level of the side changed
+    const std::optional<Price>& best = bid ? best_bid_ : best_ask_;
+    BookLevel& top = bid ? top_.bid : top_.ask;
+    BookLevel current;
+    if (best) {
+        current = *best == price ? BookLevel{price, level.quantity, level.order_count} : book_level(side, best);
+    }
+    if (current != top) {
+        top = current;
+        top_.updates = publication_->top.version() + 1;
+        publication_->top.store(top_);
+    }
+    
+    if (published_levels_ == 0) {
+        return;
+    }
+    
+    // Depth: a published level that is still there only changes its entry
+    auto& out = bid ? depth_.bids : depth_.asks;
+    const uint32_t count = bid ? depth_.bid_count : depth_.ask_count;
+    uint32_t entry = 0;
+    while (entry < count && out[entry].price != price) {
+        entry++;
+    }
+    
+    if (entry < count && level.quantity > 0) {
+        out[entry] = BookLevel{price, level.quantity, level.order_count};
+    } else {
+        // Skip changes behind a full side that was and stays truncated (they cannot show)
+        const bool truncated = bid ? depth_.bids_truncated : depth_.asks_truncated;
+        if (count == published_levels_ && truncated && level_count(side) > count &&
+            (bid ? price < out[count - 1].price : price > out[count - 1].price)) {
+            return;
+        }
+        fill_depth(side);
+    }
+    depth_.updates = publication_->depth.version() + 1;
+    publication_->depth.store(depth_);
+}
+
+void OrderBook::publish_all() {
+    top_.bid = book_level(Side::BUY, best_bid_);
+    top_.ask = book_level(Side::SELL, best_ask_);
+    top_.updates = publication_->top.version() + 1;
+    publication_->top.store(top_);
+    
+    fill_depth(Side::BUY);
+    fill_depth(Side::SELL);
+    depth_.updates = publication_->depth.version() + 1;
+    publication_->depth.store(depth_);
+}
+
+void OrderBook::fill_depth(Side side) {
+    const bool bid = side == Side::BUY;
+    auto& out = bid ? depth_.bids : depth_.asks;
+    
+    // Walk the non-empty levels best first
+    uint32_t count = 0;
+    for (const OrderBookLevel& level : levels(side)) {
+        if (count == published_levels_) {
+            break;
+        }
+        out[count++] = BookLevel{level.price, level.quantity, level.order_count};
+    }
+    std::fill(out.begin() + count, out.end(), BookLevel{});
+    
+    (bid ? depth_.bid_count : depth_.ask_count) = count;
+    (bid ? depth_.bids_truncated : depth_.asks_truncated) = level_count(side) > count;
+}
+
+BookLevel OrderBook::book_level(Side side, std::optional<Price> price) const {
+    if (!price) {
+        return BookLevel{};
+    }
+    const OrderBookLevel& level = (side == Side::BUY ? bid_levels_ : ask_levels_)[price_to_index(*price)];
+    return BookLevel{level.price, level.quantity, level.order_count};
+}
+
+std::optional<Quantity> BookDepth::quantity_at(Side side, Price price) const {
+    // Levels are best first: a price passed over is empty
+    for (const BookLevel& level : levels(side)) {
+        if (level.price == price) {
+            return level.quantity;
+        }
+        if (side == Side::BUY ? level.price < price : level.price > price) {
+            return 0;
+        }
+    }
+    const bool truncated = side == Side::BUY ? bids_truncated : asks_truncated;
+    return truncated ? std::nullopt : std::optional<Quantity>(0);
+}
+
+size_t OrderBook::price_to_index(Price price) const {
+    return static_cast<size_t>((price - base_price_) / tick_size_);
+}
+
+bool OrderBook::in_ladder(Price price) const {
+    if (price < base_price_) {
+        return false;
+    }
+    // Unsigned, so a price far above the ladder cannot overflow the offset
+    const uint64_t offset = static_cast<uint64_t>(price) - static_cast<uint64_t>(base_price_);
+    return offset / static_cast<uint64_t>(tick_size_) < bid_levels_.size();
+}
+
+size_t OrderBook::ladder_size(Price low, Price high) const {
+    // Unsigned, so a corrupt price cannot overflow the span
+    const uint64_t span = (static_cast<uint64_t>(high) - static_cast<uint64_t>(low)) /
+                          static_cast<uint64_t>(tick_size_) + 1;
+    if (span > MAX_PRICE_LEVELS / 4 * 3) {
+        return 0;
+    }
+    
+    // Grow the ladder while the range would leave less than a quarter of it
+    // free, so that re-centering stays rare
+    size_t size = bid_levels_.size();
+    while (span * 4 > size * 3) {
+        size *= 2;
+    }
+    return std::min(size, std::max(MAX_PRICE_LEVELS, bid_levels_.size()));
+}
+
+bool OrderBook::recenter(Price price) {
+    // Find the occupied price range across both sides, including the new price
+    Price low = price;
+    Price high = price;
+    
+    for (const Bitmap* bitmap : {&bid_bitmap_, &ask_bitmap_}) {
+        size_t first = bitmap->find_first();
+        if (first != Bitmap::npos) {
+            const auto& levels = (bitmap == &bid_bitmap_) ? bid_levels_ : ask_levels_;
+            low = std::min(low, levels[first].price);
+            high = std::max(high, levels[bitmap->find_last()].price);
+        }
+    }
+    
+    size_t size = ladder_size(low, high);
+    if (size == 0) {
+        return false;  // Wider than the widest ladder
+    }
+    size_t span = static_cast<size_t>((high - low) / tick_size_) + 1;
+    
+    // Center the occupied range in the ladder
+    Price new_base = low - static_cast<Price>((size - span) / 2) * tick_size_;
+    
+    for (Side side : {Side::BUY, Side::SELL}) {
+        auto& levels = (side == Side::BUY) ? bid_levels_ : ask_levels_;
+        auto& bitmap = (side == Side::BUY) ? bid_bitmap_ : ask_bitmap_;
+        
+        // Move non-empty levels to their new slots
+        std::vector<OrderBookLevel> moved(size);
+        for (size_t i = bitmap.find_first(); i != Bitmap::npos; i = bitmap.find_next(i + 1)) {
+            moved[static_cast<size_t>((levels[i].price - new_base) / tick_size_)] = levels[i];
+        }
+        levels.swap(moved);
+        
+        // Rebuild the bitmap for the new layout
+        bitmap.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            if (levels[i].quantity > 0) {
+                bitmap.set(i);
             }
         }
     }
     
-    // Find best ask (lowest price)
-    for (const auto& level : ask_levels_) {
+    base_price_ = new_base;
+    return true;
+}
+
+OrderBookLevel& OrderBook::level_of(const OrderNode& node) {
+    auto index = price_to_index(node.price);
+    return (node.side == Side::BUY) ? bid_levels_[index] : ask_levels_[index];
+}
+
+void OrderBook::add_to_level(Side side, Price price, Quantity quantity) {
+    if (!in_ladder(price)) {
+        recenter(price);
+    }
+    
+    auto index = price_to_index(price);
+    if (side == Side::BUY) {
+        auto& level = bid_levels_[index];
+        if (level.quantity == 0) {
+            bid_bitmap_.set(index);
+            bid_level_count_++;
+        }
+        level.price = price;
+        level.quantity += quantity;
+        
+        // A new order can only improve the best bid
+        if (!best_bid_ || price > *best_bid_) {
+            best_bid_ = price;
+        }
+    } else {
+        auto& level = ask_levels_[index];
+        if (level.quantity == 0) {
+            ask_bitmap_.set(index);
+            ask_level_count_++;
+        }
+        level.price = price;
+        level.quantity += quantity;
+        
+        // A new order can only improve the best ask
+        if (!best_ask_ || price < *best_ask_) {
+            best_ask_ = price;
+        }
+    }
+}
+
+void OrderBook::remove_from_level(Side side, Price price, Quantity quantity) {
+    auto index = price_to_index(price);
+    if (side == Side::BUY) {
+        auto& level = bid_levels_[index];
+        level.quantity -= quantity;
         if (level.quantity > 0) {
-            if (!best_ask_ || level.price < *best_ask_) {
-                best_ask_ = level.price;
-            }
+            return;
+        }
+        
+        // Level emptied, search downwards for the next best bid if needed
+        bid_bitmap_.clear(index);
+        bid_level_count_--;
+        if (best_bid_ && *best_bid_ == price) {
+            size_t next = index == 0 ? Bitmap::npos : bid_bitmap_.find_prev(index - 1);
+            best_bid_ = (next != Bitmap::npos) ? std::optional<Price>(bid_levels_[next].price) : std::nullopt;
+        }
+    } else {
+        auto& level = ask_levels_[index];
+        level.quantity -= quantity;
+        if (level.quantity > 0) {
+            return;
+        }
+        
+        // Level emptied, search upwards for the next best ask if needed
+        ask_bitmap_.clear(index);
+        ask_level_count_--;
+        if (best_ask_ && *best_ask_ == price) {
+            size_t next = ask_bitmap_.find_next(index + 1);
+            best_ask_ = (next != Bitmap::npos) ? std::optional<Price>(ask_levels_[next].price) : std::nullopt;
         }
     }
 }
 
+void OrderBook::link_back(OrderNode* node) {
+    OrderBookLevel& level = level_of(*node);
+    
+    node->prev = level.tail;
+    node->next = nullptr;
+    if (level.tail) {
+        level.tail->next = node;
+    } else {
+        level.head = node;
+    }
+    level.tail = node;
+    level.order_count++;
+}
+
+void OrderBook::unlink(OrderNode* node) {
+    OrderBookLevel& level = level_of(*node);
+    
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        level.head = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        level.tail = node->prev;
+    }
+    node->prev = nullptr;
+    node->next = nullptr;
+    level.order_count--;
+}
+
+void OrderBook::remove_order(OrderNode* node) {
+    unlink(node);
+    remove_from_level(node->side, node->price, node->quantity);
+    order_index_.erase(node->id);
+    node_pool_.deallocate(node);
+}
+
 } // namespace trading
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "trading/core/pair_matrix.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Widest vector used by any kernel, in doubles (rows are padded to it)
+constexpr size_t VECTOR_WIDTH = 8;
+
+// Arguments of one row update
+struct RowUpdate {
+    const double* peers;   // Latest log prices of all symbols
+    double log_price;      // Latest log price of the row's symbol
+    double* slot;          // Ring slot: evicted samples in, new samples out
+    double* means;         // Row means
+    double* m2s;           // Row sums of squared deviations
+    double inv_count;      // 1 / sample count after the update
+    bool evict;            // Window full: the slot holds samples to replace
+    double limit;          // Flag when (x - mean)^2 > limit * m2 and m2 > 0
+    uint64_t* flags;       // Output bits, one per peer
+    size_t stride;         // Row length (multiple of VECTOR_WIDTH)
+};
+
+// Sliding Welford update of one sample, returns true if it crossed the limit
+inline bool update_scalar(const RowUpdate& row, size_t j) {
+    double x = row.log_price - row.peers[j];
+    double mean = row.means[j];
+    double m2 = row.m2s[j];
+    
+    if (row.evict) {
+        double old = row.slot[j];
+        double new_mean = mean + (x - old) * row.inv_count;
+        m2 += (x - old) * (x - new_mean + old - mean);
+        m2 = m2 > 0.0 ? m2 : 0.0;
+        mean = new_mean;
+    } else {
+        double delta = x - mean;
+        mean += delta * row.inv_count;
+        m2 += delta * (x - mean);
+    }
+    
+    row.slot[j] = x;
+    row.means[j] = mean;
+    row.m2s[j] = m2;
+    
+    double deviation = x - mean;
+    return m2 > 0.0 && deviation * deviation > row.limit * m2;
+}
+
+[[maybe_unused]] void update_row_scalar(const RowUpdate& row) {
+    for (size_t j = 0; j < row.stride; ++j) {
+        if (update_scalar(row, j)) {
+            row.flags[j / 64] |= uint64_t{1} << (j % 64);
+        }
+    }
+}
+
+#if defined(__AVX512F__)
+
+void update_row_avx512(const RowUpdate& row) {
+    const __m512d log_price = _mm512_set1_pd(row.log_price);
+    const __m512d inv_count = _mm512_set1_pd(row.inv_count);
+    const __m512d limit = _mm512_set1_pd(row.limit);
+    const __m512d zero = _mm512_setzero_pd();
+    
+    for (size_t j = 0; j < row.stride; j += 8) {
+        __m512d x = _mm512_sub_pd(log_price, _mm512_loadu_pd(row.peers + j));
+        __m512d mean = _mm512_loadu_pd(row.means + j);
+        __m512d m2 = _mm512_loadu_pd(row.m2s + j);
+        
+        if (row.evict) {
+            __m512d old = _mm512_loadu_pd(row.slot + j);
+            __m512d diff = _mm512_sub_pd(x, old);
+            __m512d new_mean = _mm512_fmadd_pd(diff, inv_count, mean);
+            __m512d spread = _mm512_add_pd(_mm512_sub_pd(x, new_mean), _mm512_sub_pd(old, mean));
+            m2 = _mm512_fmadd_pd(diff, spread, m2);
+            m2 = _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(m2, zero, _CMP_GT_OQ), m2);  // Clamp at 0
+            mean = new_mean;
+        } else {
+            __m512d delta = _mm512_sub_pd(x, mean);
+            mean = _mm512_fmadd_pd(delta, inv_count, mean);
+            m2 = _mm512_fmadd_pd(delta, _mm512_sub_pd(x, mean), m2);
+        }
+        
+        _mm512_storeu_pd(row.slot + j, x);
+        _mm512_storeu_pd(row.means + j, mean);
+        _mm512_storeu_pd(row.m2s + j, m2);
+        
+        __m512d deviation = _mm512_sub_pd(x, mean);
+        __mmask8 crossed = _mm512_cmp_pd_mask(_mm512_mul_pd(deviation, deviation),
+                                              _mm512_mul_pd(limit, m2), _CMP_GT_OQ);
+        crossed &= _mm512_cmp_pd_mask(m2, zero, _CMP_GT_OQ);
+        row.flags[j / 64] |= static_cast<uint64_t>(crossed) << (j % 64);
+    }
+}
+
+#elif defined(__AVX2__)
+
+void update_row_avx2(const RowUpdate& row) {
+    const __m256d log_price = _mm256_set1_pd(row.log_price);
+    const __m256d inv_count = _mm256_set1_pd(row.inv_count);
+    const __m256d limit = _mm256_set1_pd(row.limit);
+    const __m256d zero = _mm256_setzero_pd();
+    
+    for (size_t j = 0; j < row.stride; j += 4) {
+        __m256d x = _mm256_sub_pd(log_price, _mm256_loadu_pd(row.peers + j));
+        __m256d mean = _mm256_loadu_pd(row.means + j);
+        __m256d m2 = _mm256_loadu_pd(row.m2s + j);
+        
+        if (row.evict) {
+            __m256d old = _mm256_loadu_pd(row.slot + j);
+            __m256d diff = _mm256_sub_pd(x, old);
+            __m256d new_mean = _mm256_add_pd(mean, _mm256_mul_pd(diff, inv_count));
+            __m256d spread = _mm256_add_pd(_mm256_sub_pd(x, new_mean), _mm256_sub_pd(old, mean));
+            m2 = _mm256_max_pd(_mm256_add_pd(m2, _mm256_mul_pd(diff, spread)), zero);
+            mean = new_mean;
+        } else {
+            __m256d delta = _mm256_sub_pd(x, mean);
+            mean = _mm256_add_pd(mean, _mm256_mul_pd(delta, inv_count));
+            m2 = _mm256_add_pd(m2, _mm256_mul_pd(delta, _mm256_sub_pd(x, mean)));
+        }
+        
+        _mm256_storeu_pd(row.slot + j, x);
+        _mm256_storeu_pd(row.means + j, mean);
+        _mm256_storeu_pd(row.m2s + j, m2);
+        
+        __m256d deviation = _mm256_sub_pd(x, mean);
+        __m256d crossed = _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_mul_pd(deviation, deviation), _mm256_mul_pd(limit, m2), _CMP_GT_OQ),
+            _mm256_cmp_pd(m2, zero, _CMP_GT_OQ));
+        row.flags[j / 64] |= static_cast<uint64_t>(_mm256_movemask_pd(crossed)) << (j % 64);
+    }
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+void update_row_neon(const RowUpdate& row) {
+    const float64x2_t log_price = vdupq_n_f64(row.log_price);
+    const float64x2_t inv_count = vdupq_n_f64(row.inv_count);
+    const float64x2_t limit = vdupq_n_f64(row.limit);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    
+    for (size_t j = 0; j < row.stride; j += 2) {
+        float64x2_t x = vsubq_f64(log_price, vld1q_f64(row.peers + j));
+        float64x2_t mean = vld1q_f64(row.means + j);
+        float64x2_t m2 = vld1q_f64(row.m2s + j);
+        
+        if (row.evict) {
+            float64x2_t old = vld1q_f64(row.slot + j);
+            float64x2_t diff = vsubq_f64(x, old);
+            float64x2_t new_mean = vfmaq_f64(mean, diff, inv_count);
+            float64x2_t spread = vaddq_f64(vsubq_f64(x, new_mean), vsubq_f64(old, mean));
+            m2 = vmaxq_f64(vfmaq_f64(m2, diff, spread), zero);
+            mean = new_mean;
+        } else {
+            float64x2_t delta = vsubq_f64(x, mean);
+            mean = vfmaq_f64(mean, delta, inv_count);
+            m2 = vfmaq_f64(m2, delta, vsubq_f64(x, mean));
+        }
+        
+        vst1q_f64(row.slot + j, x);
+        vst1q_f64(row.means + j, mean);
+        vst1q_f64(row.m2s + j, m2);
+        
+        float64x2_t deviation = vsubq_f64(x, mean);
+        uint64x2_t crossed = vandq_u64(vcgtq_f64(vmulq_f64(deviation, deviation), vmulq_f64(limit, m2)),
+                                       vcgtq_f64(m2, zero));
+        uint64_t bits = (vgetq_lane_u64(crossed, 0) & 1) | ((vgetq_lane_u64(crossed, 1) & 1) << 1);
+        row.flags[j / 64] |= bits << (j % 64);
+    }
+}
+
+#endif
+
+// Update a row with the widest kernel the build targets
+void update_row(const RowUpdate& row) {
+#if defined(__AVX512F__)
+    update_row_avx512(row);
+#elif defined(__AVX2__)
+    update_row_avx2(row);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    update_row_neon(row);
+#else
+    update_row_scalar(row);
+#endif
+}
+
+} // namespace
+
+PairMatrix::PairMatrix(size_t symbols, size_t window) {
+    reset(symbols, window);
+}
+
+void PairMatrix::reset(size_t symbols, size_t window) {
+    symbols_ = symbols;
+    stride_ = (symbols + VECTOR_WIDTH - 1) / VECTOR_WIDTH * VECTOR_WIDTH;
+    window_ = window > 0 ? window : 1;
+    
+    // Padding columns get a fixed price so they never produce NaNs
+    log_prices_.assign(stride_, 0.0);
+    for (size_t i = 0; i < symbols_; ++i) {
+        log_prices_[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    means_.assign(symbols_ * stride_, 0.0);
+    m2s_.assign(symbols_ * stride_, 0.0);
+    ring_.assign(symbols_ * window_ * stride_, 0.0);
+    counts_.assign(symbols_, 0);
+    heads_.assign(symbols_, 0);
+    replacements_.assign(symbols_, 0);
+    updates_.assign(symbols_, 0);
+    pair_starts_.assign(symbols_ * stride_, 0);
+    flags_.assign((stride_ + 63) / 64, 0);
+}
+
+size_t PairMatrix::update(size_t symbol, double log_price, double threshold, PairSignal* out) {
+    const bool first_price = std::isnan(log_prices_[symbol]);
+    log_prices_[symbol] = log_price;
+    if (first_price) {
+        start_pairs(symbol);
+    }
+    
+    size_t& count = counts_[symbol];
+    size_t& head = heads_[symbol];
+    bool evict = count == window_;
+    if (!evict) {
+        count++;
+    }
+    
+    double* slot = &ring_[(symbol * window_ + head) * stride_];
+    head = (head + 1 == window_) ? 0 : head + 1;
+    
+    // |z| > threshold  <=>  (x - mean)^2 > threshold^2 * m2 / count
+    double inv_count = 1.0 / static_cast<double>(count);
+    RowUpdate row{log_prices_.data(), log_price, slot,
+                  &means_[symbol * stride_], &m2s_[symbol * stride_],
+                  inv_count, evict, threshold * threshold * inv_count,
+                  flags_.data(), stride_};
+    
+    std::fill(flags_.begin(), flags_.end(), 0);
+    update_row(row);
+    updates_[symbol]++;
+    
+    if (evict && ++replacements_[symbol] == RECOMPUTE_INTERVAL) {
+        recompute(symbol);
+    }
+    
+    if (count < window_) {
+        return 0;  // Window not full yet
+    }
+    
+    // Turn the crossing flags into signals
+    size_t signals = 0;
+    for (size_t word = 0; word < flags_.size(); ++word) {
+        for (uint64_t bits = flags_[word]; bits != 0; bits &= bits - 1) {
+            size_t peer = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+            if (peer >= symbols_) {
+                break;  // Padding
+            }
+            if (updates_[symbol] - pair_starts_[symbol * stride_ + peer] < window_) {
+                continue;  // Pair not ready (an unpriced peer never crosses)
+            }
+            
+            double deviation = slot[peer] - row.means[peer];
+            out[signals++] = PairSignal{static_cast<uint32_t>(peer),
+                                        deviation / std::sqrt(row.m2s[peer] * inv_count)};
+        }
+    }
+    
+    return signals;
+}
+
+double PairMatrix::variance(size_t symbol, size_t peer) const {
+    size_t count = counts_[symbol];
+    return count > 0 ? m2s_[symbol * stride_ + peer] / static_cast<double>(count) : 0.0;
+}
+
+const char* PairMatrix::kernel_name() {
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void PairMatrix::start_pairs(size_t symbol) {
+    // Samples taken while the symbol had no price are NaN; the refilled ones
+    // are placeholders that leave the ring within a window of row updates
+    for (size_t row = 0; row < symbols_; ++row) {
+        pair_starts_[row * stride_ + symbol] = updates_[row];
+        if (row == symbol || updates_[row] == 0) {
+            continue;  // No samples yet
+        }
+        
+        double x = log_prices_[row] - log_prices_[symbol];
+        double* ring = &ring_[row * window_ * stride_];
+        for (size_t k = 0; k < counts_[row]; ++k) {
+            ring[k * stride_ + symbol] = x;
+        }
+        means_[row * stride_ + symbol] = x;
+        m2s_[row * stride_ + symbol] = 0.0;
+    }
+}
+
+void PairMatrix::recompute(size_t symbol) {
+    double* means = &means_[symbol * stride_];
+    double* m2s = &m2s_[symbol * stride_];
+    const double* ring = &ring_[symbol * window_ * stride_];
+    const double inv_count = 1.0 / static_cast<double>(counts_[symbol]);
+    
+    for (size_t j = 0; j < stride_; ++j) {
+        means[j] = 0.0;
+        m2s[j] = 0.0;
+    }
+    
+    // Two passes over the ring, each streaming whole slots
+    for (size_t k = 0; k < counts_[symbol]; ++k) {
+        for (size_t j = 0; j < stride_; ++j) {
+            means[j] += ring[k * stride_ + j];
+        }
+    }
+    for (size_t j = 0; j < stride_; ++j) {
+        means[j] *= inv_count;
+    }
+    for (size_t k = 0; k < counts_[symbol]; ++k) {
+        for (size_t j = 0; j < stride_; ++j) {
+            double deviation = ring[k * stride_ + j] - means[j];
+            m2s[j] += deviation * deviation;
+        }
+    }
+    
+    replacements_[symbol] = 0;
+}
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "trading/core/risk_gate.h"
+#include "trading/support/config.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace trading {
+
+RiskLimits RiskLimits::from_config(const ConfigManager& config) {
+    RiskLimits result;
+    auto read = [&config](const char* key, auto& field) {
+        if (config.has(key)) {
+            field = static_cast<std::remove_reference_t<decltype(field)>>(config.get(key).as_long());
+        }
+    };
+    
+    read("risk.max_order_quantity", result.max_order_quantity);
+    read("risk.max_order_notional", result.max_order_notional);
+    read("risk.max_price_deviation_bps", result.max_price_deviation_bps);
+    read("risk.max_position", result.max_position);
+    read("risk.max_orders_per_second", result.max_orders_per_second);
+    read("risk.burst", result.burst);
+    
+    return result;
+}
+
+RiskGate::RiskGate(std::shared_ptr<ExecutionEngine> execution, RiskLimits limits, size_t max_symbols)
+    : RiskGate(std::move(execution), std::make_shared<RcuCell<RiskLimits>>(limits), max_symbols) {
+}
+
+RiskGate::RiskGate(std::shared_ptr<ExecutionEngine> execution, std::shared_ptr<const RcuCell<RiskLimits>> limits,
+                   size_t max_symbols)
+    : execution_(std::move(execution)), limits_(std::move(limits)),
+      symbols_(std::make_unique<SymbolRisk[]>(max_symbols)), max_symbols_(max_symbols),
+      rate_tat_ns_(0), last_rejection_(RiskResult::ACCEPTED) {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+OrderId RiskGate::submit(const Signal& signal) {
+    // One consistent set of limits for the whole check
+    const RiskLimits& limits = *limits_->load();
+    
+    RiskResult result = evaluate(signal, limits);
+    if (result != RiskResult::ACCEPTED) [[unlikely]] {
+        return reject(result);
+    }
+    
+    // Reserve the open quantity first so concurrent submitters cannot both
+    // pass the position check
+    SymbolRisk& risk = symbols_[signal.symbol_id];
+    const bool buy = signal.type == SignalType::BUY;
+    std::atomic<int64_t>& open = buy ? risk.open_buy : risk.open_sell;
+    int64_t quantity = signal.quantity;
+    int64_t open_after = open.fetch_add(quantity, std::memory_order_relaxed) + quantity;
+    
+    if (limits.max_position > 0) {
+        int64_t position = risk.position.load(std::memory_order_relaxed);
+        int64_t worst = buy ? position + open_after : open_after - position;
+        if (worst > limits.max_position) [[unlikely]] {
+            open.fetch_sub(quantity, std::memory_order_relaxed);
+            return reject(RiskResult::REJECTED_POSITION);
+        }
+    }
+    
+    if (!acquire_rate(static_cast<int64_t>(execution_->now()), limits)) [[unlikely]] {
+        open.fetch_sub(quantity, std::memory_order_relaxed);
+        return reject(RiskResult::REJECTED_RATE);
+    }
+    
+    OrderId order_id = execution_->submit_order(signal);
+    if (order_id == 0) [[unlikely]] {
+        open.fetch_sub(quantity, std::memory_order_relaxed);
+        return reject(RiskResult::REJECTED_EXECUTION);
+    }
+    
+    counts_[static_cast<size_t>(RiskResult::ACCEPTED)].fetch_add(1, std::memory_order_relaxed);
+    return order_id;
+}
+
+void RiskGate::on_signals(std::span<const Signal> signals) {
+    for (const Signal& signal : signals) {
+        submit(signal);
+    }
+}
+
+void RiskGate::on_execution_report(const ExecutionReport& report) {
+    if (report.symbol_id >= max_symbols_) {
+        return;
+    }
+    
+    SymbolRisk& risk = symbols_[report.symbol_id];
+    std::atomic<int64_t>& open = report.side == Side::BUY ? risk.open_buy : risk.open_sell;
+    
+    switch (report.status) {
+        case OrderStatus::PARTIALLY_FILLED:
+        case OrderStatus::FILLED: {
+            int64_t quantity = report.exec_quantity;
+            risk.position.fetch_add(report.side == Side::BUY ? quantity : -quantity, std::memory_order_relaxed);
+            open.fetch_sub(quantity, std::memory_order_relaxed);
+            break;
+        }
+        
+        case OrderStatus::CANCELED:
+        case OrderStatus::REJECTED:
+            open.fetch_sub(report.leaves_quantity, std::memory_order_relaxed);
+            break;
+        
+        default:
+            break;
+    }
+}
+
+void RiskGate::set_reference_price(SymbolId symbol_id, Price price) {
+    if (symbol_id < max_symbols_) {
+        symbols_[symbol_id].reference_price.store(price, std::memory_order_relaxed);
+    }
+}
+
+RiskResult RiskGate::check(const Signal& signal) const {
+    const RiskLimits& limits = *limits_->load();
+    RiskResult result = evaluate(signal, limits);
+    if (result != RiskResult::ACCEPTED || limits.max_position == 0) {
+        return result;
+    }
+    
+    const SymbolRisk& risk = symbols_[signal.symbol_id];
+    int64_t position = risk.position.load(std::memory_order_relaxed);
+    int64_t worst = signal.type == SignalType::BUY
+        ? position + risk.open_buy.load(std::memory_order_relaxed) + signal.quantity
+        : risk.open_sell.load(std::memory_order_relaxed) + signal.quantity - position;
+    return worst > limits.max_position ? RiskResult::REJECTED_POSITION : RiskResult::ACCEPTED;
+}
+
+int64_t RiskGate::position(SymbolId symbol_id) const {
+    return symbol_id < max_symbols_ ? symbols_[symbol_id].position.load(std::memory_order_relaxed) : 0;
+}
+
+int64_t RiskGate::open_buy_quantity(SymbolId symbol_id) const {
+    return symbol_id < max_symbols_ ? symbols_[symbol_id].open_buy.load(std::memory_order_relaxed) : 0;
+}
+
+int64_t RiskGate::open_sell_quantity(SymbolId symbol_id) const {
+    return symbol_id < max_symbols_ ? symbols_[symbol_id].open_sell.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t RiskGate::count(RiskResult result) const {
+    return counts_[static_cast<size_t>(result)].load(std::memory_order_relaxed);
+}
+
+RiskResult RiskGate::evaluate(const Signal& signal, const RiskLimits& limits) const {
+    if (signal.symbol_id >= max_symbols_ || signal.type == SignalType::NONE) [[unlikely]] {
+        return RiskResult::REJECTED_SYMBOL;
+    }
+    
+    const int64_t quantity = signal.quantity;
+    const Price reference = symbols_[signal.symbol_id].reference_price.load(std::memory_order_relaxed);
+    const Price deviation = signal.price > reference ? signal.price - reference : reference - signal.price;
+    
+    // Evaluate every check without branching; only a failure pays for
+    // finding out which one
+    const bool bad_quantity = quantity == 0 ||
+        (limits.max_order_quantity > 0 && signal.quantity > limits.max_order_quantity);
+    const bool bad_notional = limits.max_order_notional > 0 &&
+        signal.price * quantity > limits.max_order_notional;
+    const bool bad_price = limits.max_price_deviation_bps > 0 && reference > 0 &&
+        deviation * 10000 > reference * static_cast<Price>(limits.max_price_deviation_bps);
+    
+    if ((bad_quantity | bad_notional | bad_price) == 0) [[likely]] {
+        return RiskResult::ACCEPTED;
+    }
+    if (bad_quantity) {
+        return RiskResult::REJECTED_QUANTITY;
+    }
+    return bad_notional ? RiskResult::REJECTED_NOTIONAL : RiskResult::REJECTED_PRICE;
+}
+
+bool RiskGate::acquire_rate(int64_t now_ns, const RiskLimits& limits) {
+    if (limits.max_orders_per_second == 0) {
+        return true;  // No rate limit
+    }
+    
+    // Nanoseconds between orders at the limit rate, and the burst tolerance
+    // (derived per order, so a live rate change applies to the next one)
+    const int64_t interval_ns = 1000000000LL / limits.max_orders_per_second;
+    const int64_t tolerance_ns = interval_ns * std::max<int64_t>(limits.burst, 1);
+    
+    int64_t tat = rate_tat_ns_.load(std::memory_order_relaxed);
+    for (;;) {
+        int64_t start = std::max(tat, now_ns);
+        if (start - now_ns >= tolerance_ns) {
+            return false;  // Burst used up
+        }
+        if (rate_tat_ns_.compare_exchange_weak(tat, start + interval_ns, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+OrderId RiskGate::reject(RiskResult result) {
+    counts_[static_cast<size_t>(result)].fetch_add(1, std::memory_order_relaxed);
+    last_rejection_.store(result, std::memory_order_relaxed);
+    return 0;
+}
+
+} // namespace trading
\ No newline at end of file
@@ -1,133 +1,165 @@
 #include "trading/core/strategy_engine.h"
 #include "trading/core/market_data.h"
+#include "trading/support/config.h"
+#include "trading/utils/perf_counters.h"
+#include "trading/utils/tsc_clock.h"
 #include <algorithm>
 #include <cmath>
-#include <numeric>
 
 namespace trading {
 
+namespace {
+
+// Mid and order prices of StatArbitrageStrategy: a half-cent mid is exact and
+// rounds down to the tick for buys and up for sells
+using StatArbPrice = StatArbitrageStrategy::PriceValue;
+constexpr auto HALF_CENT_MID = StatArbPrice::midpoint(StatArbPrice::from_raw(10000), StatArbPrice::from_raw(10001));
+static_assert(HALF_CENT_MID.raw() == 100005);
+static_assert(HALF_CENT_MID.rescale<StatArbPrice::decimals>(Rounding::DOWN)->raw() == 10000);
+static_assert(HALF_CENT_MID.rescale<StatArbPrice::decimals>(Rounding::UP)->raw() == 10001);
+static_assert(StatArbPrice::from_raw(10003).round_to_tick(StatArbPrice::from_raw(5), Rounding::UP).raw() == 10005);
+
+} // anonymous namespace
+
+//
+// Strategy Implementation
+//
+
+std::vector<Signal> Strategy::process_update(const std::shared_ptr<OrderBook>& order_book) {
+    // Adapter around the buffer interface
+    SignalBuffer buffer;
+    process_update(*order_book, buffer);
+    return std::vector<Signal>(buffer.begin(), buffer.end());
+}
+
+//
+// LegacyStrategy Implementation
+//
+
+void LegacyStrategy::process_update(const OrderBook& order_book, SignalBuffer& signals) {
+    // Adapter around the vector interface; the shared_ptr aliases the book
+    // without owning it
+    std::shared_ptr<OrderBook> view(std::shared_ptr<OrderBook>(), const_cast<OrderBook*>(&order_book));
+    for (const auto& signal : process_update(view)) {
+        signals.push(signal);
+    }
+}
+
 //
 // StatArbitrageStrategy Implementation
 //
 
+StatArbParameters StatArbParameters::from_config(const ConfigManager& config) {
+    StatArbParameters result;
+    result.z_score_threshold = config.get("strategy.stat_arb.z_score_threshold", "2.0").as_double();
+    return result;
+}
+
 StatArbitrageStrategy::StatArbitrageStrategy(std::vector<std::string> symbols, 
                                          double z_score_threshold, 
                                          size_t window_size)
+    : StatArbitrageStrategy(std::move(symbols),
+                            std::make_shared<RcuCell<StatArbParameters>>(StatArbParameters{z_score_threshold}),
+                            window_size) {
+}
+
+StatArbitrageStrategy::StatArbitrageStrategy(std::vector<std::string> symbols,
+                                         std::shared_ptr<const RcuCell<StatArbParameters>> parameters,
+                                         size_t window_size)
     : symbols_(std::move(symbols)), 
-      z_score_threshold_(z_score_threshold), 
+      parameters_(std::move(parameters)),
       window_size_(window_size) {
 }
 
 void StatArbitrageStrategy::initialize() {
-    // Initialize price history for each symbol
-    for (const auto& symbol : symbols_) {
-        price_history_[symbol] = std::vector<double>();
-        price_history_[symbol].reserve(window_size_ * 2);  // Extra space for efficiency
-    }
+    // Pre-size the pair matrix so updates never allocate
+    pairs_.reset(symbols_.size(), window_size_);
+    pair_signals_.assign(symbols_.size(), PairSignal{});
+    slot_by_symbol_id_.clear();
 }
 
-std::vector<Signal> StatArbitrageStrategy::process_update(const std::shared_ptr<OrderBook>& order_book) {
-    std::vector<Signal> signals;
-    
-    // Get symbol from order book
-    std::string symbol(order_book->symbol());
-    
+void StatArbitrageStrategy::process_update(const OrderBook& order_book, SignalBuffer& signals) {
     // Check if we're tracking this symbol
-    auto it = price_history_.find(symbol);
-    if (it == price_history_.end()) {
-        return signals;  // Not tracking this symbol
+    int32_t slot = resolve_slot(order_book);
+    if (slot < 0) {
+        return;  // Not tracking this symbol
     }
     
-    // Get mid price
-    auto mid_price_opt = order_book->mid_price();
-    if (!mid_price_opt) {
-        return signals;  // No mid price available
+    // Get the exact mid price, one digit finer than the book so half ticks are kept
+    auto bid = order_book.best_bid();
+    auto ask = order_book.best_ask();
+    if (!bid || !ask) {
+        return;  // No mid price available
     }
-    
-    // Convert to double and store in history
-    double mid_price = static_cast<double>(*mid_price_opt);
-    it->second.push_back(mid_price);
-    
-    // Limit history size
-    if (it->second.size() > window_size_) {
-        it->second.erase(it->second.begin());
+    const auto mid = PriceValue::midpoint(PriceValue::from_raw(*bid), PriceValue::from_raw(*ask));
+    if (mid.raw() <= 0) {
+        return;  // No usable mid price
     }
     
-    // We need at least window_size samples to calculate signals
-    if (it->second.size() < window_size_) {
-        return signals;
+    // Update the symbol's log price ratios against all peers in one pass and
+    // collect the peers whose z-score crossed the threshold; the decimal
+    // scale cancels in every ratio, so the raw mid is the one conversion
+    double log_price = std::log(static_cast<double>(mid.raw()));
+    const double threshold = parameters_->load()->z_score_threshold;
+    size_t crossed = pairs_.update(slot, log_price, threshold, pair_signals_.data());
+    if (crossed == 0) {
+        return;
     }
     
-    // Calculate signals for pairs
-    for (const auto& other_symbol : symbols_) {
-        if (other_symbol == symbol) {
-            continue;  // Skip self
-        }
+    // Order prices on the book's tick: a mid between ticks buys a tick below
+    // and sells a tick above
+    const PriceValue tick = PriceValue::from_raw(order_book.tick_size());
+    const Price buy_price =
+        mid.rescale<PriceValue::decimals>(Rounding::DOWN)->round_to_tick(tick, Rounding::DOWN).raw();
+    const Price sell_price =
+        mid.rescale<PriceValue::decimals>(Rounding::UP)->round_to_tick(tick, Rounding::UP).raw();
+    
+    // Generate signals based on Z-score
+    for (size_t i = 0; i < crossed; ++i) {
+        double z_score = pair_signals_[i].z_score;
+        SignalType signal_type = (z_score > 0) ? SignalType::SELL : SignalType::BUY;
         
-        // Calculate Z-score
-        double z_score = calculate_z_score(symbol, other_symbol);
+        // Generate signal with market price and confidence based on Z-score
+        double confidence = std::min(std::abs(z_score) / (2 * threshold), 1.0);
         
-        // Generate signals based on Z-score
-        if (std::abs(z_score) > z_score_threshold_) {
-            SignalType signal_type = (z_score > 0) ? SignalType::SELL : SignalType::BUY;
-            
-            // Generate signal with market price and confidence based on Z-score
-            double confidence = std::min(std::abs(z_score) / (2 * z_score_threshold_), 1.0);
-            
-            signals.emplace_back(
-                signal_type,
-                symbol,
-                *mid_price_opt,
-                100,  // Default quantity
-                confidence,
-                static_cast<Timestamp>(std::chrono::system_clock::now().time_since_epoch().count())
-            );
-        }
+        signals.emplace(
+            signal_type,
+            order_book.symbol_id(),
+            signal_type == SignalType::BUY ? buy_price : sell_price,
+            100,  // Default quantity
+            confidence,
+            static_cast<Timestamp>(TscClock::now_ns())
+        );
     }
-    
-    return signals;
 }
 
 std::string StatArbitrageStrategy::name() const {
     return "StatisticalArbitrage";
 }
 
-double StatArbitrageStrategy::calculate_z_score(const std::string& symbol1, const std::string& symbol2) {
-    const auto& prices1 = price_history_[symbol1];
-    const auto& prices2 = price_history_[symbol2];
-    
-    size_t min_size = std::min(prices1.size(), prices2.size());
-    if (min_size < 2) {
-        return 0.0;  // Not enough data
+int32_t StatArbitrageStrategy::resolve_slot(const OrderBook& order_book) {
+    SymbolId symbol_id = order_book.symbol_id();
+    if (symbol_id == INVALID_SYMBOL_ID) {
+        return -1;
     }
     
-    // Calculate price ratio series
-    std::vector<double> ratios;
-    ratios.reserve(min_size);
-    
-    for (size_t i = 0; i < min_size; ++i) {
-        ratios.push_back(prices1[prices1.size() - min_size + i] / prices2[prices2.size() - min_size + i]);
+    if (symbol_id >= slot_by_symbol_id_.size()) {
+        slot_by_symbol_id_.resize(symbol_id + 1, -2);
     }
     
-    // Calculate mean
-    double mean = std::accumulate(ratios.begin(), ratios.end(), 0.0) / ratios.size();
-    
-    // Calculate standard deviation
-    double sq_sum = std::inner_product(ratios.begin(), ratios.end(), ratios.begin(), 0.0,
-                                      std::plus<>(), [mean](double x, double y) {
-                                          return (x - mean) * (y - mean);
-                                      });
-    double std_dev = std::sqrt(sq_sum / ratios.size());
-    
-    if (std_dev == 0.0) {
-        return 0.0;  // Avoid division by zero
+    // First update for this symbol ID: match it against the configured names once
+    int32_t& slot = slot_by_symbol_id_[symbol_id];
+    if (slot == -2) {
+        slot = -1;
+        for (size_t i = 0; i < symbols_.size(); ++i) {
+            if (symbols_[i] == order_book.symbol()) {
+                slot = static_cast<int32_t>(i);
+                break;
+            }
+        }
     }
     
-    // Calculate current ratio
-    double current_ratio = prices1.back() / prices2.back();
-    
-    // Calculate Z-score
-    return (current_ratio - mean) / std_dev;
+    return slot;
 }
 
 //
@@ -135,7 +167,7 @@ double StatArbitrageStrategy::calculate_z_score(const std::string& symbol1, cons
 //
 
 StrategyEngine::StrategyEngine(std::shared_ptr<MarketDataHandler> market_data)
-    : market_data_(std::move(market_data)), running_(false) {
+    : market_data_(std::move(market_data)), signal_sink_(nullptr), running_(false) {
 }
 
 void StrategyEngine::start() {
@@ -156,6 +188,11 @@ void StrategyEngine::stop() {
 }
 
 void StrategyEngine::register_strategy(std::shared_ptr<Strategy> strategy) {
+    if (strategy->delivery() == DeliveryMode::PER_EVENT) {
+        per_event_.push_back(strategy.get());
+    } else {
+        conflated_.push_back(strategy.get());
+    }
     strategies_.push_back(std::move(strategy));
 }
 
@@ -163,20 +200,59 @@ void StrategyEngine::set_signal_callback(std::function<void(const Signal&)> call
     signal_callback_ = std::move(callback);
 }
 
+void StrategyEngine::set_signal_sink(SignalSink* sink) {
+    signal_sink_ = sink;
+}
+
 void StrategyEngine::process_order_book(const std::shared_ptr<OrderBook>& order_book) {
+    process_order_book(*order_book);
+}
+
+void StrategyEngine::process_order_book(const OrderBook& order_book) {
+    run(strategies_, order_book);
+}
+
+void StrategyEngine::process_event(const OrderBook& order_book) {
+    if (!per_event_.empty()) {
+        run(per_event_, order_book);
+    }
+}
+
+void StrategyEngine::process_conflated(const OrderBook& order_book) {
+    if (!conflated_.empty()) {
+        run(conflated_, order_book);
+    }
+}
+
+template<typename Strategies>
+void StrategyEngine::run(const Strategies& strategies, const OrderBook& order_book) {
     if (!running_) {
         return;  // Not running
     }
     
-    // Process the order book with each strategy
-    for (auto& strategy : strategies_) {
-        auto signals = strategy->process_update(order_book);
-        
-        // Emit signals
-        if (signal_callback_) {
-            for (const auto& signal : signals) {
-                signal_callback_(signal);
-            }
+    if (order_book.is_stale()) {
+        return;  // Don't trade on a book that missed updates
+    }
+    
+    // Collect the signals of every strategy into the reused buffer
+    signals_.clear();
+    {
+        TRADING_PERF_SCOPE(STRATEGY_UPDATE);
+        for (const auto& strategy : strategies) {
+            strategy->process_update(order_book, signals_);
+        }
+    }
+    
+    if (signals_.empty()) {
+        return;
+    }
+    
+    // Emit signals
+    if (signal_sink_) {
+        signal_sink_->on_signals(signals_.signals());
+    } else if (signal_callback_) {
+        for (const auto& signal : signals_) {
+            signal_callback_(signal);
         }
     }
 }
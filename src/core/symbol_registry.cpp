@@ -0,0 +1,80 @@
+#include "trading/core/symbol_registry.h"
+
+namespace trading {
+
+SymbolRegistry::SymbolRegistry(size_t expected_symbols) : mask_(0) {
+    size_t capacity = 16;
+    while (capacity < expected_symbols * 2) {
+        capacity *= 2;
+    }
+    rehash(capacity);
+}
+
+SymbolId SymbolRegistry::intern(std::string_view symbol) {
+    SymbolId existing = find(symbol);
+    if (existing != INVALID_SYMBOL_ID) {
+        return existing;
+    }
+    
+    // Keep the load factor at or below one half
+    if ((names_.size() + 1) * 2 > table_.size()) {
+        rehash(table_.size() * 2);
+    }
+    
+    SymbolId id = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(symbol);
+    
+    uint32_t h = hash(symbol);
+    size_t i = h & mask_;
+    while (table_[i].id != INVALID_SYMBOL_ID) {
+        i = (i + 1) & mask_;
+    }
+    table_[i] = Slot{h, id};
+    
+    return id;
+}
+
+SymbolId SymbolRegistry::find(std::string_view symbol) const {
+    uint32_t h = hash(symbol);
+    for (size_t i = h & mask_;; i = (i + 1) & mask_) {
+        const Slot& slot = table_[i];
+        if (slot.id == INVALID_SYMBOL_ID) {
+            return INVALID_SYMBOL_ID;
+        }
+        if (slot.hash == h && names_[slot.id] == symbol) {
+            return slot.id;
+        }
+    }
+}
+
+std::string_view SymbolRegistry::name(SymbolId id) const {
+    if (id >= names_.size()) {
+        return {};
+    }
+    return names_[id];
+}
+
+uint32_t SymbolRegistry::hash(std::string_view symbol) {
+    uint32_t h = 2166136261u;
+    for (char c : symbol) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void SymbolRegistry::rehash(size_t capacity) {
+    table_.assign(capacity, Slot{0, INVALID_SYMBOL_ID});
+    mask_ = capacity - 1;
+    
+    for (SymbolId id = 0; id < names_.size(); ++id) {
+        uint32_t h = hash(names_[id]);
+        size_t i = h & mask_;
+        while (table_[i].id != INVALID_SYMBOL_ID) {
+            i = (i + 1) & mask_;
+        }
+        table_[i] = Slot{h, id};
+    }
+}
+
+} // namespace trading
\ No newline at end of file
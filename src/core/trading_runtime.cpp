@@ -0,0 +1,371 @@
+#include "trading/core/trading_runtime.h"
+#include "trading/support/config.h"
+#include "trading/utils/cpu_affinity.h"
+#include "trading/utils/tsc_clock.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace trading {
+
+RuntimeConfig RuntimeConfig::from_config(const ConfigManager& config) {
+    RuntimeConfig result;
+    
+    result.shard_cpus = config.get("runtime.shard_cpus").as_int_list();
+    result.shards = config.has("runtime.shards")
+        ? config.get("runtime.shards").as_uint()
+        : std::max<size_t>(result.shard_cpus.size(), 1);
+    result.feed_cpu = config.get("runtime.feed_cpu", "-1").as_int();
+    result.risk_cpu = config.get("runtime.risk_cpu", "-1").as_int();
+    result.execution_cpu = config.get("runtime.execution_cpu", "-1").as_int();
+    result.packet_slots = config.get("runtime.packet_slots", "1024").as_uint();
+    result.packet_size = config.get("runtime.packet_size", "65536").as_uint();
+    result.huge_pages = config.get("runtime.huge_pages", "false").as_bool();
+    result.lock_memory = config.get("runtime.lock_memory", "false").as_bool();
+    result.warm_start = config.get("runtime.warm_start", "false").as_bool();
+    result.orders_per_book = config.get("runtime.orders_per_book", "4096").as_uint();
+    result.warm_up_rounds = config.get("runtime.warm_up_rounds", "64").as_uint();
+    result.warm_up_price = config.get("runtime.warm_up_price", "10000").as_int();
+    
+    return result;
+}
+
+void TradingRuntime::ShardSink::on_signals(std::span<const Signal> signals) {
+    for (const Signal& signal : signals) {
+        if (!queue_.try_push(signal)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+TradingRuntime::Shard::Shard(std::shared_ptr<MarketDataHandler> market_data, std::atomic<uint64_t>& dropped_signals)
+    : strategies(std::move(market_data)), sink(signals, dropped_signals) {
+    strategies.set_signal_sink(&sink);
+}
+
+TradingRuntime::TradingRuntime(std::shared_ptr<MarketDataHandler> market_data, RuntimeConfig config,
+                               ExecutionConfig execution, RiskLimits limits)
+    : market_data_(std::move(market_data)), config_(std::move(config)),
+      packet_count_(0), dropped_packets_(0), event_count_(0), signal_count_(0), dropped_signals_(0),
+      running_(false) {
+    config_.shards = std::max<size_t>(config_.shards, 1);
+    config_.packet_slots = std::clamp<size_t>(config_.packet_slots, 1, MAX_PACKET_SLOTS);
+    
+    // The execution stage polls a lock-free ring on its own core
+    execution.mode = ExecutionMode::BUSY_POLL;
+    if (config_.execution_cpu >= 0) {
+        execution.cpu = config_.execution_cpu;
+    }
+    execution_ = std::make_shared<ExecutionEngine>(market_data_, execution);
+    risk_ = std::make_shared<RiskGate>(execution_, limits, std::max<size_t>(market_data_->symbols().size(), 1));
+    
+    execution_->set_execution_callback([this](const ExecutionReport& report) {
+        risk_->on_execution_report(report);
+        if (execution_callback_) {
+            execution_callback_(report);
+        }
+    });
+    
+    // Packet buffers, all free (pre-faulted so the first packets do not fault)
+    packet_pages_ = allocate_pages(config_.packet_slots * config_.packet_size, config_.huge_pages, true);
+    packet_memory_ = static_cast<uint8_t*>(packet_pages_.memory);
+    if (!packet_memory_) {
+        config_.packet_slots = 0;  // publish() refuses every packet
+    }
+    packet_refs_ = std::make_unique<std::atomic<uint32_t>[]>(config_.packet_slots);
+    free_packets_ = std::make_unique<MpscQueue<uint32_t, MAX_PACKET_SLOTS>>();
+    packets_ = std::make_unique<LockFreeQueue<Packet, PACKET_QUEUE_CAPACITY>>();
+    for (uint32_t slot = 0; slot < config_.packet_slots; ++slot) {
+        free_packets_->try_push(slot);
+    }
+    
+    // Shards
+    for (size_t i = 0; i < config_.shards; ++i) {
+        auto shard = std::make_unique<Shard>(market_data_, dropped_signals_);
+        shard->index = i;
+        shard->cpu = i < config_.shard_cpus.size() ? config_.shard_cpus[i] : -1;
+        shard->dirty.resize(market_data_->symbols().size());
+        shards_.push_back(std::move(shard));
+    }
+}
+
+TradingRuntime::~TradingRuntime() {
+    stop();
+    free_pages(packet_pages_);
+}
+
+void TradingRuntime::add_strategies(const StrategyFactory& factory) {
+    const SymbolRegistry& symbols = market_data_->symbols();
+    
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        std::vector<std::string> names;
+        for (SymbolId id = 0; id < symbols.size(); ++id) {
+            if (shard_of(id) == i) {
+                names.emplace_back(symbols.name(id));
+            }
+        }
+        factory(i, names, shards_[i]->strategies);
+    }
+}
+
+void TradingRuntime::set_execution_callback(std::function<void(const ExecutionReport&)> callback) {
+    execution_callback_ = std::move(callback);
+}
+
+void TradingRuntime::start() {
+    if (running_) {
+        return;  // Already running
+    }
+    
+    running_ = true;
+    
+    if (config_.lock_memory && !memory_locked_) {
+        memory_locked_ = lock_memory();
+    }
+    
+    // Start from the back of the pipeline so every stage has a consumer
+    execution_->start();
+    risk_thread_ = std::thread(&TradingRuntime::run_risk, this);
+    for (auto& shard : shards_) {
+        shard->strategies.start();
+        shard->thread = std::thread(&TradingRuntime::run_shard, this, std::ref(*shard));
+    }
+    
+    // Market data flows only once every shard has its books in place
+    for (auto& shard : shards_) {
+        while (!shard->ready.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    feed_thread_ = std::thread(&TradingRuntime::run_feed, this);
+}
+
+void TradingRuntime::stop() {
+    if (!running_) {
+        return;  // Already stopped
+    }
+    
+    running_ = false;
+    
+    // Stop from the front of the pipeline
+    if (feed_thread_.joinable()) {
+        feed_thread_.join();
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+        shard->strategies.stop();
+    }
+    if (risk_thread_.joinable()) {
+        risk_thread_.join();
+    }
+    execution_->stop();
+}
+
+bool TradingRuntime::publish(const uint8_t* data, size_t length) {
+    uint32_t slot;
+    if (length > config_.packet_size || !free_packets_->try_pop(slot)) {
+        dropped_packets_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    // The packet queue holds at most one entry per buffer, so it cannot be full
+    std::memcpy(packet_memory_ + slot * config_.packet_size, data, length);
+    packets_->try_push(Packet{slot, static_cast<uint32_t>(length), TscClock::now_ns()});
+    return true;
+}
+
+RuntimeStats TradingRuntime::stats() const {
+    RuntimeStats result;
+    result.packets = packet_count_.load(std::memory_order_relaxed);
+    result.dropped_packets = dropped_packets_.load(std::memory_order_relaxed);
+    result.events = event_count_.load(std::memory_order_relaxed);
+    result.signals = signal_count_.load(std::memory_order_relaxed);
+    result.dropped_signals = dropped_signals_.load(std::memory_order_relaxed);
+    return result;
+}
+
+LatencyHistogram TradingRuntime::tick_to_signal() const {
+    LatencyHistogram result;
+    for (const auto& shard : shards_) {
+        result.merge(shard->tick_to_signal);
+    }
+    return result;
+}
+
+void TradingRuntime::run_feed() {
+    if (config_.feed_cpu >= 0) {
+        pin_current_thread(config_.feed_cpu);
+    }
+    
+    Backoff backoff(config_.backoff);
+    FeedEventBatch batch;
+    std::vector<uint8_t> touched(shards_.size(), 0);
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        auto packet = packets_->try_pop();
+        if (!packet) {
+            backoff.idle();
+            continue;
+        }
+        backoff.reset();
+        
+        // Decode the packet once and route every event to its shard
+        const uint8_t* data = packet_memory_ + packet->slot * config_.packet_size;
+        size_t offset = 0;
+        size_t events = 0;
+        while (offset < packet->length) {
+            size_t start = offset;
+            batch.count = 0;
+            market_data_->decode_batch<NativeProtocol>(data, packet->length, offset, batch);
+            
+            for (const FeedEvent& event : batch) {
+                size_t shard = shard_of(event.symbol_id);
+                push_spinning(shards_[shard]->events, event);
+                touched[shard] = 1;
+            }
+            events += batch.count;
+            
+            if (offset == start) {
+                break;  // Incomplete trailing message
+            }
+        }
+        
+        // Mark the end of the packet on every shard it touched; the last
+        // shard to reach its marker recycles the buffer
+        uint32_t users = static_cast<uint32_t>(std::count(touched.begin(), touched.end(), 1));
+        packet_refs_[packet->slot].store(users, std::memory_order_relaxed);
+        if (users == 0) {
+            free_packets_->try_push(packet->slot);
+        }
+        
+        FeedEvent marker{};
+        marker.type = MessageType::HEARTBEAT;
+        marker.sequence = packet->slot;
+        marker.timestamp = packet->received;
+        for (size_t i = 0; i < touched.size(); ++i) {
+            if (touched[i]) {
+                push_spinning(shards_[i]->events, marker);
+                touched[i] = 0;
+            }
+        }
+        
+        packet_count_.fetch_add(1, std::memory_order_relaxed);
+        event_count_.fetch_add(events, std::memory_order_relaxed);
+    }
+}
+
+void TradingRuntime::run_shard(Shard& shard) {
+    if (shard.cpu >= 0) {
+        pin_current_thread(shard.cpu);
+    }
+    
+    // Warm start once, after pinning so the books land on the shard's node
+    if (config_.warm_start && !shard.ready.load(std::memory_order_relaxed)) {
+        warm_start(shard);
+    }
+    shard.ready.store(true, std::memory_order_release);
+    
+    Backoff backoff(config_.backoff);
+    std::array<FeedEvent, EVENT_BATCH_SIZE> events;
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        // Drain a run of events with one release of the queue slots
+        size_t count = shard.events.try_pop_n(events.data(), events.size());
+        if (count == 0) {
+            backoff.idle();
+            continue;
+        }
+        backoff.reset();
+        
+        for (size_t i = 0; i < count; ++i) {
+            const FeedEvent& event = events[i];
+            if (event.type != MessageType::HEARTBEAT) {
+                market_data_->apply_event(event);
+                if (shard.strategies.has_per_event()) {
+                    // This shard owns the symbol, so the unlocked view is current
+                    if (OrderBook* book = market_data_->book(event.symbol_id)) {
+                        shard.strategies.process_event(*book);
+                    }
+                }
+                shard.dirty.set(event.symbol_id);
+                continue;
+            }
+            
+            // End of packet: the buffer is no longer needed, run the
+            // conflated strategies once per updated book
+            release_packet(static_cast<uint32_t>(event.sequence));
+            for (size_t symbol_id = shard.dirty.find_first(); symbol_id != Bitmap::npos;
+                 symbol_id = shard.dirty.find_next(symbol_id + 1)) {
+                shard.dirty.clear(symbol_id);
+                if (OrderBook* book = market_data_->book(static_cast<SymbolId>(symbol_id))) {
+                    // The risk gate's price band follows the book's mid
+                    if (auto mid = book->mid_price()) {
+                        risk_->set_reference_price(static_cast<SymbolId>(symbol_id), *mid);
+                    }
+                    shard.strategies.process_conflated(*book);
+                }
+            }
+            
+            Timestamp now = TscClock::now_ns();
+            shard.tick_to_signal.record(now > event.timestamp ? now - event.timestamp : 0);
+        }
+    }
+}
+
+void TradingRuntime::warm_start(Shard& shard) {
+    const size_t symbols = market_data_->symbols().size();
+    for (SymbolId symbol_id = static_cast<SymbolId>(shard.index); symbol_id < symbols;
+         symbol_id += static_cast<SymbolId>(shards_.size())) {
+        market_data_->place_books(symbol_id, config_.orders_per_book);
+        market_data_->warm_up(symbol_id, config_.warm_up_price, config_.warm_up_rounds);
+    }
+}
+
+void TradingRuntime::run_risk() {
+    if (config_.risk_cpu >= 0) {
+        pin_current_thread(config_.risk_cpu);
+    }
+    
+    Backoff backoff(config_.backoff);
+    std::array<Signal, SIGNAL_BATCH_SIZE> batch;
+    
+    while (running_.load(std::memory_order_relaxed)) {
+        uint64_t signals = 0;
+        for (auto& shard : shards_) {
+            while (size_t count = shard->signals.try_pop_n(batch.data(), batch.size())) {
+                for (size_t i = 0; i < count; ++i) {
+                    risk_->submit(batch[i]);
+                }
+                signals += count;
+            }
+        }
+        
+        if (signals == 0) {
+            backoff.idle();
+            continue;
+        }
+        backoff.reset();
+        signal_count_.fetch_add(signals, std::memory_order_relaxed);
+    }
+}
+
+void TradingRuntime::release_packet(uint32_t slot) {
+    if (packet_refs_[slot].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        free_packets_->try_push(slot);
+    }
+}
+
+template<typename Queue, typename T>
+bool TradingRuntime::push_spinning(Queue& queue, const T& value) {
+    while (!queue.try_push(value)) {
+        if (!running_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        Backoff::cpu_relax();
+    }
+    return true;
+}
+
+} // namespace trading
\ No newline at end of file
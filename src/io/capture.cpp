@@ -0,0 +1,371 @@
+#include "trading/io/capture.h"
+#include "trading/core/market_data.h"
+#include "trading/utils/backoff.h"
+#include "trading/utils/tsc_clock.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Round up to a multiple of a power-of-two alignment
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Check the header page of a capture file
+bool valid_header(const uint8_t* page) {
+    CaptureFileHeader header;
+    std::memcpy(&header, page, sizeof(header));
+    return std::memcmp(header.magic, CAPTURE_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == 1 && header.page_size == CAPTURE_PAGE_SIZE;
+}
+
+// Paced replays sleep until this close to a deadline, then spin
+constexpr uint64_t SPIN_WINDOW_NS = 100000;
+
+} // anonymous namespace
+
+CaptureWriter::CaptureWriter(size_t buffer_bytes)
+    : fd_(-1), capacity_(round_up(std::max(buffer_bytes, CAPTURE_PAGE_SIZE), CAPTURE_PAGE_SIZE)),
+      used_(0), records_(0), file_bytes_(0) {
+    buffer_ = std::make_unique<uint8_t[]>(capacity_);
+}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::write(const uint8_t* data, size_t length, Timestamp receive_ns, bool hardware_timestamp) {
+    if (fd_ < 0 || length > UINT32_MAX) {
+        return false;
+    }
+    if (length == 0) {
+        return true;  // A zero header marks padding
+    }
+    
+    CaptureRecordHeader header{};
+    header.receive_ns = receive_ns;
+    header.length = static_cast<uint32_t>(length);
+    header.flags = hardware_timestamp ? CAPTURE_HARDWARE_TIMESTAMP : 0;
+    
+    // A header never straddles pages, so the tail of a page that cannot hold
+    // one is always padding
+    size_t room = CAPTURE_PAGE_SIZE - used_ % CAPTURE_PAGE_SIZE;
+    if (room < sizeof(header)) {
+        static const uint8_t zeros[sizeof(CaptureRecordHeader)] = {};
+        if (!append(zeros, room)) {
+            return false;
+        }
+    }
+    
+    static const uint8_t padding[8] = {};
+    if (!append(&header, sizeof(header)) || !append(data, length) ||
+        !append(padding, round_up(length, 8) - length)) {
+        return false;
+    }
+    
+    records_++;
+    return true;
+}
+
+bool CaptureWriter::append(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        size_t chunk = std::min(size, capacity_ - used_);
+        std::memcpy(buffer_.get() + used_, bytes, chunk);
+        used_ += chunk;
+        bytes += chunk;
+        size -= chunk;
+        
+        if (used_ == capacity_) {
+            if (!write_buffer(capacity_)) {
+                return false;
+            }
+            used_ = 0;
+        }
+    }
+    return true;
+}
+
+bool CaptureWriter::flush() {
+    if (fd_ < 0) {
+        return false;
+    }
+    if (used_ == 0) {
+        return true;
+    }
+    
+    // Pad the last page with zeros; the next record starts on a fresh page
+    size_t size = round_up(used_, CAPTURE_PAGE_SIZE);
+    std::memset(buffer_.get() + used_, 0, size - used_);
+    used_ = 0;
+    return write_buffer(size);
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+
+bool CaptureWriter::open(const std::string& path, bool append) {
+    close();
+    
+    int fd = ::open(path.c_str(), (append ? O_RDWR : O_WRONLY | O_TRUNC) | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    uint64_t size = static_cast<uint64_t>(info.st_size);
+    if (append && size > 0) {
+        // Continue only a well-formed capture file
+        uint8_t page[sizeof(CaptureFileHeader)];
+        if (size % CAPTURE_PAGE_SIZE != 0 || pread(fd, page, sizeof(page), 0) != static_cast<ssize_t>(sizeof(page)) ||
+            !valid_header(page) || lseek(fd, 0, SEEK_END) < 0) {
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        file_bytes_ = size;
+        records_ = 0;
+        return true;
+    }
+    
+    // New file: write the header page
+    fd_ = fd;
+    file_bytes_ = 0;
+    records_ = 0;
+    used_ = 0;
+    
+    CaptureFileHeader header{};
+    std::memcpy(header.magic, CAPTURE_FILE_MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.page_size = CAPTURE_PAGE_SIZE;
+    header.created_ns = TscClock::now_ns();
+    
+    std::memset(buffer_.get(), 0, CAPTURE_PAGE_SIZE);
+    std::memcpy(buffer_.get(), &header, sizeof(header));
+    used_ = CAPTURE_PAGE_SIZE;
+    if (!flush()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureWriter::close() {
+    if (fd_ >= 0) {
+        flush();
+        ::close(fd_);
+        fd_ = -1;
+    }
+    used_ = 0;
+}
+
+bool CaptureWriter::write_buffer(size_t size) {
+    const uint8_t* data = buffer_.get();
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        file_bytes_ += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+CaptureFile::~CaptureFile() {
+    close();
+}
+
+bool CaptureFile::open(const std::string& path, bool prefault) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < CAPTURE_PAGE_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    
+    size_t size = static_cast<size_t>(info.st_size);
+    int flags = MAP_PRIVATE;
+#if defined(__linux__)
+    if (prefault) {
+        flags |= MAP_POPULATE;
+    }
+#else
+    (void)prefault;
+#endif
+    void* memory = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    ::close(fd);  // The mapping keeps the file open
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    
+    if (!valid_header(static_cast<const uint8_t*>(memory))) {
+        munmap(memory, size);
+        return false;
+    }
+    
+    // Records are read front to back: read ahead aggressively
+    madvise(memory, size, MADV_SEQUENTIAL);
+    
+    data_ = static_cast<const uint8_t*>(memory);
+    size_ = size;
+    offset_ = CAPTURE_PAGE_SIZE;
+    truncated_ = false;
+    path_ = path;
+    return true;
+}
+
+void CaptureFile::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+#else
+
+// Capture files need POSIX file and mapping calls
+bool CaptureWriter::open(const std::string&, bool) {
+    return false;
+}
+
+void CaptureWriter::close() {
+    used_ = 0;
+}
+
+bool CaptureWriter::write_buffer(size_t) {
+    return false;
+}
+
+CaptureFile::~CaptureFile() {
+}
+
+bool CaptureFile::open(const std::string&, bool) {
+    return false;
+}
+
+void CaptureFile::close() {
+}
+
+#endif
+
+bool CaptureFile::next(ReceivedPacket& packet) {
+    while (offset_ + sizeof(CaptureRecordHeader) <= size_) {
+        size_t room = CAPTURE_PAGE_SIZE - offset_ % CAPTURE_PAGE_SIZE;
+        if (room < sizeof(CaptureRecordHeader)) {
+            offset_ += room;
+            continue;
+        }
+        
+        CaptureRecordHeader header;
+        std::memcpy(&header, data_ + offset_, sizeof(header));
+        if (header.length == 0) {
+            offset_ += room;  // Padding up to the next page
+            continue;
+        }
+        
+        size_t end = offset_ + sizeof(header) + header.length;
+        if (end > size_) {
+            truncated_ = true;
+            offset_ = size_;
+            return false;
+        }
+        
+        packet.data = data_ + offset_ + sizeof(header);
+        packet.length = header.length;
+        packet.receive_ns = header.receive_ns;
+        packet.hardware_timestamp = (header.flags & CAPTURE_HARDWARE_TIMESTAMP) != 0;
+        offset_ = round_up(end, 8);
+        return true;
+    }
+    return false;
+}
+
+CaptureReplay::CaptureReplay(ReplayConfig config)
+    : config_(config) {
+}
+
+bool CaptureReplay::add_file(const std::string& path) {
+    auto file = std::make_unique<CaptureFile>();
+    if (!file->open(path, config_.prefault)) {
+        return false;
+    }
+    sources_.push_back(Source{std::move(file), ReceivedPacket{nullptr, 0, 0, false}});
+    return true;
+}
+
+size_t CaptureReplay::run(MarketDataHandler& market_data) {
+    // Each datagram is parsed straight out of the mapping
+    return run([&market_data](const ReceivedPacket& packet) {
+        market_data.process_buffer(packet.data, packet.length);
+    });
+}
+
+void CaptureReplay::prepare() {
+    stats_ = ReplayStats();
+    heap_.clear();
+    heap_.reserve(sources_.size());
+    
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        Source& source = sources_[i];
+        source.file->rewind();
+        if (source.file->next(source.head)) {
+            heap_.push_back(i);
+        }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return later(a, b); });
+}
+
+void CaptureReplay::pace(Timestamp receive_ns, uint64_t start_ns) const {
+    if (receive_ns <= stats_.first_ns) {
+        return;
+    }
+    
+    const uint64_t deadline = start_ns + static_cast<uint64_t>(
+        static_cast<double>(receive_ns - stats_.first_ns) / config_.speed);
+    
+    for (;;) {
+        uint64_t now = now_ns();
+        if (now >= deadline || stopping_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (deadline - now > SPIN_WINDOW_NS) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now - SPIN_WINDOW_NS));
+        } else {
+            Backoff::cpu_relax();
+        }
+    }
+}
+
+uint64_t CaptureReplay::now_ns() {
+    return TscClock::now_ns();
+}
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "trading/io/multicast_receiver.h"
+#include "trading/core/market_data.h"
+#include "trading/utils/cpu_affinity.h"
+#include "trading/utils/tsc_clock.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#endif
+
+namespace trading {
+
+#if defined(__linux__)
+
+namespace {
+
+Timestamp wall_clock_ns() {
+    return static_cast<Timestamp>(TscClock::now_ns());
+}
+
+} // namespace
+
+// Control buffer large enough for one SO_TIMESTAMPING message (3 timespecs)
+static constexpr size_t CONTROL_SIZE = CMSG_SPACE(3 * sizeof(timespec));
+
+struct MulticastReceiver::BatchState {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> iovecs;
+    std::vector<uint8_t> control;
+};
+
+MulticastReceiver::MulticastReceiver(MulticastConfig config)
+    : config_(std::move(config)), fd_(-1), running_(false),
+      packet_count_(0), byte_count_(0), batch_count_(0),
+      truncated_count_(0), error_count_(0) {
+    if (config_.batch_size == 0) {
+        config_.batch_size = 1;
+    }
+}
+
+MulticastReceiver::~MulticastReceiver() {
+    stop();
+    close();
+}
+
+bool MulticastReceiver::open() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    
+    in_addr group{};
+    if (inet_pton(AF_INET, config_.group.c_str(), &group) != 1) {
+        return false;
+    }
+    
+    in_addr local{};
+    local.s_addr = htonl(INADDR_ANY);
+    if (!config_.interface_address.empty() &&
+        inet_pton(AF_INET, config_.interface_address.c_str(), &local) != 1) {
+        return false;
+    }
+    
+    int fd = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        return false;
+    }
+    
+    // Allow several receivers (e.g. A/B lines, replay tools) on one host
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    if (config_.receive_buffer_bytes > 0) {
+        // Absorb bursts while the parser is busy; capped by net.core.rmem_max
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config_.receive_buffer_bytes,
+                   sizeof(config_.receive_buffer_bytes));
+    }
+
+#ifdef SO_BUSY_POLL
+    if (config_.busy_poll_us > 0) {
+        // Let the kernel poll the device queue instead of waiting for an interrupt
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &config_.busy_poll_us,
+                   sizeof(config_.busy_poll_us));
+    }
+#endif
+    
+    if (!config_.spin) {
+        // Wake blocking reads periodically so stop() can join the thread
+        timeval timeout{};
+        timeout.tv_usec = 100000;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    addr.sin_addr = group;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    ip_mreq membership{};
+    membership.imr_multiaddr = group;
+    membership.imr_interface = local;
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    fd_ = fd;
+    
+    if (config_.hardware_timestamps) {
+        enable_hardware_timestamps();
+    }
+    
+    // Register the receive buffers once; recvmmsg reuses them for every batch
+    const size_t batch = config_.batch_size;
+    arena_ = std::make_unique<uint8_t[]>(batch * config_.datagram_size);
+    packets_.assign(batch, ReceivedPacket{nullptr, 0, 0, false});
+    
+    batch_ = std::make_unique<BatchState>();
+    batch_->messages.assign(batch, mmsghdr{});
+    batch_->iovecs.resize(batch);
+    batch_->control.assign(config_.hardware_timestamps ? batch * CONTROL_SIZE : 0, 0);
+    
+    for (size_t i = 0; i < batch; ++i) {
+        iovec& iov = batch_->iovecs[i];
+        iov.iov_base = arena_.get() + i * config_.datagram_size;
+        iov.iov_len = config_.datagram_size;
+        
+        msghdr& hdr = batch_->messages[i].msg_hdr;
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        
+        packets_[i].data = static_cast<const uint8_t*>(iov.iov_base);
+    }
+    
+    return true;
+}
+
+void MulticastReceiver::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool MulticastReceiver::enable_hardware_timestamps() {
+    bool hardware = false;
+    
+    if (!config_.interface_name.empty() && config_.interface_name.size() < IFNAMSIZ) {
+        // Ask the NIC to stamp all incoming packets (needs CAP_NET_ADMIN)
+        hwtstamp_config hw{};
+        hw.tx_type = HWTSTAMP_TX_OFF;
+        hw.rx_filter = HWTSTAMP_FILTER_ALL;
+        
+        ifreq request{};
+        std::memcpy(request.ifr_name, config_.interface_name.data(), config_.interface_name.size());
+        request.ifr_data = reinterpret_cast<char*>(&hw);
+        hardware = ioctl(fd_, SIOCSHWTSTAMP, &request) == 0;
+    }
+    
+    // Report hardware stamps when the NIC provides them, software otherwise
+    int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+    
+    return hardware;
+}
+
+size_t MulticastReceiver::receive_batch() {
+    if (fd_ < 0) {
+        return 0;
+    }
+    
+    const size_t batch = config_.batch_size;
+    const bool timestamps = !batch_->control.empty();
+    
+    // recvmmsg overwrites the control lengths and flags, so reset them every call
+    for (size_t i = 0; i < batch; ++i) {
+        msghdr& hdr = batch_->messages[i].msg_hdr;
+        if (timestamps) {
+            hdr.msg_control = batch_->control.data() + i * CONTROL_SIZE;
+            hdr.msg_controllen = CONTROL_SIZE;
+        }
+        hdr.msg_flags = 0;
+    }
+    
+    int flags = config_.spin ? MSG_DONTWAIT : MSG_WAITFORONE;
+    int received = recvmmsg(fd_, batch_->messages.data(), static_cast<unsigned int>(batch),
+                            flags, nullptr);
+    if (received <= 0) {
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            error_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return 0;
+    }
+    
+    const Timestamp now = wall_clock_ns();
+    uint64_t bytes = 0;
+    uint64_t truncated = 0;
+    size_t delivered = 0;
+    
+    for (int i = 0; i < received; ++i) {
+        mmsghdr& message = batch_->messages[i];
+        bytes += message.msg_len;
+        
+        // The tail of a truncated datagram is lost, so it is not handed out
+        if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+            ++truncated;
+            continue;
+        }
+        
+        // Packets are compacted over dropped ones, so point at this buffer
+        ReceivedPacket& packet = packets_[delivered++];
+        packet.data = static_cast<const uint8_t*>(message.msg_hdr.msg_iov->iov_base);
+        packet.length = message.msg_len;
+        packet.receive_ns = now;
+        packet.hardware_timestamp = false;
+        
+        if (!timestamps) {
+            continue;
+        }
+        
+        msghdr& hdr = message.msg_hdr;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_TIMESTAMPING) {
+                continue;
+            }
+            
+            // ts[0] is the software stamp, ts[2] the raw hardware stamp
+            timespec ts[3];
+            std::memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+            if (ts[2].tv_sec != 0 || ts[2].tv_nsec != 0) {
+                packet.receive_ns = static_cast<Timestamp>(ts[2].tv_sec) * 1000000000ULL + ts[2].tv_nsec;
+                packet.hardware_timestamp = true;
+            } else if (ts[0].tv_sec != 0 || ts[0].tv_nsec != 0) {
+                packet.receive_ns = static_cast<Timestamp>(ts[0].tv_sec) * 1000000000ULL + ts[0].tv_nsec;
+            }
+        }
+    }
+    
+    packet_count_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+    byte_count_.fetch_add(bytes, std::memory_order_relaxed);
+    batch_count_.fetch_add(1, std::memory_order_relaxed);
+    if (truncated > 0) {
+        truncated_count_.fetch_add(truncated, std::memory_order_relaxed);
+    }
+    
+    return delivered;
+}
+
+#else
+
+struct MulticastReceiver::BatchState {};
+
+MulticastReceiver::MulticastReceiver(MulticastConfig config)
+    : config_(std::move(config)), fd_(-1), running_(false),
+      packet_count_(0), byte_count_(0), batch_count_(0),
+      truncated_count_(0), error_count_(0) {
+}
+
+MulticastReceiver::~MulticastReceiver() {
+    stop();
+}
+
+// recvmmsg is Linux-only; other platforms have no receive path yet
+bool MulticastReceiver::open() {
+    return false;
+}
+
+void MulticastReceiver::close() {
+}
+
+bool MulticastReceiver::enable_hardware_timestamps() {
+    return false;
+}
+
+size_t MulticastReceiver::receive_batch() {
+    return 0;
+}
+
+#endif
+
+bool MulticastReceiver::start(PacketCallback callback) {
+    if (running_ || !is_open()) {
+        return false;
+    }
+    
+    running_ = true;
+    thread_ = std::thread([this, callback = std::move(callback)]() {
+        if (config_.cpu >= 0) {
+            pin_current_thread(config_.cpu);
+        }
+        
+        while (running_.load(std::memory_order_relaxed)) {
+            poll(callback);
+        }
+    });
+    
+    return true;
+}
+
+bool MulticastReceiver::start(MarketDataHandler& market_data) {
+    // Each datagram is parsed straight out of the receive arena
+    return start([&market_data](const ReceivedPacket& packet) {
+        market_data.process_buffer(packet.data, packet.length);
+    });
+}
+
+void MulticastReceiver::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+MulticastStats MulticastReceiver::stats() const {
+    MulticastStats stats;
+    stats.packets = packet_count_.load(std::memory_order_relaxed);
+    stats.bytes = byte_count_.load(std::memory_order_relaxed);
+    stats.batches = batch_count_.load(std::memory_order_relaxed);
+    stats.truncated = truncated_count_.load(std::memory_order_relaxed);
+    stats.errors = error_count_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace trading
\ No newline at end of file
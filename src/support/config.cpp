@@ -167,41 +167,66 @@ void ConfigManager::load_environment() {
 }
 
 ConfigValue ConfigManager::get(std::string_view key, std::string_view default_value) const {
-    auto it = config_.find(std::string(key));
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = config_.find(key);
     if (it != config_.end()) {
         return it->second;
     }
     
-    return ConfigValue(std::string(default_value));
+    return ConfigValue(default_value);
 }
 
 void ConfigManager::set(std::string_view key, std::string_view value) {
-    std::string key_str(key);
     // Fix the most vexing parse issue - use {} initialization
-    ConfigValue config_value{std::string(value)};
+    ConfigValue config_value{value};
     
     // Update config
-    config_[key_str] = config_value;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = config_.find(key);
+        if (it != config_.end()) {
+            it->second = config_value;
+        } else {
+            config_.emplace(std::string(key), config_value);
+        }
+        version_++;
+    }
     
-    // Notify listeners
+    // Rebuild the snapshots and notify listeners (outside the lock, so they
+    // may read the configuration)
+    refresh_snapshots(key);
     notify_listeners(key, config_value);
 }
 
 bool ConfigManager::has(std::string_view key) const {
-    return config_.find(std::string(key)) != config_.end();
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return config_.find(key) != config_.end();
 }
 
 void ConfigManager::register_listener(std::string_view key, ConfigListener listener) {
-    std::string key_str(key);
-    listeners_[key_str].push_back(std::move(listener));
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = listeners_.find(key);
+    if (it == listeners_.end()) {
+        it = listeners_.emplace(std::string(key), std::vector<ConfigListener>()).first;
+    }
+    it->second.push_back(std::move(listener));
 }
 
 void ConfigManager::unregister_listeners(std::string_view key) {
-    std::string key_str(key);
-    listeners_.erase(key_str);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = listeners_.find(key);
+    if (it != listeners_.end()) {
+        listeners_.erase(it);
+    }
+}
+
+uint64_t ConfigManager::version() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return version_;
 }
 
 std::vector<std::string> ConfigManager::get_keys() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     std::vector<std::string> keys;
     keys.reserve(config_.size());
     
@@ -237,13 +262,51 @@ std::pair<std::string, std::string> ConfigManager::parse_line(std::string_view l
 }
 
 void ConfigManager::notify_listeners(std::string_view key, const ConfigValue& value) {
-    std::string key_str(key);
-    auto it = listeners_.find(key_str);
-    if (it != listeners_.end()) {
-        for (const auto& listener : it->second) {
-            listener(key, value);
+    // Call copies, so a listener may register or unregister listeners
+    std::vector<ConfigListener> listeners;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = listeners_.find(key);
+        if (it == listeners_.end()) {
+            return;
+        }
+        listeners = it->second;
+    }
+    
+    for (const auto& listener : listeners) {
+        listener(key, value);
+    }
+}
+
+void ConfigManager::refresh_snapshots(std::string_view key) {
+    // One rebuild at a time, so concurrent changes cannot publish out of
+    // order (every rebuild reads the latest configuration)
+    std::lock_guard<std::mutex> refresh_lock(refresh_mutex_);
+    
+    std::vector<std::shared_ptr<SnapshotBinding>> bindings;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& binding : snapshots_) {
+            if (key.starts_with(binding->prefix)) {
+                bindings.push_back(binding);
+            }
         }
     }
+    
+    std::vector<std::shared_ptr<SnapshotBinding>> expired;
+    for (const auto& binding : bindings) {
+        if (!binding->refresh(*this)) {
+            expired.push_back(binding);
+        }
+    }
+    
+    // Drop the bindings of snapshots nobody reads any more
+    if (!expired.empty()) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::erase_if(snapshots_, [&](const std::shared_ptr<SnapshotBinding>& binding) {
+            return std::find(expired.begin(), expired.end(), binding) != expired.end();
+        });
+    }
 }
 
 } // namespace trading
\ No newline at end of file
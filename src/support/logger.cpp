@@ -1,34 +1,205 @@
 #include "trading/support/logger.h"
+#include <charconv>
 #include <chrono>
 #include <ctime>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <unordered_map>
 
 namespace trading {
 
+namespace {
+
+// Formats "YYYY-mm-dd HH:MM:SS.mmm", converting to local time once per second
+class TimestampFormatter {
+public:
+    void append(std::string& out, uint64_t epoch_ns) {
+        time_t seconds = static_cast<time_t>(epoch_ns / 1000000000);
+        if (seconds != cached_second_) {
+            std::tm tm_buf;
+#ifdef _WIN32
+            localtime_s(&tm_buf, &seconds);
+#else
+            localtime_r(&seconds, &tm_buf);
+#endif
+            std::strftime(cached_text_, sizeof(cached_text_), "%Y-%m-%d %H:%M:%S", &tm_buf);
+            cached_second_ = seconds;
+        }
+        
+        unsigned millis = static_cast<unsigned>(epoch_ns / 1000000 % 1000);
+        char fraction[4] = {static_cast<char>('0' + millis / 100), static_cast<char>('0' + millis / 10 % 10),
+                            static_cast<char>('0' + millis % 10), ' '};
+        out.append(cached_text_);
+        out.push_back('.');
+        out.append(fraction, sizeof(fraction));
+    }
+    
+private:
+    time_t cached_second_ = -1;
+    char cached_text_[32] = {};
+};
+
+// Cursor over the encoded arguments of a record
+class LogArgReader {
+public:
+    LogArgReader(const uint8_t* data, const uint8_t* end, size_t count) : data_(data), end_(end), count_(count) {}
+    
+    // Check if arguments remain
+    bool more() const { return count_ > 0 && data_ < end_; }
+    
+    // Append the next argument as text
+    void append(std::string& out) {
+        LogArgType type = static_cast<LogArgType>(*data_++);
+        count_--;
+        char text[32];
+        
+        switch (type) {
+            case LogArgType::INT: {
+                int64_t value;
+                std::memcpy(&value, data_, 8);
+                data_ += 8;
+                out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+                break;
+            }
+            case LogArgType::UINT: {
+                uint64_t value;
+                std::memcpy(&value, data_, 8);
+                data_ += 8;
+                out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+                break;
+            }
+            case LogArgType::DOUBLE: {
+                double value;
+                std::memcpy(&value, data_, 8);
+                data_ += 8;
+                out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+                break;
+            }
+            case LogArgType::BOOL:
+                out.append(*data_++ ? "true" : "false");
+                break;
+            case LogArgType::CHAR:
+                out.push_back(static_cast<char>(*data_++));
+                break;
+            case LogArgType::STRING:
+                out.append(string());
+                break;
+            default:
+                count_ = 0;  // Corrupt record, stop reading
+                break;
+        }
+    }
+    
+    // Read the next argument as a string (the caller checked its type)
+    std::string_view string() {
+        uint16_t length;
+        std::memcpy(&length, data_, 2);
+        std::string_view value(reinterpret_cast<const char*>(data_ + 2), length);
+        data_ += 2 + length;
+        return value;
+    }
+    
+    // Read the next argument as an unsigned integer (the caller checked its type)
+    uint64_t uint() {
+        uint64_t value;
+        std::memcpy(&value, data_ + 1, 8);
+        data_ += 9;
+        count_--;
+        return value;
+    }
+    
+    // Read a string argument including its type tag
+    std::string_view next_string() {
+        if (!more() || static_cast<LogArgType>(*data_) != LogArgType::STRING) {
+            return {};
+        }
+        data_++;
+        count_--;
+        return string();
+    }
+    
+private:
+    const uint8_t* data_;
+    const uint8_t* end_;
+    size_t count_;
+};
+
+// Substitute the arguments of a record into its format
+void append_formatted(std::string& out, std::string_view format, LogArgReader& args) {
+    for (size_t i = 0; i < format.size(); ++i) {
+        char c = format[i];
+        if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+            out.push_back(c);  // Escaped brace
+            i++;
+        } else if (c == '{' && i + 1 < format.size() && format[i + 1] == '}' && args.more()) {
+            args.append(out);
+            i++;
+        } else {
+            out.push_back(c);
+        }
+    }
+}
+
+// Append one formatted line for a record
+void append_line(std::string& out, TimestampFormatter& timestamps, uint64_t epoch_ns, std::string_view level,
+                 std::string_view format, LogArgReader& args) {
+    timestamps.append(out, epoch_ns);
+    out.push_back('[');
+    out.append(level);
+    out.append("] ");
+    append_formatted(out, format, args);
+    out.push_back('\n');
+}
+
+// Formatter used by the logger thread
+TimestampFormatter& logger_timestamps() {
+    static TimestampFormatter formatter;
+    return formatter;
+}
+
+} // anonymous namespace
+
 Logger& Logger::instance() {
     static Logger instance;
     return instance;
 }
 
-Logger::Logger() : min_level_(LogLevel::INFO), running_(false) {
+Logger::Logger() : site_count_(0),
+                   retired_drops_(0),
+                   reported_drops_(0),
+                   output_(LogOutput::TEXT),
+                   min_level_(LogLevel::INFO),
+                   running_(false) {
 }
 
 Logger::~Logger() {
     stop();
 }
 
-void Logger::initialize(std::string_view log_file, LogLevel min_level) {
+void Logger::initialize(std::string_view log_file, LogLevel min_level, LogOutput output) {
     std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
     
     // Close existing log file if open
     if (log_file_.is_open()) {
         log_file_.close();
     }
     
-    // Open log file
-    log_file_.open(std::string(log_file), std::ios::out | std::ios::app);
+    // Open log file (a binary log starts with the clock it was written with)
+    output_ = output;
+    defined_sites_.assign(MAX_LOG_SITES, false);
+    TscCalibration calibration = TscClock::calibration();
+    clock_ = LogClock{calibration.base_ticks, calibration.base_ns, calibration.ticks_per_ns};
+    if (output == LogOutput::BINARY) {
+        log_file_.open(std::string(log_file), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (log_file_.is_open()) {
+            LogFileHeader header;
+            std::memcpy(header.magic, LOG_FILE_MAGIC, sizeof(header.magic));
+            header.clock = clock_;
+            log_file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+    } else {
+        log_file_.open(std::string(log_file), std::ios::out | std::ios::app);
+    }
     if (!log_file_.is_open()) {
         std::cerr << "Failed to open log file: " << log_file << std::endl;
     }
@@ -95,25 +266,45 @@ void Logger::stop() {
 }
 
 void Logger::flush() {
-    // Process all entries in the queue
-    LogEntry entry;
-    while (auto opt_entry = log_queue_.try_pop()) {
-        entry = std::move(*opt_entry);
-        
-        // Format and write to log file
-        std::string formatted = format_entry(entry);
-        
-        if (log_file_.is_open()) {
-            log_file_ << formatted << std::endl;
-        } else {
-            std::cout << formatted << std::endl;
-        }
+    // Process everything queued
+    while (drain() > 0) {
     }
     
     // Flush log file
     if (log_file_.is_open()) {
         log_file_.flush();
+    } else {
+        std::cout.flush();
+    }
+}
+
+uint16_t Logger::register_site(const LogSite& site) {
+    uint32_t id = site_count_.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MAX_LOG_SITES) {
+        return LOG_FORMAT_UNREGISTERED;
+    }
+    
+    sites_[id].store(&site, std::memory_order_release);
+    return static_cast<uint16_t>(id);
+}
+
+uint64_t Logger::dropped() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t dropped = retired_drops_;
+    for (const auto& ring : rings_) {
+        dropped += ring->dropped();
     }
+    return dropped;
+}
+
+Logger::RingHandle::RingHandle() : ring(std::make_shared<LogRing>()) {
+    Logger& logger = Logger::instance();
+    std::lock_guard<std::mutex> lock(logger.rings_mutex_);
+    logger.rings_.push_back(ring);
+}
+
+Logger::RingHandle::~RingHandle() {
+    ring->retire();
 }
 
 void Logger::trace(std::string_view message) {
@@ -147,52 +338,196 @@ bool Logger::is_enabled(LogLevel level) const {
 void Logger::logger_thread_func() {
     // Process log entries
     while (running_) {
-        // Try to get an entry from the queue
-        auto opt_entry = log_queue_.try_pop();
-        
-        if (opt_entry) {
-            // Format and write to log file
-            std::string formatted = format_entry(*opt_entry);
-            
+        if (drain() == 0) {
+            // Nothing to do: push out what was written and sleep for a bit
             if (log_file_.is_open()) {
-                log_file_ << formatted << std::endl;
                 log_file_.flush();
             } else {
-                std::cout << formatted << std::endl;
+                std::cout.flush();
             }
-        } else {
-            // No entries, sleep for a bit
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
 }
 
-std::string Logger::format_entry(const LogEntry& entry) {
-    std::ostringstream oss;
+size_t Logger::drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    size_t drained = 0;
     
-    // Format timestamp
-    auto time = std::chrono::system_clock::to_time_t(entry.timestamp);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        entry.timestamp.time_since_epoch() % std::chrono::seconds(1)
-    ).count();
+    // Text entries
+    while (auto entry = log_queue_.try_pop()) {
+        append_entry(*entry);
+        drained++;
+    }
     
-    std::tm tm_buf;
+    // Binary records, ring by ring
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> rings_lock(rings_mutex_);
+        for (size_t i = 0; i < rings_.size();) {
+            LogRing& ring = *rings_[i];
+            bool retired = ring.retired();
+            drained += ring.drain([this](const LogRecordHeader& header, const uint8_t* record) {
+                append_record(header, record);
+            });
+            dropped += ring.dropped();
+            
+            if (retired && ring.empty()) {
+                // The thread has exited and everything it logged is out
+                retired_drops_ += ring.dropped();
+                rings_[i] = std::move(rings_.back());
+                rings_.pop_back();
+                continue;
+            }
+            i++;
+        }
+        dropped += retired_drops_;
+    }
     
-#ifdef _WIN32
-    localtime_s(&tm_buf, &time);
-#else
-    localtime_r(&time, &tm_buf);
-#endif
+    if (dropped != reported_drops_) {
+        std::string message = "Logger dropped " + std::to_string(dropped - reported_drops_) +
+                              " records (thread ring full)";
+        append_entry(LogEntry(LogLevel::WARNING, message));
+        reported_drops_ = dropped;
+    }
+    
+    // One write for the whole batch
+    if (!write_buffer_.empty()) {
+        if (log_file_.is_open()) {
+            log_file_.write(write_buffer_.data(), static_cast<std::streamsize>(write_buffer_.size()));
+        } else if (output_ == LogOutput::TEXT) {
+            std::cout.write(write_buffer_.data(), static_cast<std::streamsize>(write_buffer_.size()));
+        }
+        write_buffer_.clear();
+    }
+    
+    return drained;
+}
+
+void Logger::append_entry(const LogEntry& entry) {
+    uint64_t epoch_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        entry.timestamp.time_since_epoch()).count();
+    
+    if (output_ == LogOutput::TEXT) {
+        logger_timestamps().append(write_buffer_, epoch_ns);
+        write_buffer_.push_back('[');
+        write_buffer_.append(level_to_string(entry.level));
+        write_buffer_.append("] ");
+        write_buffer_.append(entry.message);
+        write_buffer_.push_back('\n');
+        return;
+    }
+    
+    // Binary output: store the message as a dynamic record
+    std::string_view format = "{}";
+    std::string_view message = entry.message;
+    size_t size = (sizeof(LogRecordHeader) + detail::log_arg_size(format) + detail::log_arg_size(message) + 7) &
+                  ~size_t(7);
+    LogRecordHeader header{static_cast<uint32_t>(size), LOG_FORMAT_DYNAMIC, static_cast<uint8_t>(entry.level), 2,
+                           clock_.to_ticks(epoch_ns)};
+    
+    size_t offset = write_buffer_.size();
+    write_buffer_.resize(offset + size, '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(write_buffer_.data() + offset);
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    detail::encode_log_arg(out, format);
+    detail::encode_log_arg(out, message);
+}
+
+void Logger::append_record(const LogRecordHeader& header, const uint8_t* record) {
+    const LogSite* site = header.format_id < MAX_LOG_SITES
+                        ? sites_[header.format_id].load(std::memory_order_acquire) : nullptr;
+    
+    if (output_ == LogOutput::TEXT) {
+        LogArgReader args(record + sizeof(header), record + header.size, header.arg_count);
+        std::string_view format = site ? std::string_view(site->format)
+                                : header.format_id == LOG_FORMAT_DYNAMIC ? args.next_string()
+                                : std::string_view("(unregistered log site)");
+        append_line(write_buffer_, logger_timestamps(), TscClock::to_ns(header.timestamp),
+                    level_to_string(static_cast<LogLevel>(header.level)), format, args);
+        return;
+    }
     
-    oss << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "." 
-        << std::setfill('0') << std::setw(3) << ms << " "
-        << "[" << level_to_string(entry.level) << "] "
-        << entry.message;
+    // Binary output: define the call site before its first record
+    if (site && !defined_sites_[header.format_id]) {
+        uint64_t id = header.format_id;
+        uint64_t line = site->line;
+        uint64_t level = static_cast<uint64_t>(site->level);
+        std::string_view format = site->format;
+        std::string_view file = site->file;
+        size_t size = (sizeof(LogRecordHeader) + 3 * detail::log_arg_size(id) + detail::log_arg_size(format) +
+                       detail::log_arg_size(file) + 7) & ~size_t(7);
+        LogRecordHeader definition{static_cast<uint32_t>(size), LOG_FORMAT_DEFINITION, header.level, 5, 0};
+        
+        size_t offset = write_buffer_.size();
+        write_buffer_.resize(offset + size, '\0');
+        uint8_t* out = reinterpret_cast<uint8_t*>(write_buffer_.data() + offset);
+        std::memcpy(out, &definition, sizeof(definition));
+        out += sizeof(definition);
+        detail::encode_log_arg(out, id);
+        detail::encode_log_arg(out, level);
+        detail::encode_log_arg(out, line);
+        detail::encode_log_arg(out, format);
+        detail::encode_log_arg(out, file);
+        defined_sites_[header.format_id] = true;
+    }
+    
+    write_buffer_.append(reinterpret_cast<const char*>(record), header.size);
+}
+
+bool Logger::decode(std::istream& in, std::ostream& out) {
+    LogFileHeader file_header;
+    if (!in.read(reinterpret_cast<char*>(&file_header), sizeof(file_header)) ||
+        std::memcmp(file_header.magic, LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC)) != 0) {
+        return false;
+    }
+    
+    std::unordered_map<uint16_t, std::string> formats;
+    std::vector<uint8_t> record;
+    std::string text;
+    TimestampFormatter timestamps;
+    LogRecordHeader header;
+    
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (header.size < sizeof(header)) {
+            return false;  // Corrupt file
+        }
+        
+        record.resize(header.size);
+        std::memcpy(record.data(), &header, sizeof(header));
+        if (!in.read(reinterpret_cast<char*>(record.data() + sizeof(header)), header.size - sizeof(header))) {
+            return false;  // Truncated record
+        }
+        
+        LogArgReader args(record.data() + sizeof(header), record.data() + header.size, header.arg_count);
+        if (header.format_id == LOG_FORMAT_DEFINITION) {
+            uint16_t id = static_cast<uint16_t>(args.uint());
+            args.uint();  // Level
+            args.uint();  // Line
+            formats[id] = std::string(args.next_string());
+            continue;
+        }
+        
+        std::string_view format;
+        if (header.format_id == LOG_FORMAT_DYNAMIC) {
+            format = args.next_string();
+        } else if (auto it = formats.find(header.format_id); it != formats.end()) {
+            format = it->second;
+        } else {
+            format = "(unregistered log site)";
+        }
+        
+        text.clear();
+        append_line(text, timestamps, file_header.clock.to_ns(header.timestamp),
+                    level_to_string(static_cast<LogLevel>(header.level)), format, args);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
     
-    return oss.str();
+    return true;
 }
 
-std::string_view Logger::level_to_string(LogLevel level) const {
+std::string_view Logger::level_to_string(LogLevel level) {
     switch (level) {
         case LogLevel::TRACE:   return "TRACE";
         case LogLevel::DEBUG:   return "DEBUG";
@@ -0,0 +1,53 @@
+#include "trading/utils/cpu_affinity.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace trading {
+
+#if defined(__linux__)
+
+namespace {
+
+bool pin_native_thread(pthread_t thread, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(thread, sizeof(cpus), &cpus) == 0;
+}
+
+} // namespace
+
+bool pin_current_thread(int cpu) {
+    return pin_native_thread(pthread_self(), cpu);
+}
+
+bool pin_thread(std::thread& thread, int cpu) {
+    return pin_native_thread(thread.native_handle(), cpu);
+}
+
+#else
+
+// Hard affinity is not available (macOS only offers affinity hints)
+bool pin_current_thread(int /*cpu*/) {
+    return false;
+}
+
+bool pin_thread(std::thread& /*thread*/, int /*cpu*/) {
+    return false;
+}
+
+#endif
+
+unsigned int cpu_count() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+} // namespace trading
\ No newline at end of file
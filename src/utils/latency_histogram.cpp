@@ -0,0 +1,149 @@
+#include "trading/utils/latency_histogram.h"
+#include <cmath>
+#include <sstream>
+
+namespace trading {
+
+static_assert(LatencyHistogram::bucket_of(LatencyHistogram::MAX_VALUE) == LatencyHistogram::BUCKET_COUNT - 1,
+              "MAX_VALUE must fall in the top bucket");
+static_assert(LatencyHistogram::bucket_highest(LatencyHistogram::BUCKET_COUNT - 1) ==
+              LatencyHistogram::MAX_VALUE, "The top bucket must end at MAX_VALUE");
+
+void LatencyHistogram::record(uint64_t value, uint64_t n) {
+    if (n == 0) {
+        return;
+    }
+    
+    add(buckets_[bucket_of(value)], n);
+    add(count_, n);
+    add(sum_, value * n);
+    if (value < min_.load(std::memory_order_relaxed)) {
+        min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.count() == 0) {
+        return;
+    }
+    
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        if (uint64_t n = other.buckets_[i].load(std::memory_order_relaxed)) {
+            add(buckets_[i], n);
+        }
+    }
+    add(count_, other.count_.load(std::memory_order_relaxed));
+    add(sum_, other.sum_.load(std::memory_order_relaxed));
+    min_.store(std::min(min_.load(std::memory_order_relaxed), other.min_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+    max_.store(std::max(max_.load(std::memory_order_relaxed), other.max_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& earlier) {
+    uint64_t exact_min = min_.load(std::memory_order_relaxed);
+    uint64_t exact_max = max_.load(std::memory_order_relaxed);
+    uint64_t count = 0;
+    size_t lowest = BUCKET_COUNT;
+    size_t highest = 0;
+    
+    // A racy snapshot may be slightly ahead in a bucket; never wrap
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+        uint64_t m = std::min(n, earlier.buckets_[i].load(std::memory_order_relaxed));
+        buckets_[i].store(n - m, std::memory_order_relaxed);
+        if (n > m) {
+            count += n - m;
+            lowest = std::min(lowest, i);
+            highest = i;
+        }
+    }
+    
+    uint64_t sum = sum_.load(std::memory_order_relaxed);
+    uint64_t earlier_sum = earlier.sum_.load(std::memory_order_relaxed);
+    count_.store(count, std::memory_order_relaxed);
+    sum_.store(count > 0 && sum > earlier_sum ? sum - earlier_sum : 0, std::memory_order_relaxed);
+    
+    if (count == 0) {
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        return;
+    }
+    min_.store(std::max(bucket_lowest(lowest), exact_min), std::memory_order_relaxed);
+    max_.store(std::min(bucket_highest(highest), exact_max), std::memory_order_relaxed);
+}
+
+LatencyHistogram LatencyHistogram::interval(LatencyHistogram& last) const {
+    LatencyHistogram current(*this);
+    LatencyHistogram result(current);
+    result.subtract(last);
+    last = current;
+    return result;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(n)));
+    rank = std::max<uint64_t>(rank, 1);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::clamp(bucket_highest(i), min(), max());
+        }
+    }
+    return max();
+}
+
+std::string LatencyHistogram::summary() const {
+    std::ostringstream oss;
+    oss << "Samples: " << count() << "\n";
+    if (count() > 0) {
+        oss << "Min: " << min() << " ns\n";
+        oss << "Max: " << max() << " ns\n";
+        oss << "Avg: " << mean() << " ns\n";
+        oss << "50th: " << percentile(0.5) << " ns\n";
+        oss << "90th: " << percentile(0.9) << " ns\n";
+        oss << "99th: " << percentile(0.99) << " ns\n";
+        oss << "99.9th: " << percentile(0.999) << " ns\n";
+    }
+    return oss.str();
+}
+
+void LatencyHistogram::copy_from(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    count_.store(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum_.store(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    min_.store(other.min_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    max_.store(other.max_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} // namespace trading
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "trading/utils/page_allocator.h"
+#include <cstring>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Regular page size
+size_t page_size() {
+#if defined(__linux__) || defined(__APPLE__)
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<size_t>(size) : 4096;
+#else
+    return 4096;
+#endif
+}
+
+// Round up to a multiple of a power-of-two alignment
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // anonymous namespace
+
+size_t huge_page_size() {
+    return 2 * 1024 * 1024;
+}
+
+PageAllocation allocate_pages(size_t bytes, bool huge_pages, bool prefault) {
+    PageAllocation allocation;
+
+#if defined(__linux__)
+    int populate = prefault ? MAP_POPULATE : 0;
+    
+    if (huge_pages) {
+        // Explicit huge pages (needs vm.nr_hugepages)
+        size_t size = round_up(bytes, huge_page_size());
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+        if (memory != MAP_FAILED) {
+            allocation.memory = memory;
+            allocation.bytes = size;
+            allocation.huge_pages = true;
+            return allocation;
+        }
+    }
+    
+    size_t size = round_up(bytes, huge_pages ? huge_page_size() : page_size());
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return allocation;
+    }
+    
+    if (huge_pages) {
+        // Transparent huge pages, if enabled
+        madvise(memory, size, MADV_HUGEPAGE);
+    }
+    
+    allocation.memory = memory;
+    allocation.bytes = size;
+    if (populate) {
+        prefault_pages(memory, size);
+    }
+#elif defined(__APPLE__)
+    (void)huge_pages;
+    size_t size = round_up(bytes, page_size());
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return allocation;
+    }
+    allocation.memory = memory;
+    allocation.bytes = size;
+    if (prefault) {
+        prefault_pages(memory, size);
+    }
+#else
+    (void)huge_pages;
+    size_t size = round_up(bytes, page_size());
+    allocation.memory = ::operator new(size, std::align_val_t(page_size()), std::nothrow);
+    if (!allocation.memory) {
+        return allocation;
+    }
+    allocation.bytes = size;
+    std::memset(allocation.memory, 0, size);
+#endif
+    
+    return allocation;
+}
+
+void free_pages(const PageAllocation& allocation) {
+    if (!allocation.memory) {
+        return;
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    munmap(allocation.memory, allocation.bytes);
+#else
+    ::operator delete(allocation.memory, std::align_val_t(page_size()));
+#endif
+}
+
+void prefault_pages(void* memory, size_t bytes) {
+    // Write (not just read) so the kernel allocates private pages
+    volatile char* bytes_ptr = static_cast<volatile char*>(memory);
+    const size_t step = page_size();
+    for (size_t offset = 0; offset < bytes; offset += step) {
+        bytes_ptr[offset] = 0;
+    }
+}
+
+bool lock_memory() {
+#if defined(__linux__)
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace trading
\ No newline at end of file
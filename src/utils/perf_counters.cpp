@@ -0,0 +1,336 @@
+#include "trading/utils/perf_counters.h"
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Event slots of a counter group (cycles is the group leader)
+enum Event : size_t { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES };
+
+// Stage totals of one thread (kept after the thread exits)
+struct ThreadTotals {
+    // Samples, then one total per event
+    std::array<std::array<std::atomic<uint64_t>, PERF_EVENT_COUNT + 1>, PERF_STAGE_COUNT> stages{};
+};
+
+// Totals of every thread that has measured a scope
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadTotals>> registry;
+
+// Single-writer increment (no locked instruction)
+void add(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#if defined(__linux__)
+
+// Open one event of the calling thread, user space only
+int open_event(uint32_t type, uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+// Open an event of the group (the leader is opened with group_fd -1)
+int open_event(Event event, int group_fd) {
+    constexpr uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    switch (event) {
+        case CYCLES:
+            return open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, group_fd);
+        case INSTRUCTIONS:
+            return open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, group_fd);
+        case L1D_MISSES:
+            return open_event(PERF_TYPE_HW_CACHE, l1d_read_miss, group_fd);
+        case LLC_MISSES:
+            return open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, group_fd);
+        case BRANCH_MISSES:
+            return open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, group_fd);
+    }
+    return -1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Read a hardware counter from user space
+inline uint64_t rdpmc(uint32_t counter) {
+    uint32_t low, high;
+    asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+    return static_cast<uint64_t>(high) << 32 | low;
+}
+#endif
+
+// Counter group of the calling thread
+struct LocalCounters {
+    enum class State { UNOPENED, OPEN, UNAVAILABLE };
+    
+    State state = State::UNOPENED;
+    
+    // Event file descriptors (-1 where the PMU lacks the event)
+    std::array<int, PERF_EVENT_COUNT> fds{-1, -1, -1, -1, -1};
+    
+    // Position of each event in a group read (-1 if not opened)
+    std::array<int, PERF_EVENT_COUNT> slots{-1, -1, -1, -1, -1};
+    size_t members = 0;
+    
+    // User page of each event (for rdpmc)
+    std::array<perf_event_mmap_page*, PERF_EVENT_COUNT> pages{};
+    bool user_read = false;
+    
+    // Totals in the registry
+    ThreadTotals* totals = nullptr;
+    
+    ~LocalCounters() { close(); }
+    
+    bool open() {
+        if (state != State::UNOPENED) {
+            return state == State::OPEN;
+        }
+        state = State::UNAVAILABLE;
+        
+        fds[CYCLES] = open_event(CYCLES, -1);
+        if (fds[CYCLES] < 0) {
+            return false;
+        }
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (i != CYCLES) {
+                fds[i] = open_event(static_cast<Event>(i), fds[CYCLES]);
+            }
+            if (fds[i] >= 0) {
+                slots[i] = static_cast<int>(members++);
+            }
+        }
+        
+        // Read from user space only if every event's page allows it
+        const long page_size = sysconf(_SC_PAGESIZE);
+        user_read = true;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (fds[i] < 0) {
+                continue;
+            }
+            void* page = mmap(nullptr, static_cast<size_t>(page_size), PROT_READ, MAP_SHARED, fds[i], 0);
+            if (page == MAP_FAILED) {
+                user_read = false;
+                continue;
+            }
+            pages[i] = static_cast<perf_event_mmap_page*>(page);
+            user_read = user_read && pages[i]->cap_user_rdpmc;
+        }
+#if !defined(__x86_64__) && !defined(__i386__)
+        user_read = false;
+#endif
+        
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::make_unique<ThreadTotals>());
+        totals = registry.back().get();
+        state = State::OPEN;
+        return true;
+    }
+    
+    void close() {
+        const long page_size = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (pages[i] != nullptr) {
+                munmap(pages[i], static_cast<size_t>(page_size));
+                pages[i] = nullptr;
+            }
+            if (fds[i] >= 0) {
+                ::close(fds[i]);
+                fds[i] = -1;
+            }
+        }
+        if (state == State::OPEN) {
+            state = State::UNAVAILABLE;
+        }
+    }
+    
+    // Read every event (0 for the ones not opened)
+    void read(std::array<uint64_t, PERF_EVENT_COUNT>& values) const {
+#if defined(__x86_64__) || defined(__i386__)
+        if (user_read) {
+            for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+                values[i] = pages[i] != nullptr ? read_user(*pages[i]) : 0;
+            }
+            return;
+        }
+#endif
+        // One read() returns the whole group: the member count, then the values
+        uint64_t buffer[PERF_EVENT_COUNT + 1] = {};
+        if (::read(fds[CYCLES], buffer, sizeof(uint64_t) * (members + 1)) < 0) {
+            values.fill(0);
+            return;
+        }
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            values[i] = slots[i] >= 0 ? buffer[1 + slots[i]] : 0;
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Read an event through its user page (retried while the kernel updates it)
+    static uint64_t read_user(const volatile perf_event_mmap_page& page) {
+        for (;;) {
+            uint32_t sequence = page.lock;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            
+            uint32_t index = page.index;
+            uint64_t count = static_cast<uint64_t>(page.offset);
+            if (index != 0) {
+                // Sign-extend the counter from its hardware width
+                unsigned shift = 64 - page.pmc_width;
+                count += static_cast<uint64_t>(static_cast<int64_t>(rdpmc(index - 1) << shift) >> shift);
+            }
+            
+            std::atomic_signal_fence(std::memory_order_acquire);
+            if (page.lock == sequence) {
+                return count;
+            }
+        }
+    }
+#endif
+};
+
+#else
+
+// Counters need perf_event_open
+struct LocalCounters {
+    enum class State { OPEN, UNAVAILABLE };
+    
+    State state = State::UNAVAILABLE;
+    ThreadTotals* totals = nullptr;
+    
+    bool open() { return false; }
+    void read(std::array<uint64_t, PERF_EVENT_COUNT>& values) const { values.fill(0); }
+};
+
+#endif
+
+thread_local LocalCounters local_counters;
+
+} // anonymous namespace
+
+const char* perf_stage_name(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::PROCESS_BUFFER:
+            return "process_buffer";
+        case PerfStage::BOOK_UPDATE:
+            return "book_update";
+        case PerfStage::STRATEGY_UPDATE:
+            return "strategy_update";
+        case PerfStage::SUBMIT_ORDER:
+            return "submit_order";
+        case PerfStage::COUNT:
+            break;
+    }
+    return "unknown";
+}
+
+PerfCounts PerfCounts::operator-(const PerfCounts& earlier) const {
+    PerfCounts result;
+    result.samples = samples - earlier.samples;
+    result.instructions = instructions - earlier.instructions;
+    result.cycles = cycles - earlier.cycles;
+    result.l1d_misses = l1d_misses - earlier.l1d_misses;
+    result.llc_misses = llc_misses - earlier.llc_misses;
+    result.branch_misses = branch_misses - earlier.branch_misses;
+    return result;
+}
+
+PerfReport PerfReport::operator-(const PerfReport& earlier) const {
+    PerfReport result;
+    for (size_t i = 0; i < PERF_STAGE_COUNT; ++i) {
+        result.stages[i] = stages[i] - earlier.stages[i];
+    }
+    return result;
+}
+
+std::string PerfReport::summary() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < PERF_STAGE_COUNT; ++i) {
+        const PerfCounts& counts = stages[i];
+        if (counts.samples == 0) {
+            continue;
+        }
+        oss << perf_stage_name(static_cast<PerfStage>(i)) << ": " << counts.samples << " samples, "
+            << counts.per_sample(counts.instructions) << " instructions, "
+            << counts.per_sample(counts.cycles) << " cycles, IPC " << counts.ipc() << ", "
+            << counts.per_sample(counts.l1d_misses) << " L1D misses, "
+            << counts.per_sample(counts.llc_misses) << " LLC misses, "
+            << counts.per_sample(counts.branch_misses) << " branch misses per sample\n";
+    }
+    return oss.str();
+}
+
+bool PerfCounters::available() {
+    static const bool opened = attach_thread();
+    return opened;
+}
+
+bool PerfCounters::attach_thread() {
+    return local_counters.open();
+}
+
+PerfReport PerfCounters::snapshot() {
+    PerfReport report;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& totals : registry) {
+        for (size_t i = 0; i < PERF_STAGE_COUNT; ++i) {
+            const auto& stage = totals->stages[i];
+            PerfCounts& counts = report.stages[i];
+            counts.samples += stage[0].load(std::memory_order_relaxed);
+            counts.cycles += stage[1 + CYCLES].load(std::memory_order_relaxed);
+            counts.instructions += stage[1 + INSTRUCTIONS].load(std::memory_order_relaxed);
+            counts.l1d_misses += stage[1 + L1D_MISSES].load(std::memory_order_relaxed);
+            counts.llc_misses += stage[1 + LLC_MISSES].load(std::memory_order_relaxed);
+            counts.branch_misses += stage[1 + BRANCH_MISSES].load(std::memory_order_relaxed);
+        }
+    }
+    return report;
+}
+
+PerfScope::PerfScope(PerfStage stage)
+    : stage_(stage) {
+    LocalCounters& counters = local_counters;
+    if (counters.state != LocalCounters::State::OPEN && !counters.open()) [[unlikely]] {
+        stage_ = PerfStage::COUNT;
+        return;
+    }
+    counters.read(start_);
+}
+
+PerfScope::~PerfScope() {
+    if (stage_ == PerfStage::COUNT) {
+        return;
+    }
+    
+    std::array<uint64_t, PERF_EVENT_COUNT> end;
+    const LocalCounters& counters = local_counters;
+    counters.read(end);
+    
+    auto& stage = counters.totals->stages[static_cast<size_t>(stage_)];
+    add(stage[0], 1);
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        add(stage[1 + i], end[i] - start_[i]);
+    }
+}
+
+} // namespace trading
\ No newline at end of file
@@ -1,15 +1,18 @@
 #include "trading/utils/timekeeper.h"
+#include "trading/utils/tsc_clock.h"
 #include <algorithm>
 #include <chrono>
 #include <cmath>
-#include <numeric>
 #include <sstream>
 #include <thread>
 
 namespace trading {
 
 Timekeeper::Timekeeper(size_t max_samples)
-    : max_samples_(max_samples), sorted_(false) {
+    : Timekeeper(TimekeeperMode::SAMPLES, max_samples) {}
+
+Timekeeper::Timekeeper(TimekeeperMode mode, size_t max_samples)
+    : mode_(mode), max_samples_(mode == TimekeeperMode::SAMPLES ? max_samples : 0), sorted_(false) {
     samples_.reserve(max_samples_);
 }
 
@@ -21,24 +24,33 @@ uint64_t Timekeeper::end() {
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time_).count();
     
-    if (samples_.size() < max_samples_) {
-        samples_.push_back(static_cast<uint64_t>(duration));
-        sorted_ = false;
-    }
-    
+    record(static_cast<uint64_t>(duration));
     return static_cast<uint64_t>(duration);
 }
 
-double Timekeeper::average() const {
-    if (samples_.empty()) {
-        return 0.0;
-    }
+void Timekeeper::record(uint64_t ns) {
+    // The histogram sees every sample, so min, max and average stay O(1) and
+    // cover samples beyond max_samples
+    histogram_.record(ns);
     
-    double sum = std::accumulate(samples_.begin(), samples_.end(), 0.0);
-    return sum / samples_.size();
+    if (mode_ == TimekeeperMode::SAMPLES) {
+        if (samples_.size() < max_samples_) {
+            samples_.push_back(ns);
+            sorted_ = false;
+        } else {
+            dropped_++;
+        }
+    }
+}
+
+double Timekeeper::average() const {
+    return histogram_.mean();
 }
 
 double Timekeeper::median() {
+    if (mode_ == TimekeeperMode::HISTOGRAM) {
+        return static_cast<double>(histogram_.percentile(0.5));
+    }
     if (samples_.empty()) {
         return 0.0;
     }
@@ -54,6 +66,9 @@ double Timekeeper::median() {
 }
 
 double Timekeeper::percentile(double p) {
+    if (mode_ == TimekeeperMode::HISTOGRAM) {
+        return static_cast<double>(histogram_.percentile(p));
+    }
     if (samples_.empty()) {
         return 0.0;
     }
@@ -67,28 +82,22 @@ double Timekeeper::percentile(double p) {
 }
 
 uint64_t Timekeeper::min() const {
-    if (samples_.empty()) {
-        return 0;
-    }
-    
-    return *std::min_element(samples_.begin(), samples_.end());
+    return histogram_.min();
 }
 
 uint64_t Timekeeper::max() const {
-    if (samples_.empty()) {
-        return 0;
-    }
-    
-    return *std::max_element(samples_.begin(), samples_.end());
+    return histogram_.max();
 }
 
 void Timekeeper::clear() {
     samples_.clear();
+    histogram_.reset();
+    dropped_ = 0;
     sorted_ = true;
 }
 
 size_t Timekeeper::count() const {
-    return samples_.size();
+    return static_cast<size_t>(histogram_.count());
 }
 
 const std::vector<uint64_t>& Timekeeper::samples() const {
@@ -96,7 +105,7 @@ const std::vector<uint64_t>& Timekeeper::samples() const {
 }
 
 std::vector<std::pair<uint64_t, uint64_t>> Timekeeper::histogram(size_t bins) const {
-    if (samples_.empty()) {
+    if (count() == 0 || bins == 0) {
         return {};
     }
     
@@ -104,7 +113,7 @@ std::vector<std::pair<uint64_t, uint64_t>> Timekeeper::histogram(size_t bins) co
     uint64_t max_val = max();
     
     if (min_val == max_val) {
-        return {{min_val, samples_.size()}};
+        return {{min_val, count()}};
     }
     
     std::vector<std::pair<uint64_t, uint64_t>> result(bins);
@@ -115,17 +124,35 @@ std::vector<std::pair<uint64_t, uint64_t>> Timekeeper::histogram(size_t bins) co
         result[i].second = 0;
     }
     
+    auto bin_of = [&](uint64_t sample) {
+        return std::min(static_cast<size_t>((std::clamp(sample, min_val, max_val) - min_val) / bin_width), bins - 1);
+    };
+    
+    if (mode_ == TimekeeperMode::HISTOGRAM) {
+        // Each bucket goes to the bin of its midpoint
+        histogram_.for_each_bucket([&](uint64_t lowest, uint64_t highest, uint64_t n) {
+            result[bin_of(lowest + (highest - lowest) / 2)].second += n;
+        });
+        return result;
+    }
+    
     for (uint64_t sample : samples_) {
-        size_t bin = std::min(static_cast<size_t>((sample - min_val) / bin_width), bins - 1);
-        result[bin].second++;
+        result[bin_of(sample)].second++;
     }
     
     return result;
 }
 
 std::string Timekeeper::summary() const {
+    if (mode_ == TimekeeperMode::HISTOGRAM) {
+        return histogram_.summary();
+    }
+    
     std::ostringstream oss;
     oss << "Samples: " << count() << "\n";
+    if (dropped_ > 0) {
+        oss << "Not kept: " << dropped_ << " (percentiles cover the first " << samples_.size() << ")\n";
+    }
     if (count() > 0) {
         oss << "Min: " << min() << " ns\n";
         oss << "Max: " << max() << " ns\n";
@@ -149,26 +176,8 @@ void Timekeeper::sort_samples() {
 }
 
 double CycleCounter::cpu_frequency_ghz() {
-    static double freq = 0.0;
-    
-    if (freq == 0.0) {
-        // Measure CPU frequency
-        auto start = std::chrono::high_resolution_clock::now();
-        uint64_t start_cycles = CycleCounter::start();
-        
-        // Sleep for a short time
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        
-        uint64_t end_cycles = CycleCounter::end();
-        auto end = std::chrono::high_resolution_clock::now();
-        
-        auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
-        uint64_t cycles = end_cycles - start_cycles;
-        
-        freq = static_cast<double>(cycles) / time_ns;
-    }
-    
-    return freq;
+    // Measured once at startup by the TSC clock calibration
+    return TscClock::ticks_per_ns();
 }
 
 double CycleCounter::cycles_to_ns(uint64_t cycles) {
@@ -0,0 +1,206 @@
+#include "trading/utils/tsc_clock.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Tick count paired with the realtime clock
+struct ClockSample {
+    uint64_t ticks;
+    uint64_t ns;
+};
+
+// Calibration state (guarded by calibration_mutex)
+struct CalibrationState {
+    bool calibrated = false;
+    bool use_tsc = false;
+    ClockSample origin{};       // First sample (baseline of the rate estimate)
+    ClockSample last{};         // Sample of the last (re)calibration
+    double ns_per_tick = 1.0;   // Published rate
+};
+
+// Largest rate adjustment used to absorb an offset (500 ppm)
+constexpr double MAX_SLEW = 500e-6;
+
+// Offset beyond which the clock steps forward instead of slewing
+constexpr int64_t STEP_THRESHOLD_NS = 1000000;
+
+std::mutex calibration_mutex;
+CalibrationState calibration_state;
+
+// Read the realtime clock between two tick reads, keeping the tightest of a
+// few attempts so the pair is not skewed by an interrupt
+ClockSample sample_clocks() {
+    ClockSample best{};
+    uint64_t best_spread = UINT64_MAX;
+    
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        uint64_t before = CycleCounter::start();
+        uint64_t ns = TscClock::realtime_ns();
+        uint64_t after = CycleCounter::end();
+        
+        if (after - before < best_spread) {
+            best_spread = after - before;
+            best = ClockSample{before + (after - before) / 2, ns};
+        }
+    }
+    return best;
+}
+
+// Background recalibration thread
+struct Recalibrator {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+    bool running = false;
+    
+    ~Recalibrator() { stop(); }
+    
+    void start(std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        
+        running = true;
+        thread = std::thread([this, interval] {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!wake.wait_for(lock, interval, [this] { return !running; })) {
+                lock.unlock();
+                TscClock::recalibrate();
+                lock.lock();
+            }
+        });
+    }
+    
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+};
+
+Recalibrator recalibrator;
+
+// Calibrate during static initialization so the clock is ready before main
+[[maybe_unused]] const bool calibrated_at_startup = (TscClock::calibrate(), true);
+
+} // namespace
+
+void TscClock::calibrate() {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    CalibrationState& state = calibration_state;
+    
+    // Measure the rate over 10 ms
+    ClockSample first = sample_clocks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ClockSample second = sample_clocks();
+    
+    double ticks_per_ns = static_cast<double>(second.ticks - first.ticks) /
+                          static_cast<double>(second.ns - first.ns);
+    
+    state.calibrated = true;
+    state.use_tsc = invariant_tsc() && ticks_per_ns > 0.0 && std::isfinite(ticks_per_ns);
+    state.origin = first;
+    state.last = second;
+    state.ns_per_tick = state.use_tsc ? 1.0 / ticks_per_ns : 1.0;
+    publish(second.ticks, second.ns, state.use_tsc ? state.ns_per_tick : 0.0);
+}
+
+void TscClock::recalibrate() {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    CalibrationState& state = calibration_state;
+    if (!state.calibrated || !state.use_tsc) {
+        return;
+    }
+    
+    ClockSample now = sample_clocks();
+    if (now.ticks <= state.origin.ticks || now.ns <= state.origin.ns || now.ns <= state.last.ns) {
+        return;  // Realtime clock stepped back, keep the current rate
+    }
+    
+    // Rate over the whole baseline, then bend it to remove the offset
+    // between this clock and the realtime clock by the next recalibration
+    double ns_per_tick = static_cast<double>(now.ns - state.origin.ns) /
+                         static_cast<double>(now.ticks - state.origin.ticks);
+    uint64_t clock_ns = to_ns(now.ticks);
+    int64_t offset = static_cast<int64_t>(now.ns - clock_ns);
+    uint64_t base_ns = clock_ns;
+    
+    if (offset > STEP_THRESHOLD_NS) {
+        base_ns = now.ns;  // Far behind: step forward
+    } else {
+        double interval = static_cast<double>(now.ns - state.last.ns);
+        double slew = std::clamp(static_cast<double>(offset) / interval, -MAX_SLEW, MAX_SLEW);
+        ns_per_tick *= 1.0 + slew;
+    }
+    
+    state.last = now;
+    state.ns_per_tick = ns_per_tick;
+    publish(now.ticks, base_ns, ns_per_tick);
+}
+
+void TscClock::start_recalibration(std::chrono::milliseconds interval) {
+    recalibrator.start(interval);
+}
+
+void TscClock::stop_recalibration() {
+    recalibrator.stop();
+}
+
+TscCalibration TscClock::calibration() {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    TscCalibration result;
+    result.base_ticks = state_.base_ticks.load(std::memory_order_relaxed);
+    result.base_ns = state_.base_ns.load(std::memory_order_relaxed);
+    result.ticks_per_ns = 1.0 / calibration_state.ns_per_tick;
+    return result;
+}
+
+double TscClock::ticks_per_ns() {
+    std::lock_guard<std::mutex> lock(calibration_mutex);
+    return 1.0 / calibration_state.ns_per_tick;
+}
+
+bool TscClock::invariant_tsc() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+#else
+    // CycleCounter falls back to a monotonic clock
+    return true;
+#endif
+}
+
+void TscClock::publish(uint64_t base_ticks, uint64_t base_ns, double ns_per_tick) {
+    uint64_t mult = static_cast<uint64_t>(std::llround(ns_per_tick * static_cast<double>(uint64_t(1) << SHIFT)));
+    
+    uint32_t sequence = state_.sequence.load(std::memory_order_relaxed);
+    state_.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    state_.base_ticks.store(base_ticks, std::memory_order_relaxed);
+    state_.base_ns.store(base_ns, std::memory_order_relaxed);
+    state_.mult.store(mult, std::memory_order_relaxed);
+    
+    state_.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace trading
\ No newline at end of file